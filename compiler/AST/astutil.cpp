@@ -546,7 +546,7 @@ void remove_help(BaseAST* ast, int trace_flag) {
     expr->parentExpr = NULL;
   } else if (LabelSymbol* labsym = toLabelSymbol(ast)) {
     if (labsym->iterResumeGoto)
-      removedIterResumeLabels.add(labsym);
+      addToGVec(removedIterResumeLabels, labsym);
   }
 }
 
@@ -18,6 +18,7 @@
  */
 
 #include <ostream>
+#include <pthread.h>
 #include <sstream>
 #include <string>
 
@@ -46,6 +47,16 @@ static void cleanModuleList();
 #define decl_gvecs(type) Vec<type*> g##type##s
 foreach_ast(decl_gvecs);
 
+static pthread_mutex_t gvecsLock = PTHREAD_MUTEX_INITIALIZER;
+
+void lockGVecs() {
+  pthread_mutex_lock(&gvecsLock);
+}
+
+void unlockGVecs() {
+  pthread_mutex_unlock(&gvecsLock);
+}
+
 static int uid = 1;
 
 #define decl_counters(type)                                             \
@@ -266,17 +277,18 @@ static void checkid(int id) {
 
 BaseAST::BaseAST(AstTag type) :
   astTag(type),
-  id(uid++),
+  id(__sync_fetch_and_add(&uid, 1)),
   astloc(yystartlineno, yyfilename)
 {
   checkid(id);
   if (astloc.filename) {
     // OK, set from yyfilename
   } else {
-    if (currentAstLoc.filename) {
-      astloc = currentAstLoc;
+    if (currentAstFilename) {
+      astloc.filename = currentAstFilename;
+      astloc.lineno   = currentAstLineno;
     } else {
-      // neither yy* nor currentAstLoc are set
+      // neither yy* nor currentAstFilename are set
       INT_FATAL("no line number available");
     }
   }
@@ -307,16 +319,14 @@ const char* BaseAST::stringLoc(void) const {
 
 
 ModuleSymbol* BaseAST::getModule() {
-  if (!this)
-    return NULL;
   if (ModuleSymbol* x = toModuleSymbol(this))
     return x;
   else if (Type* x = toType(this))
-    return x->symbol->getModule();
+    return x->symbol ? x->symbol->getModule() : NULL;
   else if (Symbol* x = toSymbol(this))
-    return x->defPoint->getModule();
+    return x->defPoint ? x->defPoint->getModule() : NULL;
   else if (Expr* x = toExpr(this))
-    return x->parentSymbol->getModule();
+    return x->parentSymbol ? x->parentSymbol->getModule() : NULL;
   else
     INT_FATAL(this, "Unexpected case in BaseAST::getModule()");
   return NULL;
@@ -324,18 +334,16 @@ ModuleSymbol* BaseAST::getModule() {
 
 
 FnSymbol* BaseAST::getFunction() {
-  if (!this)
-    return NULL;
   if (ModuleSymbol* x = toModuleSymbol(this))
     return x->initFn;
   else if (FnSymbol* x = toFnSymbol(this))
     return x;
   else if (Type* x = toType(this))
-    return x->symbol->getFunction();
+    return x->symbol ? x->symbol->getFunction() : NULL;
   else if (Symbol* x = toSymbol(this))
-    return x->defPoint->getFunction();
+    return x->defPoint ? x->defPoint->getFunction() : NULL;
   else if (Expr* x = toExpr(this))
-    return x->parentSymbol->getFunction();
+    return x->parentSymbol ? x->parentSymbol->getFunction() : NULL;
   else
     INT_FATAL(this, "Unexpected case in BaseAST::getFunction()");
   return NULL;
@@ -498,7 +506,8 @@ void BaseAST::printDocsDescription(const char *doc, std::ostream *file, unsigned
 }
 
 
-astlocT currentAstLoc(0,NULL);
+__thread const char* currentAstFilename = NULL;
+__thread int         currentAstLineno   = 0;
 
 Vec<ModuleSymbol*> userModules; // Contains user + main modules
 Vec<ModuleSymbol*> allModules;  // Contains all modules
@@ -657,21 +666,22 @@ bool isCForLoop(const BaseAST* a)
 
 // constructor, invoked upon SET_LINENO
 astlocMarker::astlocMarker(astlocT newAstLoc)
-  : previousAstLoc(currentAstLoc)
+  : previousAstLoc(currentAstLineno, currentAstFilename)
 {
-  //previousAstLoc = currentAstLoc;
-  currentAstLoc = newAstLoc;
+  currentAstLineno   = newAstLoc.lineno;
+  currentAstFilename = newAstLoc.filename;
 }
 
 // constructor, for special occasions
 astlocMarker::astlocMarker(int lineno, const char* filename)
-  : previousAstLoc(currentAstLoc)
+  : previousAstLoc(currentAstLineno, currentAstFilename)
 {
-  currentAstLoc.lineno   = lineno;
-  currentAstLoc.filename = astr(filename);
+  currentAstLineno   = lineno;
+  currentAstFilename = astr(filename);
 }
 
 // destructor, invoked upon leaving SET_LINENO's scope
 astlocMarker::~astlocMarker() {
-  currentAstLoc = previousAstLoc;
+  currentAstLineno   = previousAstLoc.lineno;
+  currentAstFilename = previousAstLoc.filename;
 }
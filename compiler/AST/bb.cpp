@@ -29,10 +29,11 @@
 #include "view.h"
 #include "WhileDoStmt.h"
 
-int                                          BasicBlock::nextID     = 0;
-BasicBlock*                                  BasicBlock::basicBlock = NULL;
-Map<LabelSymbol*, std::vector<BasicBlock*>*> BasicBlock::gotoMaps;
-Map<LabelSymbol*, BasicBlock*>               BasicBlock::labelMaps;
+__thread int                                   BasicBlock::nextID     = 0;
+__thread BasicBlock*                           BasicBlock::basicBlock = NULL;
+__thread Map<LabelSymbol*, std::vector<BasicBlock*>*>*
+                                               BasicBlock::gotoMaps   = NULL;
+__thread Map<LabelSymbol*, BasicBlock*>*       BasicBlock::labelMaps  = NULL;
 
 BasicBlock::BasicBlock() {
   id = nextID++;
@@ -42,8 +43,13 @@ BasicBlock::BasicBlock() {
 void BasicBlock::reset(FnSymbol* fn) {
   clear(fn);
 
-  gotoMaps.clear();
-  labelMaps.clear();
+  if (gotoMaps == NULL) {
+    gotoMaps  = new Map<LabelSymbol*, std::vector<BasicBlock*>*>();
+    labelMaps = new Map<LabelSymbol*, BasicBlock*>();
+  }
+
+  gotoMaps->clear();
+  labelMaps->clear();
 
   fn->basicBlocks = new std::vector<BasicBlock*>();
 
@@ -200,20 +206,20 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
   } else if (GotoStmt* s = toGotoStmt(stmt)) {
     LabelSymbol* label = toLabelSymbol(toSymExpr(s->label)->var);
 
-    if (BasicBlock* bb = labelMaps.get(label)) {
+    if (BasicBlock* bb = labelMaps->get(label)) {
       // Thread this block to its destination label.
       thread(basicBlock, bb);
 
     } else {
       // Set up goto map, so this block's successor can be back-patched later.
-      std::vector<BasicBlock*>* vbb = gotoMaps.get(label);
+      std::vector<BasicBlock*>* vbb = gotoMaps->get(label);
 
       if (!vbb)
         vbb = new std::vector<BasicBlock*>();
 
       vbb->push_back(basicBlock);
 
-      gotoMaps.put(label, vbb);
+      gotoMaps->put(label, vbb);
     }
 
     append(s, mark); // Put the goto at the end of its block.
@@ -266,13 +272,13 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
 
       // See if we have any unresolved references to this label,
       // and resolve them.
-      if (std::vector<BasicBlock*>* vbb = gotoMaps.get(label)) {
+      if (std::vector<BasicBlock*>* vbb = gotoMaps->get(label)) {
         for_vector(BasicBlock, bb, *vbb) {
           thread(bb, basicBlock);
         }
       }
 
-      labelMaps.put(label, basicBlock);
+      labelMaps->put(label, basicBlock);
     } else {
       append(stmt, mark);
     }
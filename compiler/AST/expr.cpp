@@ -282,32 +282,30 @@ void Expr::prettyPrint(std::ostream *o) {
 }
 
 Expr* Expr::remove() {
-  if (this != NULL) {
-    if (list) {
-      if (next)
-        next->prev = prev;
-      else
-        list->tail = prev;
+  if (list) {
+    if (next)
+      next->prev = prev;
+    else
+      list->tail = prev;
 
-      if (prev)
-        prev->next = next;
-      else
-        list->head = next;
+    if (prev)
+      prev->next = next;
+    else
+      list->head = next;
 
-      list->length--;
+    list->length--;
 
-      next = NULL;
-      prev = NULL;
-      list = NULL;
-    } else {
-      callReplaceChild(this, NULL);
-    }
+    next = NULL;
+    prev = NULL;
+    list = NULL;
+  } else {
+    callReplaceChild(this, NULL);
+  }
 
-    if (parentSymbol) {
-      remove_help(this, 'r');
-    } else {
-      trace_remove(this, 'R');
-    }
+  if (parentSymbol) {
+    remove_help(this, 'r');
+  } else {
+    trace_remove(this, 'R');
   }
 
   return this;
@@ -428,7 +426,7 @@ SymExpr::SymExpr(Symbol* init_var) :
 {
   if (!init_var)
     INT_FATAL(this, "Bad call to SymExpr");
-  gSymExprs.add(this);
+  addToGVec(gSymExprs, this);
 }
 
 bool SymExpr::isNoInitExpr() const {
@@ -529,7 +527,7 @@ UnresolvedSymExpr::UnresolvedSymExpr(const char* i_unresolved) :
 {
   if (!i_unresolved)
     INT_FATAL(this, "bad call to UnresolvedSymExpr");
-  gUnresolvedSymExprs.add(this);
+  addToGVec(gUnresolvedSymExprs, this);
 }
 
 void
@@ -617,7 +615,7 @@ DefExpr::DefExpr(Symbol* initSym, BaseAST* initInit, BaseAST* initExprType) :
   if (isArgSymbol(sym) && (exprType || init))
     INT_FATAL(this, "DefExpr of ArgSymbol cannot have either exprType or init");
 
-  gDefExprs.add(this);
+  addToGVec(gDefExprs, this);
 }
 
 Expr* DefExpr::getFirstExpr() {
@@ -3452,7 +3450,7 @@ CallExpr::CallExpr(BaseAST* base, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  addToGVec(gCallExprs, this);
 }
 
 
@@ -3471,7 +3469,7 @@ CallExpr::CallExpr(PrimitiveOp *prim, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  addToGVec(gCallExprs, this);
 }
 
 CallExpr::CallExpr(PrimitiveTag prim, BaseAST* arg1, BaseAST* arg2,
@@ -3489,7 +3487,7 @@ CallExpr::CallExpr(PrimitiveTag prim, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  addToGVec(gCallExprs, this);
 }
 
 
@@ -3508,7 +3506,7 @@ CallExpr::CallExpr(const char* name, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  addToGVec(gCallExprs, this);
 }
 
 
@@ -4333,12 +4331,15 @@ GenRet CallExpr::codegen() {
     }
     case PRIM_WIDE_GET_ADDR:
     {
+      GenRet addr;
       if (get(1)->typeInfo()->symbol->hasFlag(FLAG_WIDE_REF) ||
           get(1)->typeInfo()->symbol->hasFlag(FLAG_WIDE_CLASS)) {
-        ret = codegenRaddr(get(1));
+        addr = codegenRaddr(get(1));
       } else {
-        ret = get(1);
+        addr = get(1);
       }
+      // The address is returned as an int(64).
+      ret = codegenCast(dtInt[INT_SIZE_64], codegenValue(addr));
       break;
     }
     case PRIM_ADDR_OF:
@@ -5720,7 +5721,7 @@ NamedExpr::NamedExpr(const char* init_name, Expr* init_actual) :
   name(init_name),
   actual(init_actual)
 {
-  gNamedExprs.add(this);
+  addToGVec(gNamedExprs, this);
 }
 
 
@@ -263,7 +263,7 @@ VarSymbol::VarSymbol(const char *init_name,
   doc(NULL),
   isField(false)
 {
-  gVarSymbols.add(this);
+  addToGVec(gVarSymbols, this);
 }
 
 
@@ -779,9 +779,10 @@ void VarSymbol::codegenDefC(bool global) {
 
   //
   // a variable can be codegen'd as static if it is global and neither
-  // exported nor external.
+  // exported nor external, and the modules are compiled together.
   //
-  bool isStatic =  global && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN);
+  bool isStatic =  global && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN) &&
+                   !fIncrementalCompile;
 
   std::string str = (isStatic ? "static " : "") + typestr + " " + cname;
   if (ct) {
@@ -982,7 +983,7 @@ ArgSymbol::ArgSymbol(IntentTag iIntent, const char* iName,
     variableExpr = block;
   else
     variableExpr = new BlockStmt(iVariableExpr, BLOCK_SCOPELESS);
-  gArgSymbols.add(this);
+  addToGVec(gArgSymbols, this);
 }
 
 
@@ -1214,7 +1215,7 @@ TypeSymbol::TypeSymbol(const char* init_name, Type* init_type) :
   if (!type)
     INT_FATAL(this, "TypeSymbol constructor called without type");
   type->addSymbol(this);
-  gTypeSymbols.add(this);
+  addToGVec(gTypeSymbols, this);
 }
 
 
@@ -1467,7 +1468,7 @@ FnSymbol::FnSymbol(const char* initName) :
   retSymbol(NULL)
 {
   substitutions.clear();
-  gFnSymbols.add(this);
+  addToGVec(gFnSymbols, this);
   formals.parent = this;
 }
 
@@ -1875,9 +1876,10 @@ void FnSymbol::codegenHeaderC(void) {
 
   //
   // A function prototype can be labeled static if it is neither
-  // exported nor external
+  // exported nor external, and the modules are compiled together
   //
-  if (!hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN)) {
+  if (!hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN) &&
+      !fIncrementalCompile) {
     fprintf(outfile, "static ");
   }
   fprintf(outfile, "%s", codegenFunctionType(true).c.c_str());
@@ -2459,7 +2461,7 @@ void FnSymbol::printDocs(std::ostream *file, unsigned int tabs) {
 EnumSymbol::EnumSymbol(const char* init_name) :
   Symbol(E_EnumSymbol, init_name)
 {
-  gEnumSymbols.add(this);
+  addToGVec(gEnumSymbols, this);
 }
 
 
@@ -2519,7 +2521,7 @@ ModuleSymbol::ModuleSymbol(const char* iName,
 
   block->parentSymbol = this;
   registerModule(this);
-  gModuleSymbols.add(this);
+  addToGVec(gModuleSymbols, this);
 }
 
 
@@ -2925,7 +2927,7 @@ LabelSymbol::LabelSymbol(const char* init_name) :
   Symbol(E_LabelSymbol, init_name, NULL),
   iterResumeGoto(NULL)
 {
-  gLabelSymbols.add(this);
+  addToGVec(gLabelSymbols, this);
 }
 
 
@@ -3237,7 +3239,7 @@ FlagSet getSyncFlags(Symbol* s) {
 VarSymbol* newTemp(const char* name, Type* type) {
   if (!name) {
     if (localTempNames)
-      name = astr("_t", istr(tempID++), "_");
+      name = astr("_t", istr(__sync_fetch_and_add(&tempID, 1)), "_");
     else
       name = "tmp";
   }
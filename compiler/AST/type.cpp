@@ -110,7 +110,7 @@ PrimitiveType::PrimitiveType(Symbol *init, bool internalType) :
   Type(E_PrimitiveType, init)
 {
   isInternalType = internalType;
-  gPrimitiveTypes.add(this);
+  addToGVec(gPrimitiveTypes, this);
 }
 
 
@@ -193,7 +193,7 @@ EnumType::EnumType() :
   constants(), integerType(NULL),
   doc(NULL)
 {
-  gEnumTypes.add(this);
+  addToGVec(gEnumTypes, this);
   constants.parent = this;
 }
 
@@ -557,7 +557,7 @@ AggregateType::AggregateType(AggregateTag initTag) :
   methods.clear();
   fields.parent = this;
   inherits.parent = this;
-  gAggregateTypes.add(this);
+  addToGVec(gAggregateTypes, this);
 }
 
 
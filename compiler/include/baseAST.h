@@ -37,6 +37,7 @@
 #include <string>
 
 #include "map.h"
+#include "runpasses.h"
 #include "vec.h"
 
 //
@@ -103,6 +104,24 @@ foreach_ast(proto_classes);
 foreach_ast(decl_gvecs);
 #undef decl_gvecs
 
+void lockGVecs();
+void unlockGVecs();
+
+//
+// add a newly constructed node to its global vector; while a pass is
+// running on several threads the vectors are shared by all of them
+//
+template <typename NodeType>
+static inline void addToGVec(Vec<NodeType*>& gvec, NodeType* node) {
+  if (parallelPassRunning) {
+    lockGVecs();
+    gvec.add(node);
+    unlockGVecs();
+  } else {
+    gvec.add(node);
+  }
+}
+
 //
 // type definitions for common maps
 //
@@ -266,7 +285,10 @@ void   trace_remove(BaseAST* ast, char flag);
 //
 #define SET_LINENO(ast) astlocMarker markAstLoc(ast->astloc)
 
-extern astlocT currentAstLoc;
+// The global line number is kept per thread, as two plain variables
+// because __thread cannot hold an astlocT.
+extern __thread const char* currentAstFilename;
+extern __thread int         currentAstLineno;
 
 class astlocMarker {
 public:
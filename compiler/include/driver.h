@@ -61,6 +61,7 @@ extern bool fNoOptimizeOnClauses;
 extern bool fNoRemoveEmptyRecords;
 extern bool fRemoveUnreachableBlocks;
 extern int  optimize_on_clause_limit;
+extern int  fPassThreads;
 extern int  scalar_replace_limit;
 extern int  tuple_copy_limit;
 
@@ -128,6 +129,9 @@ extern bool llvmCodegen;
 // Is the cache for remote data enabled?
 extern bool fCacheRemote;
 
+// Should the generated C for each module be compiled separately?
+extern bool fIncrementalCompile;
+
 // externC allows blocks like extern { } to be parsed
 // with clang and then added to the enclosing module's scope
 extern bool externC;
@@ -40,7 +40,11 @@ struct fileinfo {
   const char* pathname;
 };
 
-void codegen_makefile(fileinfo* mainfile, const char** tmpbinname=NULL, bool skip_compile_link=false);
+// separateFiles lists generated .c files (without the extension) that
+// are compiled on their own, rather than #included in mainfile.
+void codegen_makefile(fileinfo* mainfile, const char** tmpbinname=NULL,
+                      bool skip_compile_link=false,
+                      Vec<const char*>* separateFiles=NULL);
 
 void ensureDirExists(const char* /* dirname */, const char* /* explanation */);
 const char* getCwd();
@@ -20,6 +20,7 @@
 #ifndef _RUN_PASSES_H_
 #define _RUN_PASSES_H_
 
+class FnSymbol;
 class PhaseTracker;
 
 #include "vec.h"
@@ -27,6 +28,11 @@ class PhaseTracker;
 void runPasses(PhaseTracker& tracker, bool isChpldoc);
 void initLogFlags(Vec<char>&);
 
+void forEachFunctionInParallel(void (*fnPass)(FnSymbol*));
+
 extern int currentPassNo;
 
+// true while forEachFunctionInParallel has more than one thread running
+extern bool parallelPassRunning;
+
 #endif
@@ -23,12 +23,16 @@
 #include "log.h"           // For LOG_<passname> #defines.
 #include "passes.h"        // For pass function prototypes.
 #include "PhaseTracker.h"
+#include "symbol.h"
 
 #include <cstdio>
+#include <pthread.h>
 #include <sys/time.h>
 
 int   currentPassNo   = 1;
 
+bool  parallelPassRunning = false;
+
 struct PassInfo {
   void (*passFunction) ();      // The function which implements the pass.
   void (*checkFunction)();      // per-pass check function
@@ -250,3 +254,79 @@ void initLogFlags(Vec<char>& valid_log_flags) {
     }
   }
 }
+
+/************************************* | **************************************
+*                                                                             *
+* Run a function-local pass over the functions in gFnSymbols using            *
+* --pass-threads threads.                                                     *
+*                                                                             *
+* The pass may change only the function it is given, though it may read       *
+* others.  The threads share the global vectors and the astr table, which     *
+* lock themselves while parallelPassRunning, and each has its own line        *
+* number (currentAstLineno) and basic block builder state.  New nodes get     *
+* their ids in whatever order the threads create them, so the generated code  *
+* is only reproducible with one thread.                                       *
+*                                                                             *
+************************************** | *************************************/
+
+struct FunctionPassWork {
+  void          (*fnPass)(FnSymbol*);
+  Vec<FnSymbol*>  fns;
+  int             next;      // index of the next function to hand out
+  const char*     filename;  // the caller's line number, for SET_LINENO
+  int             lineno;
+};
+
+static void* runFunctionPassThread(void* arg) {
+  FunctionPassWork* work = static_cast<FunctionPassWork*>(arg);
+
+  currentAstFilename = work->filename;
+  currentAstLineno   = work->lineno;
+
+  for (int i = __sync_fetch_and_add(&work->next, 1);
+       i < work->fns.n;
+       i = __sync_fetch_and_add(&work->next, 1)) {
+    (*work->fnPass)(work->fns.v[i]);
+  }
+
+  return NULL;
+}
+
+void forEachFunctionInParallel(void (*fnPass)(FnSymbol*)) {
+  int numThreads = (fPassThreads < gFnSymbols.n) ? fPassThreads : gFnSymbols.n;
+
+  if (numThreads <= 1) {
+    forv_Vec(FnSymbol, fn, gFnSymbols) {
+      (*fnPass)(fn);
+    }
+
+  } else {
+    FunctionPassWork work;
+    pthread_t*       threads = new pthread_t[numThreads - 1];
+
+    // Snapshot the functions, since gFnSymbols may grow as they run.
+    work.fnPass   = fnPass;
+    work.fns.copy(gFnSymbols);
+    work.next     = 0;
+    work.filename = currentAstFilename;
+    work.lineno   = currentAstLineno;
+
+    parallelPassRunning = true;
+
+    for (int i = 0; i < numThreads - 1; i++) {
+      if (pthread_create(&threads[i], NULL, runFunctionPassThread, &work) != 0)
+        INT_FATAL("unable to create a thread for a function pass");
+    }
+
+    // The calling thread takes its share of the functions too.
+    runFunctionPassThread(&work);
+
+    for (int i = 0; i < numThreads - 1; i++) {
+      pthread_join(threads[i], NULL);
+    }
+
+    parallelPassRunning = false;
+
+    delete [] threads;
+  }
+}
@@ -26,6 +26,7 @@
 #include "bitVec.h"
 #include "expr.h"
 #include "passes.h"
+#include "runpasses.h"
 #include "stlUtil.h"
 #include "stmt.h"
 
@@ -123,8 +124,8 @@
 //#############################################################################
 
 
-static size_t s_repl_count; ///< The number of pairs replaced by GCP this pass.
-static size_t s_ref_repl_count; ///< The number of references replaced this pass.
+static __thread size_t s_repl_count; ///< The number of pairs replaced by GCP this pass.
+static __thread size_t s_ref_repl_count; ///< The number of references replaced this pass.
 
 
 //#############################################################################
@@ -1386,38 +1387,41 @@ size_t singleAssignmentRefPropagation(FnSymbol* fn) {
 }
 
 
-void copyPropagation(void) {
-  if (!fNoCopyPropagation) {
-    forv_Vec(FnSymbol, fn, gFnSymbols)
-    {
-      // This test is necessary because extern function stubs may contain
-      // _construct_tuple calls that are unresolved.
-      if (fn->hasFlag(FLAG_EXTERN))
-        continue;
+static void copyPropagation(FnSymbol* fn) {
+  // This test is necessary because extern function stubs may contain
+  // _construct_tuple calls that are unresolved.
+  if (fn->hasFlag(FLAG_EXTERN))
+    return;
 
-      localCopyPropagation(fn);
-      if (!fNoDeadCodeElimination)
-        deadVariableElimination(fn);
+  localCopyPropagation(fn);
+  if (!fNoDeadCodeElimination)
+    deadVariableElimination(fn);
 
-      // Iterate GCP with dead code elimination.
-      while (globalCopyPropagation(fn) > 0)
-      {
-        if (!fNoDeadCodeElimination)
-          deadVariableElimination(fn);
-      }
-    }
+  // Iterate GCP with dead code elimination.
+  while (globalCopyPropagation(fn) > 0)
+  {
+    if (!fNoDeadCodeElimination)
+      deadVariableElimination(fn);
   }
 }
 
 
+void copyPropagation(void) {
+  if (!fNoCopyPropagation)
+    forEachFunctionInParallel(copyPropagation);
+}
+
+
+static void refPropagation(FnSymbol* fn) {
+  singleAssignmentRefPropagation(fn);
+  if (!fNoDeadCodeElimination)
+    deadVariableElimination(fn);
+}
+
+
 void refPropagation() {
-  if (!fNoCopyPropagation) {
-    forv_Vec(FnSymbol, fn, gFnSymbols) {
-      singleAssignmentRefPropagation(fn);
-      if (!fNoDeadCodeElimination)
-        deadVariableElimination(fn);
-    }
-  }
+  if (!fNoCopyPropagation)
+    forEachFunctionInParallel(refPropagation);
 }
 
 
@@ -20,6 +20,7 @@
 #include "passes.h"
 
 #include "astutil.h"
+#include "runpasses.h"
 #include "stlUtil.h"
 #include "expr.h"
 #include "stmt.h"
@@ -35,39 +36,41 @@
 // would set a local copy of a given value, and other functions wouldn't
 // see the intended value.
 
-void localizeGlobals() {
-  if (fNoGlobalConstOpt) return;
-  forv_Vec(FnSymbol, fn, gFnSymbols) {
-    Map<Symbol*,VarSymbol*> globals;
-    std::vector<BaseAST*> asts;
-    collect_asts(fn->body, asts);
-    for_vector(BaseAST, ast, asts) {
-      if (SymExpr* se = toSymExpr(ast)) {
-        Symbol* var = se->var;
-        ModuleSymbol* parentmod = toModuleSymbol(var->defPoint->parentSymbol);
+static void localizeGlobals(FnSymbol* fn) {
+  Map<Symbol*,VarSymbol*> globals;
+  std::vector<BaseAST*> asts;
+  collect_asts(fn->body, asts);
+  for_vector(BaseAST, ast, asts) {
+    if (SymExpr* se = toSymExpr(ast)) {
+      Symbol* var = se->var;
+      ModuleSymbol* parentmod = toModuleSymbol(var->defPoint->parentSymbol);
 
-        // Is var a global constant?
-        // Don't replace the var name in its init function since that's
-        //      where we're setting the value.
-        // If the parentSymbol is the rootModule, the var is 'void,'
-        //      'false,' '0,' ...
-        if (parentmod &&
-            fn != parentmod->initFn &&
-            var->hasFlag(FLAG_CONST) &&
-            var->defPoint->parentSymbol != rootModule) {
-          VarSymbol* local_global = globals.get(var);
-          SET_LINENO(se); // Set the se line number for output
-          if (!local_global) {
-            const char * newname = astr("local_", var->cname);
-            local_global = newTemp(newname, var->type);
-            fn->insertAtHead(new CallExpr(PRIM_MOVE, local_global, var));
-            fn->insertAtHead(new DefExpr(local_global));
+      // Is var a global constant?
+      // Don't replace the var name in its init function since that's
+      //      where we're setting the value.
+      // If the parentSymbol is the rootModule, the var is 'void,'
+      //      'false,' '0,' ...
+      if (parentmod &&
+          fn != parentmod->initFn &&
+          var->hasFlag(FLAG_CONST) &&
+          var->defPoint->parentSymbol != rootModule) {
+        VarSymbol* local_global = globals.get(var);
+        SET_LINENO(se); // Set the se line number for output
+        if (!local_global) {
+          const char * newname = astr("local_", var->cname);
+          local_global = newTemp(newname, var->type);
+          fn->insertAtHead(new CallExpr(PRIM_MOVE, local_global, var));
+          fn->insertAtHead(new DefExpr(local_global));
 
-            globals.put(var, local_global);
-          }
-          se->replace(new SymExpr(toSymbol(local_global)));
+          globals.put(var, local_global);
         }
+        se->replace(new SymExpr(toSymbol(local_global)));
       }
     }
   }
 }
+
+void localizeGlobals() {
+  if (fNoGlobalConstOpt) return;
+  forEachFunctionInParallel(localizeGlobals);
+}
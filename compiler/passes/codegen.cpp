@@ -36,6 +36,7 @@
 #include "symbol.h"
 
 #include <inttypes.h>
+#include <unistd.h>
 
 #include <cctype>
 #include <cstring>
@@ -133,7 +134,9 @@ genGlobalDefClassId(const char* cname, int id) {
   name += cname;
   
   if( info->cfile ) {
-    fprintf(info->cfile, "const %s %s = %d;\n", 
+    // With --incremental, each module's .c file gets its own copy.
+    fprintf(info->cfile, "%sconst %s %s = %d;\n",
+                      fIncrementalCompile ? "static " : "",
                       id_type_name, name.c_str(), id);
   } else {
 #ifdef HAVE_LLVM
@@ -613,7 +616,12 @@ static void protectNameFromC(Symbol* sym) {
 
 
 // TODO: Split this into a number of smaller routines.<hilde>
-static void codegen_header() {
+//
+// With --incremental, the header is included in each module's .c file,
+// so everything it would define (rather than declare) goes in mainfile
+// instead.
+//
+static void codegen_header(FILE* mainfile) {
   GenInfo* info = gGenInfo;
   Vec<const char*> cnames;
   Vec<TypeSymbol*> types;
@@ -798,6 +806,7 @@ static void codegen_header() {
   codegen_header_compilation_config();
 
   FILE* hdrfile = info->cfile;
+  FILE* defsfile = fIncrementalCompile ? mainfile : hdrfile;
 
   if( hdrfile ) {
     // This is done in runClang for LLVM version.
@@ -811,7 +820,7 @@ static void codegen_header() {
     fprintf(hdrfile, "#include \"stdchpl.h\"\n");
 
     // Include the compilation config file
-    fprintf(hdrfile, "#include \"%s.c\"\n", sCfgFname);
+    fprintf(defsfile, "#include \"%s.c\"\n", sCfgFname);
 
 #ifdef HAVE_LLVM
     //include generated extern C header file
@@ -906,21 +915,33 @@ static void codegen_header() {
     }
   }
 
+  info->cfile = defsfile;
   genFtable(ftableVec);
 
   genComment("Virtual Method Table");
   genVirtualMethodTable(types);
+  info->cfile = hdrfile;
+  if (defsfile != hdrfile)
+    fprintf(hdrfile, "extern chpl_fn_p chpl_vmtable[];\n");
 
   genComment("Global Variables");
   forv_Vec(VarSymbol, varSymbol, globals) {
     varSymbol->codegenGlobalDef();
   }
+  if (defsfile != hdrfile) {
+    for (size_t i = 0; i < info->cLocalDecls.size(); i++) {
+      fprintf(hdrfile, "extern %s;\n", info->cLocalDecls[i].c_str());
+      fprintf(defsfile, "%s;\n", info->cLocalDecls[i].c_str());
+    }
+    info->cLocalDecls.clear();
+  }
   flushStatements();
 
+  info->cfile = defsfile;
   genGlobalInt("chpl_numGlobalsOnHeap", numGlobalsOnHeap);
   int globals_registry_static_size = (numGlobalsOnHeap ? numGlobalsOnHeap : 1);
-  if( hdrfile ) {
-    fprintf(hdrfile, "\nptr_wide_ptr_t chpl_globals_registry[%d];\n",
+  if( defsfile ) {
+    fprintf(defsfile, "\nptr_wide_ptr_t chpl_globals_registry[%d];\n",
                      globals_registry_static_size);
   } else {
 #ifdef HAVE_LLVM
@@ -945,16 +966,16 @@ static void codegen_header() {
 #endif
   }
   genGlobalInt("chpl_heterogeneous", fHeterogeneous?1:0);
-  if( hdrfile ) {
-    fprintf(hdrfile, "\nconst char* chpl_mem_descs[] = {\n");
+  if( defsfile ) {
+    fprintf(defsfile, "\nconst char* chpl_mem_descs[] = {\n");
     bool first = true;
     forv_Vec(const char*, memDesc, memDescsVec) {
       if (!first)
-        fprintf(hdrfile, ",\n");
-      fprintf(hdrfile, "\"%s\"", memDesc);
+        fprintf(defsfile, ",\n");
+      fprintf(defsfile, "\"%s\"", memDesc);
       first = false;
     }
-    fprintf(hdrfile, "\n};\n");
+    fprintf(defsfile, "\n};\n");
   } else {
 #ifdef HAVE_LLVM
     std::vector<llvm::Constant *> memDescTable;
@@ -985,18 +1006,18 @@ static void codegen_header() {
   //
   // add table of private-broadcast constants
   //
-  if( hdrfile ) {
-    fprintf(hdrfile, "\nvoid* const chpl_private_broadcast_table[] = {\n");
-    fprintf(hdrfile, "&chpl_verbose_comm");
-    fprintf(hdrfile, ",\n&chpl_comm_diagnostics");
-    fprintf(hdrfile, ",\n&chpl_verbose_mem");
+  if( defsfile ) {
+    fprintf(defsfile, "\nvoid* const chpl_private_broadcast_table[] = {\n");
+    fprintf(defsfile, "&chpl_verbose_comm");
+    fprintf(defsfile, ",\n&chpl_comm_diagnostics");
+    fprintf(defsfile, ",\n&chpl_verbose_mem");
     int i = 3;
     forv_Vec(CallExpr, call, gCallExprs) {
       if (call->isPrimitive(PRIM_PRIVATE_BROADCAST)) {
         SymExpr* se = toSymExpr(call->get(1));
         INT_ASSERT(se);
         SET_LINENO(call);
-        fprintf(hdrfile, ",\n&%s", se->var->cname);
+        fprintf(defsfile, ",\n&%s", se->var->cname);
         // To preserve operand order, this should be insertAtTail.
         // The change must also be made below (for LLVM) and in the signature
         // of chpl_comm_broadcast_private().
@@ -1004,7 +1025,7 @@ static void codegen_header() {
         i++;
       }
     }
-    fprintf(hdrfile, "\n};\n");
+    fprintf(defsfile, "\n};\n");
   } else {
 #ifdef HAVE_LLVM
     llvm::Type *private_broadcastTableEntryType =
@@ -1060,6 +1081,8 @@ static void codegen_header() {
   }
 
 
+  info->cfile = hdrfile;
+
   if (hdrfile) {
     fprintf(hdrfile, "#include \"chpl-gen-includes.h\"\n");
   }
@@ -1213,6 +1236,9 @@ void codegen(void) {
     }
   }
 
+  if (fIncrementalCompile && llvmCodegen)
+    USR_FATAL("--incremental is not supported with --llvm");
+
   if( widePointersStruct ) {
     // OK
   } else {
@@ -1257,13 +1283,11 @@ void codegen(void) {
     openCFile(&mainfile, "_main",        "c");
 
     fprintf(mainfile.fptr, "#include \"chpl__header.h\"\n");
-
-    codegen_makefile(&mainfile);
   }
 
   // This dumps the generated sources into the build directory.
   info->cfile = hdrfile.fptr;
-  codegen_header();
+  codegen_header(mainfile.fptr);
 
   info->cfile = mainfile.fptr;
   codegen_config();
@@ -1295,6 +1319,7 @@ void codegen(void) {
   }
 
   ChainHashMap<char*, StringHashFns, int> filenames;
+  Vec<const char*> separateFiles;
   forv_Vec(ModuleSymbol, currentModule, allModules) {
     mysystem(astr("# codegen-ing module", currentModule->name),
              "generating comment for --print-commands option");
@@ -1333,10 +1358,15 @@ void codegen(void) {
     fileinfo modulefile;
     openCFile(&modulefile, filename, "c");
     info->cfile = modulefile.fptr;
+    if (fIncrementalCompile)
+      fprintf(modulefile.fptr, "#include \"chpl__header.h\"\n");
     
     currentModule->codegenDef();
     closeCFile(&modulefile);
-    fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
+    if (fIncrementalCompile)
+      separateFiles.add(astr(filename));
+    else
+      fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
   }
 
   if (fHeterogeneous) 
@@ -1348,6 +1378,8 @@ void codegen(void) {
   closeCFile(&hdrfile);
   closeCFile(&mainfile);
 
+  codegen_makefile(&mainfile, NULL, false, &separateFiles);
+
   if (fPrintEmittedCodeSize)
   {
     fprintf(stderr, "Statements emitted: %d\n", gStmtCount);
@@ -1364,8 +1396,14 @@ void makeBinary(void) {
 #endif
   } else {
     const char* makeflags = printSystemCommands ? "-f " : "-s -f ";
+    const char* jobsflag = "";
+    if (fIncrementalCompile) {
+      // Compile the modules' .c files in parallel.
+      long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+      jobsflag = astr("-j", istr(numCPUs > 0 ? (int) numCPUs : 1), " ");
+    }
     const char* command = astr(astr(CHPL_MAKE, " "),
-                               makeflags,
+                               jobsflag, makeflags,
                                getIntermediateDirName(), "/Makefile");
     mysystem(command, "compiling generated source");
   }
@@ -485,7 +485,8 @@ void createTaskFunctions(void) {
 
           markOuterVarsWithIntents(block->byrefVars, uses);
           pruneThisArg(call->parentSymbol, uses);
-          block->byrefVars->remove();
+          if (block->byrefVars)
+            block->byrefVars->remove();
 
           addVarsToActuals(call, uses);
           addVarsToFormals(fn, uses);
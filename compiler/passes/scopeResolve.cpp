@@ -245,11 +245,11 @@ static void addOneToSymbolTable(DefExpr* def)
 
     BaseAST* scope = getScope(def);
 
-    if (symbolTable.count(scope) == 0) {
-      symbolTable[scope] = new SymbolTableEntry();
-    }
+    SymbolTableEntry*& entry = symbolTable[scope];
 
-    SymbolTableEntry* entry = symbolTable[scope];
+    if (entry == NULL) {
+      entry = new SymbolTableEntry();
+    }
 
     if (entry->count(def->sym->name) != 0) {
       Symbol*     sym       = (*entry)[def->sym->name];
@@ -906,8 +906,14 @@ static void build_constructor(AggregateType* ct) {
     if (field->hasFlag(FLAG_PARAM))
       arg->intent = INTENT_PARAM;
 
-    Expr* exprType = field->defPoint->exprType->remove();
-    Expr* init     = field->defPoint->init->remove();
+    Expr* exprType = field->defPoint->exprType;
+    Expr* init     = field->defPoint->init;
+
+    if (exprType)
+      exprType->remove();
+
+    if (init)
+      init->remove();
 
     bool hadType = exprType;
     bool hadInit = init;
@@ -1678,6 +1684,10 @@ static void lookupSimple(BaseAST*       scope,
                          const char*    name,
                          Vec<Symbol*>&  symbols);
 
+static void lookupInTable(BaseAST*       scope,
+                          const char*    name,
+                          Vec<Symbol*>&  symbols);
+
 static void    buildBreadthFirstModuleList(Vec<ModuleSymbol*>* modules);
 
 static void    buildBreadthFirstModuleList(Vec<ModuleSymbol*>* modules,
@@ -1719,14 +1729,7 @@ static void lookup(BaseAST*       scope,
   if (!alreadyVisited.set_in(scope)) {
     alreadyVisited.set_add(scope);
 
-    if (symbolTable.count(scope) != 0) {
-      SymbolTableEntry* entry = symbolTable[scope];
-
-      if (entry->count(name) != 0) {
-        Symbol* sym = (*entry)[name];
-        symbols.set_add(sym);
-      }
-    }
+    lookupInTable(scope, name, symbols);
 
     if (TypeSymbol* ts = toTypeSymbol(scope))
       if (AggregateType* ct = toAggregateType(ts->type))
@@ -1736,9 +1739,12 @@ static void lookup(BaseAST*       scope,
     if (symbols.n == 0) {
       if (BlockStmt* block = toBlockStmt(scope)) {
         if (block->modUses) {
+          std::map<BlockStmt*,Vec<ModuleSymbol*>*>::iterator cached;
           Vec<ModuleSymbol*>* modules = NULL;
 
-          if (moduleUsesCache.count(block) == 0) {
+          cached = moduleUsesCache.find(block);
+
+          if (cached == moduleUsesCache.end()) {
             modules = new Vec<ModuleSymbol*>();
 
             for_actuals(expr, block->modUses) {
@@ -1758,7 +1764,7 @@ static void lookup(BaseAST*       scope,
             if (enableModuleUsesCache)
               moduleUsesCache[block] = modules;
           } else {
-            modules = moduleUsesCache[block];
+            modules = cached->second;
           }
 
           forv_Vec(ModuleSymbol, mod, *modules) {
@@ -1799,19 +1805,29 @@ static void lookup(BaseAST*       scope,
   }
 }
 
+// Adds the symbol named 'name' defined directly in 'scope', if any.
+// This is the innermost step of every lookup, so each map is only
+// searched once.
+static void lookupInTable(BaseAST*       scope,
+                          const char*    name,
+                          Vec<Symbol*>&  symbols)
+{
+  SymbolTable::iterator entry = symbolTable.find(scope);
+
+  if (entry != symbolTable.end()) {
+    SymbolTableEntry::iterator sym = entry->second->find(name);
+
+    if (sym != entry->second->end())
+      symbols.set_add(sym->second);
+  }
+}
+
 // This version does not recurse through module uses.
 static void lookupSimple(BaseAST*       scope,
                          const char*    name,
                          Vec<Symbol*>&  symbols)
 {
-  if (symbolTable.count(scope) != 0) {
-    SymbolTableEntry* entry = symbolTable[scope];
-
-    if (entry->count(name) != 0) {
-      Symbol* sym = (*entry)[name];
-      symbols.set_add(sym);
-    }
-  }
+  lookupInTable(scope, name, symbols);
 
   if (TypeSymbol* ts = toTypeSymbol(scope))
     if (AggregateType* ct = toAggregateType(ts->type))
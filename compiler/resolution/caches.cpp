@@ -23,21 +23,60 @@
 #include "stringutil.h"
 
 
+//
+// hash a symbol map independently of the order of its elements; since
+// a missing key is treated as mapping to NULL, elements with NULL
+// values do not contribute to the hash
+//
+// the hash is never zero because zero is the empty key of a Map
+//
+static unsigned int
+hashSymbolMap(SymbolMap* map) {
+  unsigned int hash = 0;
+  form_Map(SymbolMapElem, e, *map)
+    if (e->value)
+      hash += ((unsigned int)e->key->id * 0x9e3779b1u) ^ (unsigned int)e->value->id;
+  return hash | 1;
+}
+
+
+//
+// hash a vector of symbols as a set, independently of the order and
+// any repetition of its elements
+//
+static unsigned int
+hashSymbolVec(Vec<Symbol*>* vec) {
+  unsigned int hash = 0;
+  for (int i = 0; i < vec->n; i++) {
+    bool repeated = false;
+    for (int j = 0; j < i; j++)
+      if (vec->v[j] == vec->v[i])
+        repeated = true;
+    if (!repeated && vec->v[i])
+      hash += (unsigned int)vec->v[i]->id * 0x9e3779b1u;
+  }
+  return hash | 1;
+}
+
+
 SymbolMapCacheEntry::SymbolMapCacheEntry(FnSymbol* ifn, SymbolMap* imap) :
   fn(ifn), map(*imap) { }
 
 
 void
 addCache(SymbolMapCache& cache, FnSymbol* oldFn, FnSymbol* fn, SymbolMap* map) {
-  Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn);
-  SymbolMapCacheEntry* entry = new SymbolMapCacheEntry(fn, map);
-  if (entries) {
-    entries->add(entry);
-  } else {
+  SymbolMapCacheBuckets* buckets = cache.get(oldFn);
+  if (!buckets) {
+    buckets = new SymbolMapCacheBuckets();
+    cache.put(oldFn, buckets);
+  }
+  unsigned int hash = hashSymbolMap(map);
+  Vec<SymbolMapCacheEntry*>* entries = buckets->get(hash);
+  if (!entries) {
     entries = new Vec<SymbolMapCacheEntry*>();
-    entries->add(entry);
-    cache.put(oldFn, entries);
+    buckets->put(hash, entries);
   }
+  entries->add(new SymbolMapCacheEntry(fn, map));
 }
 
 
@@ -53,27 +92,33 @@ isCacheEntryMatch(SymbolMap* s1, SymbolMap* s2) {
 }
 
 
-FnSymbol*
-checkCache(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
-  if (Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn)) {
-    forv_Vec(SymbolMapCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map))
-        return entry->fn;
+static SymbolMapCacheEntry*
+findCacheEntry(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
+  if (SymbolMapCacheBuckets* buckets = cache.get(oldFn)) {
+    if (Vec<SymbolMapCacheEntry*>* entries = buckets->get(hashSymbolMap(map))) {
+      forv_Vec(SymbolMapCacheEntry, entry, *entries) {
+        if (isCacheEntryMatch(map, &entry->map))
+          return entry;
+      }
     }
   }
   return NULL;
 }
 
 
+FnSymbol*
+checkCache(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
+  if (SymbolMapCacheEntry* entry = findCacheEntry(cache, oldFn, map))
+    return entry->fn;
+  return NULL;
+}
+
+
 void
 replaceCache(SymbolMapCache& cache, FnSymbol* oldFn, FnSymbol* fn, SymbolMap* map) {
-  if (Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn)) {
-    forv_Vec(SymbolMapCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map)) {
-        entry->fn = fn;
-        return;
-      }
-    }
+  if (SymbolMapCacheEntry* entry = findCacheEntry(cache, oldFn, map)) {
+    entry->fn = fn;
+    return;
   }
   INT_FATAL(oldFn, "unable to replace cache entry; entry does not exist");
 }
@@ -82,8 +127,11 @@ replaceCache(SymbolMapCache& cache, FnSymbol* oldFn, FnSymbol* fn, SymbolMap* ma
 void
 freeCache(SymbolMapCache& cache) {
   form_Map(SymbolMapCacheElem, elem, cache) {
-    forv_Vec(SymbolMapCacheEntry, entry, *elem->value) {
-      delete entry;
+    form_Map(SymbolMapCacheBucketsElem, bucket, *elem->value) {
+      forv_Vec(SymbolMapCacheEntry, entry, *bucket->value) {
+        delete entry;
+      }
+      delete bucket->value;
     }
     delete elem->value;
   }
@@ -97,14 +145,18 @@ SymbolVecCacheEntry::SymbolVecCacheEntry(FnSymbol* ifn, Vec<Symbol*>* ivec) :
 
 void
 addCache(SymbolVecCache& cache, FnSymbol* oldFn, FnSymbol* fn, Vec<Symbol*>* vec) {
-  Vec<SymbolVecCacheEntry*>* entries = cache.get(oldFn);
-  if (entries) {
-    entries->add(new SymbolVecCacheEntry(fn, vec));
-  } else {
+  SymbolVecCacheBuckets* buckets = cache.get(oldFn);
+  if (!buckets) {
+    buckets = new SymbolVecCacheBuckets();
+    cache.put(oldFn, buckets);
+  }
+  unsigned int hash = hashSymbolVec(vec);
+  Vec<SymbolVecCacheEntry*>* entries = buckets->get(hash);
+  if (!entries) {
     entries = new Vec<SymbolVecCacheEntry*>();
-    entries->add(new SymbolVecCacheEntry(fn, vec));
-    cache.put(oldFn, entries);
+    buckets->put(hash, entries);
   }
+  entries->add(new SymbolVecCacheEntry(fn, vec));
 }
 
 
@@ -122,10 +174,12 @@ isCacheEntryMatch(Vec<Symbol*>* vec1, Vec<Symbol*>* vec2) {
 
 FnSymbol*
 checkCache(SymbolVecCache& cache, FnSymbol* fn, Vec<Symbol*>* vec) {
-  if (Vec<SymbolVecCacheEntry*>* entries = cache.get(fn)) {
-    forv_Vec(SymbolVecCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(vec, &entry->vec)) {
-        return entry->fn;
+  if (SymbolVecCacheBuckets* buckets = cache.get(fn)) {
+    if (Vec<SymbolVecCacheEntry*>* entries = buckets->get(hashSymbolVec(vec))) {
+      forv_Vec(SymbolVecCacheEntry, entry, *entries) {
+        if (isCacheEntryMatch(vec, &entry->vec)) {
+          return entry->fn;
+        }
       }
     }
   }
@@ -136,8 +190,11 @@ checkCache(SymbolVecCache& cache, FnSymbol* fn, Vec<Symbol*>* vec) {
 void
 freeCache(SymbolVecCache& cache) {
   form_Map(SymbolVecCacheElem, elem, cache) {
-    forv_Vec(SymbolVecCacheEntry, entry, *elem->value) {
-      delete entry;
+    form_Map(SymbolVecCacheBucketsElem, bucket, *elem->value) {
+      forv_Vec(SymbolVecCacheEntry, entry, *bucket->value) {
+        delete entry;
+      }
+      delete bucket->value;
     }
     delete elem->value;
   }
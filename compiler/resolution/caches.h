@@ -33,6 +33,10 @@
 //                               and the maps contain the same
 //                               key-value pairs (in any order)
 //
+//   The entries for each function are bucketed by an
+//   order-independent hash of their maps, so checkCache only compares
+//   maps within one bucket.
+//
 //   freeCache(cache): frees memory associated with cache
 //
 class SymbolMapCacheEntry {
@@ -41,8 +45,10 @@ class SymbolMapCacheEntry {
   FnSymbol* fn;
   SymbolMap map;
 };
-typedef Map<FnSymbol*,Vec<SymbolMapCacheEntry*>*> SymbolMapCache;
-typedef MapElem<FnSymbol*,Vec<SymbolMapCacheEntry*>*> SymbolMapCacheElem;
+typedef Map<unsigned int,Vec<SymbolMapCacheEntry*>*> SymbolMapCacheBuckets;
+typedef MapElem<unsigned int,Vec<SymbolMapCacheEntry*>*> SymbolMapCacheBucketsElem;
+typedef Map<FnSymbol*,SymbolMapCacheBuckets*> SymbolMapCache;
+typedef MapElem<FnSymbol*,SymbolMapCacheBuckets*> SymbolMapCacheElem;
 
 
 void addCache(SymbolMapCache& cache, FnSymbol* old, FnSymbol* fn, SymbolMap* map);
@@ -64,8 +70,10 @@ class SymbolVecCacheEntry {
   FnSymbol* fn;
   Vec<Symbol*> vec;
 };
-typedef Map<FnSymbol*,Vec<SymbolVecCacheEntry*>*> SymbolVecCache;
-typedef MapElem<FnSymbol*,Vec<SymbolVecCacheEntry*>*> SymbolVecCacheElem;
+typedef Map<unsigned int,Vec<SymbolVecCacheEntry*>*> SymbolVecCacheBuckets;
+typedef MapElem<unsigned int,Vec<SymbolVecCacheEntry*>*> SymbolVecCacheBucketsElem;
+typedef Map<FnSymbol*,SymbolVecCacheBuckets*> SymbolVecCache;
+typedef MapElem<FnSymbol*,SymbolVecCacheBuckets*> SymbolVecCacheElem;
 
 void addCache(SymbolVecCache& cache, FnSymbol* newFn, FnSymbol* oldFn, Vec<Symbol*>* vec);
 FnSymbol* checkCache(SymbolVecCache& cache, FnSymbol* fn, Vec<Symbol*>* vec);
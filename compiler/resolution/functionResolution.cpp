@@ -301,6 +301,10 @@ getVisibleFunctions(BlockStmt* block,
                     const char* name,
                     Vec<FnSymbol*>& visibleFns,
                     Vec<BlockStmt*>& visited);
+static void
+getVisibleFunctions(BlockStmt* block,
+                    const char* name,
+                    Vec<FnSymbol*>& visibleFns);
 static Expr* resolve_type_expr(Expr* expr);
 static void makeNoop(CallExpr* call);
 static void resolveDefaultGenericType(CallExpr* call);
@@ -2600,6 +2604,83 @@ static int nVisibleFunctions = 0; // for incremental build
 static Map<BlockStmt*,BlockStmt*> visibilityBlockCache;
 static Vec<BlockStmt*> standardModuleSet;
 
+//
+// The parts of a call that determine which of the visible functions it
+// resolves to: the types of its actuals, the values of its param
+// actuals, which actuals are types, and the names of named actuals.
+//
+class CallSignature {
+ public:
+  CallSignature(CallInfo& info);
+  bool matches(CallSignature& other);
+  Vec<Symbol*>     actuals;     // param actuals, or the types' symbols
+  Vec<bool>        isTypes;     // type actuals
+  Vec<const char*> actualNames; // named arguments
+  unsigned int     hash;
+};
+
+CallSignature::CallSignature(CallInfo& info) :
+  actualNames(info.actualNames), hash(0) {
+  forv_Vec(Symbol, actual, info.actuals) {
+    Symbol* sym = actual;
+    if (!actual->isParameter() && !actual->isImmediate() &&
+        !isEnumSymbol(actual))
+      sym = actual->type->symbol;
+    actuals.add(sym);
+    isTypes.add(actual->hasFlag(FLAG_TYPE_VARIABLE));
+    hash = hash * 31 + (unsigned int)sym->id * 2 + isTypes.tail();
+  }
+}
+
+bool CallSignature::matches(CallSignature& other) {
+  if (hash != other.hash || actuals.n != other.actuals.n)
+    return false;
+  for (int i = 0; i < actuals.n; i++)
+    if (actuals.v[i] != other.actuals.v[i] ||
+        isTypes.v[i] != other.isTypes.v[i] ||
+        actualNames.v[i] != other.actualNames.v[i])
+      return false;
+  return true;
+}
+
+class ResolvedCall {
+ public:
+  ResolvedCall(CallSignature& isig, FnSymbol* ifn) : sig(isig), fn(ifn) { }
+  CallSignature sig;
+  FnSymbol* fn;
+};
+
+//
+// The functions visible by a name from a visibility block, i.e., the
+// full result of getVisibleFunctions including the blocks of used
+// modules, and the function that each call signature seen from that
+// block resolved to.
+//
+class VisibleFunctionIndexBlock {
+ public:
+  Vec<FnSymbol*> visibleFunctions;
+  Vec<ResolvedCall*> resolvedCalls;
+  ~VisibleFunctionIndexBlock() {
+    forv_Vec(ResolvedCall, rc, resolvedCalls) {
+      delete rc;
+    }
+  }
+};
+
+//
+// visibleFunctionIndex maps a name to an index block for each
+// visibility block that has been searched.  An entry stays valid
+// until a function with that name is added to the visible function
+// map, which is the only way the result of a search can change.
+//
+typedef Map<BlockStmt*,VisibleFunctionIndexBlock*> VisibleFunctionIndexEntry;
+static Map<const char*,VisibleFunctionIndexEntry*> visibleFunctionIndex;
+static int nVisibleFunctionIndexHits = 0;
+static int nVisibleFunctionIndexMisses = 0;
+static int nVisibleFunctionIndexInvalidations = 0;
+static int nResolvedCallHits = 0;
+static int nResolvedCallMisses = 0;
+
 //
 // return true if expr is a CondStmt with chpl__tryToken as its condition 
 //
@@ -2646,6 +2727,23 @@ getVisibilityBlock(Expr* expr) {
   }
 }
 
+static void clearVisibleFunctionIndexEntry(VisibleFunctionIndexEntry* entry) {
+  Vec<VisibleFunctionIndexBlock*> vfibs;
+  entry->get_values(vfibs);
+  forv_Vec(VisibleFunctionIndexBlock, vfib, vfibs) {
+    delete vfib;
+  }
+  entry->clear();
+}
+
+static void invalidateVisibleFunctionIndex(const char* name) {
+  VisibleFunctionIndexEntry* entry = visibleFunctionIndex.get(name);
+  if (entry && entry->n) {
+    clearVisibleFunctionIndexEntry(entry);
+    nVisibleFunctionIndexInvalidations++;
+  }
+}
+
 static void buildVisibleFunctionMap() {
   for (int i = nVisibleFunctions; i < gFnSymbols.n; i++) {
     FnSymbol* fn = gFnSymbols.v[i];
@@ -2672,6 +2770,7 @@ static void buildVisibleFunctionMap() {
         vfb->visibleFunctions.put(fn->name, fns);
       }
       fns->add(fn);
+      invalidateVisibleFunctionIndex(fn->name);
     }
   }
   nVisibleFunctions = gFnSymbols.n;
@@ -2738,6 +2837,60 @@ getVisibleFunctions(BlockStmt* block,
   return NULL;
 }
 
+//
+// return the index block for the functions visible by name from
+// block, filling in visibleFunctionIndex as necessary
+//
+static VisibleFunctionIndexBlock*
+getVisibleFunctionIndexBlock(BlockStmt* block, const char* name) {
+  //
+  // index on the innermost block that can contribute functions, so
+  // that calls in different blocks of the same function share entries
+  //
+  while (block != rootModule->block &&
+         !isModuleSymbol(block->parentSymbol) &&
+         !block->modUses &&
+         !visibleFunctionMap.get(block))
+    block = getVisibilityBlock(block);
+
+  if (standardModuleSet.set_in(block))
+    block = theProgram->block;
+
+  VisibleFunctionIndexEntry* entry = visibleFunctionIndex.get(name);
+  if (!entry) {
+    entry = new VisibleFunctionIndexEntry();
+    visibleFunctionIndex.put(name, entry);
+  }
+
+  if (VisibleFunctionIndexBlock* vfib = entry->get(block)) {
+    nVisibleFunctionIndexHits++;
+    return vfib;
+  }
+
+  nVisibleFunctionIndexMisses++;
+  VisibleFunctionIndexBlock* vfib = new VisibleFunctionIndexBlock();
+  Vec<BlockStmt*> visited;
+  getVisibleFunctions(block, name, vfib->visibleFunctions, visited);
+  entry->put(block, vfib);
+  return vfib;
+}
+
+static void
+getVisibleFunctions(BlockStmt* block,
+                    const char* name,
+                    Vec<FnSymbol*>& visibleFns) {
+  visibleFns.append(getVisibleFunctionIndexBlock(block, name)->visibleFunctions);
+}
+
+static FnSymbol*
+checkResolvedCall(VisibleFunctionIndexBlock* vfib, CallSignature& sig) {
+  forv_Vec(ResolvedCall, rc, vfib->resolvedCalls) {
+    if (rc->sig.matches(sig))
+      return rc->fn;
+  }
+  return NULL;
+}
+
 static void handleCaptureArgs(CallExpr* call, FnSymbol* taskFn, CallInfo* info) {
   INT_ASSERT(taskFn);
   if (!needsCapture(taskFn)) {
@@ -3177,10 +3330,32 @@ void resolveNormalCall(CallExpr* call) {
     buildVisibleFunctionMap();
   }
 
+  bool explainCall = (explainCallLine && explainCallMatch(call)) ||
+    call->id == explainCallID;
+
+  //
+  // a call with the same signature as one already resolved from the
+  // same visibility block resolves to the same function, so if one
+  // is recorded it is the only function that needs to be considered
+  //
+  VisibleFunctionIndexBlock* vfib = NULL;
+  CallSignature sig(info);
+  int nInvalidations = nVisibleFunctionIndexInvalidations;
+
   if (!call->isResolved()) {
     if (!info.scope) {
-      Vec<BlockStmt*> visited;
-      getVisibleFunctions(getVisibilityBlock(call), info.name, visibleFns, visited);
+      vfib = getVisibleFunctionIndexBlock(getVisibilityBlock(call), info.name);
+      FnSymbol* fn = NULL;
+      if (!explainCall && !call->partialTag)
+        fn = checkResolvedCall(vfib, sig);
+      if (fn) {
+        nResolvedCallHits++;
+        visibleFns.add(fn);
+        vfib = NULL;
+      } else {
+        nResolvedCallMisses++;
+        visibleFns.append(vfib->visibleFunctions);
+      }
     } else {
       if (VisibleFunctionBlock* vfb = visibleFunctionMap.get(info.scope)) {
         if (Vec<FnSymbol*>* fns = vfb->visibleFunctions.get(info.name)) {
@@ -3193,8 +3368,7 @@ void resolveNormalCall(CallExpr* call) {
     handleCaptureArgs(call, call->isResolved(), &info);
   }
 
-  if ((explainCallLine && explainCallMatch(call)) ||
-      call->id == explainCallID)
+  if (explainCall)
   {
     USR_PRINT(call, "call: %s", toString(&info));
     if (visibleFns.n == 0)
@@ -3246,6 +3420,15 @@ void resolveNormalCall(CallExpr* call) {
     if (explainCallLine && explainCallMatch(call)) {
       USR_PRINT(best->fn, "best candidate is: %s", toString(best->fn));
     }
+
+    //
+    // vfib may have been freed if resolving the candidates added
+    // visible functions
+    //
+    if (vfib && !explainCall && !call->partialTag &&
+        !best->fn->hasFlag(FLAG_GENERIC) &&
+        nInvalidations == nVisibleFunctionIndexInvalidations)
+      vfib->resolvedCalls.add(new ResolvedCall(sig, best->fn));
   }
 
   // Future work note: the repeated check to best and best->fn means that we
@@ -4218,8 +4401,7 @@ createFunctionAsValue(CallExpr *call) {
   const char *flname = use->unresolved;
 
   Vec<FnSymbol*> visibleFns;
-  Vec<BlockStmt*> visited;
-  getVisibleFunctions(getVisibilityBlock(call), flname, visibleFns, visited);
+  getVisibleFunctions(getVisibilityBlock(call), flname, visibleFns);
 
   if (visibleFns.n > 1) {
     USR_FATAL(call, "%s: can not capture overloaded functions as values",
@@ -6846,6 +7028,22 @@ resolve() {
   visibleFunctionMap.clear();
   visibilityBlockCache.clear();
 
+  if (fPrintStatistics[0] != '\0') {
+    fprintf(stderr, "Visible function index: %d hits, %d misses, "
+            "%d invalidations\n", nVisibleFunctionIndexHits,
+            nVisibleFunctionIndexMisses, nVisibleFunctionIndexInvalidations);
+    fprintf(stderr, "Resolved call signatures: %d hits, %d misses\n",
+            nResolvedCallHits, nResolvedCallMisses);
+  }
+
+  Vec<VisibleFunctionIndexEntry*> entries;
+  visibleFunctionIndex.get_values(entries);
+  forv_Vec(VisibleFunctionIndexEntry, entry, entries) {
+    clearVisibleFunctionIndexEntry(entry);
+    delete entry;
+  }
+  visibleFunctionIndex.clear();
+
   forv_Vec(BlockStmt, stmt, gBlockStmts) {
     stmt->moduleUseClear();
   }
@@ -137,10 +137,7 @@ void addMinMax(const char* prefix, int nbits, bool isSigned)
   GenInfo* info = gGenInfo;
   LayeredValueTable *lvt = info->lvt;
 
-  astlocT prevloc = currentAstLoc;
-
-  currentAstLoc.lineno = 0;
-  currentAstLoc.filename = astr("<internal>");
+  astlocMarker markAstLoc(0, "<internal>");
 
   const char* min_name = astr(prefix, "_MIN");
   const char* max_name = astr(prefix, "_MAX");
@@ -151,8 +148,6 @@ void addMinMax(const char* prefix, int nbits, bool isSigned)
   }
   // but signed and unsigned both have a max
   lvt->addGlobalVarSymbol(max_name, minMaxConstant(nbits, isSigned, false));
-
-  currentAstLoc = prevloc;
 }
 
 static
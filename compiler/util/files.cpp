@@ -264,6 +264,17 @@ void closefile(fileinfo* thefile) {
 }
 
 
+//
+// With --incremental and --savec, generated files are written to a
+// temporary file first, and closeCFile() only replaces the saved file
+// if the contents have changed.  That way the saved files for modules
+// that didn't change keep their timestamps, and make doesn't compile
+// them again.
+//
+static bool keepUnchangedCFiles() {
+  return fIncrementalCompile && saveCDir[0];
+}
+
 void openCFile(fileinfo* fi, const char* name, const char* ext) {
   if (ext)
     fi->filename = astr(name, ".", ext);
@@ -271,7 +282,10 @@ void openCFile(fileinfo* fi, const char* name, const char* ext) {
     fi->filename = astr(name);
 
   fi->pathname = genIntermediateFilename(fi->filename);
-  fi->fptr = fopen(fi->pathname, "w");
+  if (keepUnchangedCFiles())
+    fi->fptr = fopen(astr(fi->pathname, ".tmp"), "w");
+  else
+    fi->fptr = fopen(fi->pathname, "w");
 }
 
 void appendCFile(fileinfo* fi, const char* name, const char* ext) {
@@ -284,9 +298,42 @@ void appendCFile(fileinfo* fi, const char* name, const char* ext) {
   fi->fptr     = fopen(fi->pathname, "a+");
 }
 
+static bool sameFileContents(const char* pathname1, const char* pathname2) {
+  FILE* file1 = fopen(pathname1, "r");
+  FILE* file2 = fopen(pathname2, "r");
+  bool same = (file1 != NULL && file2 != NULL);
+
+  while (same) {
+    char buf1[4096], buf2[4096];
+    size_t n1 = fread(buf1, 1, sizeof(buf1), file1);
+    size_t n2 = fread(buf2, 1, sizeof(buf2), file2);
+    if (n1 != n2 || memcmp(buf1, buf2, n1) != 0)
+      same = false;
+    else if (n1 == 0)
+      break;
+  }
+
+  if (file1)
+    fclose(file1);
+  if (file2)
+    fclose(file2);
+  return same;
+}
+
 void closeCFile(fileinfo* fi, bool beautifyIt) {
   fclose(fi->fptr);
-  if (beautifyIt && saveCDir[0])
+  if (keepUnchangedCFiles()) {
+    const char* pathname = fi->pathname;
+    fi->pathname = astr(pathname, ".tmp");
+    if (beautifyIt)
+      beautify(fi);
+    if (sameFileContents(fi->pathname, pathname))
+      remove(fi->pathname);
+    else if (rename(fi->pathname, pathname) != 0)
+      USR_FATAL("renaming %s to %s: %s",
+                fi->pathname, pathname, strerror(errno));
+    fi->pathname = pathname;
+  } else if (beautifyIt && saveCDir[0])
     beautify(fi);
 }
 
@@ -517,7 +564,9 @@ void genIncludeCommandLineHeaders(FILE* outfile) {
 }
 
 
-void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_compile_link) {
+void codegen_makefile(fileinfo* mainfile, const char** tmpbinname,
+                      bool skip_compile_link,
+                      Vec<const char*>* separateFiles) {
   fileinfo makefile;
   openCFile(&makefile, "Makefile");
   const char* tmpDirName = intDirName;
@@ -598,6 +647,17 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_com
   fprintf(makefile.fptr, "\t%s \\\n\n", mainfile->pathname);
   genCFiles(makefile.fptr);
   genObjFiles(makefile.fptr);
+  if (separateFiles && separateFiles->n) {
+    // These are compiled on their own (see the rule below) and linked
+    // along with any object files from the command line.
+    fprintf(makefile.fptr, "CHPL_GEN_OBJS = \\\n");
+    forv_Vec(const char*, cFilename, *separateFiles) {
+      fprintf(makefile.fptr, "\t%s \\\n",
+              genIntermediateFilename(astr(cFilename, ".o")));
+    }
+    fprintf(makefile.fptr, "\n");
+    fprintf(makefile.fptr, "CHPL_CL_OBJS += $(CHPL_GEN_OBJS)\n");
+  }
   fprintf(makefile.fptr, "\nLIBS =");
   for (int i=0; i<numLibFlags; i++)
     fprintf(makefile.fptr, " %s", libFlag[i]);
@@ -627,6 +687,21 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_com
   }
   fprintf(makefile.fptr, "\n");
   genCFileBuildRules(makefile.fptr);
+  if (separateFiles && separateFiles->n) {
+    //
+    // Each object depends on the header all of the generated code
+    // shares, and on the files recording the compilation command and
+    // flags, so that it is only rebuilt when one of them changes.
+    //
+    fprintf(makefile.fptr, "$(CHPL_GEN_OBJS): %%.o: %%.c %s %s %s\n",
+            genIntermediateFilename("chpl__header.h"),
+            genIntermediateFilename("chpl_compilation_config.c"),
+            makefile.pathname);
+    fprintf(makefile.fptr,
+            "\t$(CC) $(GEN_CFLAGS) $(COMP_GEN_CFLAGS) -c -o $@ "
+            "$(CHPL_RT_INC_DIR) $<\n");
+    fprintf(makefile.fptr, "\n");
+  }
   closeCFile(&makefile, false);
 }
 
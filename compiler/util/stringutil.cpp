@@ -24,63 +24,88 @@
 #include "stringutil.h"
 
 #include "misc.h"
+#include "runpasses.h"
 
 #include <algorithm>
 #include <functional>
 #include <inttypes.h>
+#include <pthread.h>
 #include <sstream>
 
 static ChainHashMap<const char*, StringHashFns, const char*> chapelStringsTable;
 
+//
+// The table is only locked while a pass is running on several threads.
+//
+static pthread_mutex_t chapelStringsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void lockStrings() {
+  if (parallelPassRunning)
+    pthread_mutex_lock(&chapelStringsLock);
+}
+
+static void unlockStrings() {
+  if (parallelPassRunning)
+    pthread_mutex_unlock(&chapelStringsLock);
+}
+
 static const char*
 canonicalize_string(const char *s) {
+  lockStrings();
   const char* ss = chapelStringsTable.get(s);
   if (!ss) {
     chapelStringsTable.put(s, s);
-    return s;
+    ss = s;
   }
+  unlockStrings();
   return ss;
 }
 
 const char*
 astr(const char* s1, const char* s2, const char* s3, const char* s4,
      const char* s5, const char* s6, const char* s7, const char* s8) {
-  int len;
-  len = strlen(s1);
-  if (s2)
-    len += strlen(s2);
-  if (s3)
-    len += strlen(s3);
-  if (s4)
-    len += strlen(s4);
-  if (s5)
-    len += strlen(s5);
-  if (s6)
-    len += strlen(s6);
-  if (s7)
-    len += strlen(s7);
-  if (s8)
-    len += strlen(s8);
-  char* s = (char*)malloc(len+1);
-  strcpy(s, s1);
-  if (s2)
-    strcat(s, s2);
-  if (s3)
-    strcat(s, s3);
-  if (s4)
-    strcat(s, s4);
-  if (s5)
-    strcat(s, s5);
-  if (s6)
-    strcat(s, s6);
-  if (s7)
-    strcat(s, s7);
-  if (s8)
-    strcat(s, s8);
-  const char* t = canonicalize_string(s);
-  if (s != t)
-    free(s);
-  return t;
+  const char* parts[] = { s1, s2, s3, s4, s5, s6, s7, s8 };
+  int         lens[8];
+  int         len   = 0;
+
+  for (int i = 0; i < 8; i++) {
+    lens[i] = (parts[i]) ? strlen(parts[i]) : 0;
+    len += lens[i];
+  }
+
+  //
+  // Most calls ask for a string that is already in the table, so
+  // build short strings on the stack and only copy them to the heap
+  // if they are new.
+  //
+  char  buf[256];
+  char* heap = (len < (int) sizeof(buf)) ? NULL : (char*)malloc(len+1);
+  char* p    = (heap) ? heap : buf;
+
+  for (int i = 0; i < 8; i++) {
+    if (parts[i]) {
+      memcpy(p, parts[i], lens[i]);
+      p += lens[i];
+    }
+  }
+  *p = '\0';
+
+  lockStrings();
+
+  if (const char* t = chapelStringsTable.get((heap) ? heap : buf)) {
+    unlockStrings();
+    free(heap);
+    return t;
+  }
+
+  if (!heap) {
+    heap = (char*)malloc(len+1);
+    memcpy(heap, buf, len+1);
+  }
+  chapelStringsTable.put(heap, heap);
+
+  unlockStrings();
+  return heap;
 }
 
 const char*
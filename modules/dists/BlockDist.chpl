@@ -995,6 +995,7 @@ proc BlockArr.dsiSerialWrite(f: Writer) {
   type strType = chpl__signedType(idxType);
   var binary = f.binary();
   if dom.dsiNumIndices == 0 then return;
+  if _isSimpleIoType(eltType) && binary && _parallelBinaryIO(f) then return;
   var i : rank*idxType;
   for dim in 1..rank do
     i(dim) = dom.dsiDim(dim).low;
@@ -1008,7 +1009,7 @@ proc BlockArr.dsiSerialWrite(f: Writer) {
         if i(dim) <= (dom.dsiDim(dim).high - dom.dsiDim(dim).stride:strType) {
           i(dim) += dom.dsiDim(dim).stride:strType;
           for dim2 in dim+1..rank {
-            f.writeln();
+            if ! binary then f.writeln();
             i(dim2) = dom.dsiDim(dim2).low;
           }
           continue next;
@@ -1019,6 +1020,107 @@ proc BlockArr.dsiSerialWrite(f: Writer) {
   }
 }
 
+//
+// input array
+//
+proc BlockArr.dsiSerialRead(f: Reader) {
+  if dom.dsiNumIndices == 0 then return;
+  if _isSimpleIoType(eltType) && f.binary() && _parallelBinaryIO(f) then
+    return;
+  for i in dom.whole do
+    f <~> dsiAccess(i);
+}
+
+//
+// Read or write the array in binary, with each locale transferring
+// its own elements directly to or from the file in parallel. Returns
+// false (without having done any I/O) if f doesn't support that or if
+// the elements can't be moved as raw bytes; the caller then does the
+// I/O itself.
+//
+proc BlockArr._parallelBinaryIO(f): bool {
+  pragma "no prototype"
+  extern proc sizeof(type x): size_t;
+
+  param writing = f.writing;
+  const swapSize = _bulkIOSwapSize(f, eltType);
+  if swapSize < 0 then return false;
+
+  const rowsOK = && reduce [i in dom.dist.targetLocDom]
+                    locArr[i].myElems._value._rowsAreContiguous();
+  if !rowsOK then return false;
+
+  const elemSize = sizeof(eltType):int(64);
+  const len = dom.dsiNumIndices:int(64) * elemSize;
+  var base: int(64);
+  var path: string;
+  if !f._directStart(len, base, path) then return false;
+
+  // Each locale opens the file for itself. If any of them can't,
+  // leave the channel where it was and let the caller do the I/O.
+  var files: [dom.dist.targetLocDom] qio_file_ptr_t;
+  var errs: [dom.dist.targetLocDom] syserr;
+  coforall i in dom.dist.targetLocDom do on dom.dist.targetLocales(i) {
+    var err: syserr;
+    files[i] = _directFileOpen(path, writing, err);
+    errs[i] = err;
+  }
+  if || reduce [e in errs] (e != ENOERR) {
+    coforall i in dom.dist.targetLocDom do on dom.dist.targetLocales(i) {
+      if !is_c_nil(files[i]) then qio_file_release(files[i]);
+    }
+    f._directEnd(0);
+    return false;
+  }
+
+  // The file holds the elements in row-major order.
+  const whole = dom.whole;
+  var wholeBlk: rank*int(64);
+  wholeBlk(rank) = 1;
+  for param dim in 1..rank-1 by -1 do
+    wholeBlk(dim) = wholeBlk(dim+1) * whole.dim(dim+1).length;
+
+  coforall i in dom.dist.targetLocDom do on dom.dist.targetLocales(i) {
+    const myArr = locArr[i].myElems._value;
+    const file = files[i];
+    var err: syserr = ENOERR;
+
+    // Rows that are adjacent in the file can be coalesced when this
+    // locale has all of the later dimensions.
+    var coalesce = true;
+    for param dim in 2..rank do
+      if myArr.dom.dsiDim(dim) != whole.dim(dim) then coalesce = false;
+
+    for (start, count, first) in myArr._contiguousRuns(coalesce) {
+      if err then break;
+      var pos = 0:int(64);
+      for param dim in 1..rank do
+        pos += ((first(dim) - whole.dim(dim).alignedLow) /
+                abs(whole.dim(dim).stride):idxType):int(64) * wholeBlk(dim);
+      const ptr = _ddata_shift(eltType, myArr.theData, start);
+      if writing then
+        err = qio_file_pwrite_amt(file, ptr, count:int(64)*elemSize,
+                                  base + pos*elemSize, swapSize);
+      else
+        err = qio_file_pread_amt(file, ptr, count:int(64)*elemSize,
+                                 base + pos*elemSize, swapSize);
+    }
+
+    qio_file_release(file);
+    errs[i] = err;
+  }
+
+  f._directEnd(len);
+  for e in errs {
+    if e {
+      f.setError(e);
+      break;
+    }
+  }
+
+  return true;
+}
+
 proc BlockArr.dsiSlice(d: BlockDom) {
   var alias = new BlockArr(eltType=eltType, rank=rank, idxType=idxType, stridable=d.stridable, dom=d);
   var thisid = this.locale.id;
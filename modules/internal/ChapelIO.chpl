@@ -47,6 +47,17 @@ module ChapelIO {
     proc writeBytes(x, len:ssize_t) {
       halt("Generic Writer.writeBytes called");
     }
+    // like writeBytes, but reverses the bytes of each swapSize-byte
+    // element on the way out when swapSize > 1.
+    proc writeBulk(x, len:ssize_t, swapSize:ssize_t) {
+      halt("Generic Writer.writeBulk called");
+    }
+    // Distributed arrays use these to write their parts of the next
+    // len bytes directly to the file, in parallel. See ChannelWriter.
+    proc _directStart(len:int(64), out offset:int(64), out path:string):bool {
+      return false;
+    }
+    proc _directEnd(len:int(64)) { }
     proc writeIt(x:?t) {
       if _isIoPrimitiveTypeOrNewline(t) {
         writePrimitive(x);
@@ -217,6 +228,16 @@ module ChapelIO {
     proc readBytes(x, len:ssize_t) {
       halt("Generic Reader.readBytes called");
     }
+    // like readBytes, but reverses the bytes of each swapSize-byte
+    // element after reading when swapSize > 1.
+    proc readBulk(x, len:ssize_t, swapSize:ssize_t) {
+      halt("Generic Reader.readBulk called");
+    }
+    // See Writer._directStart
+    proc _directStart(len:int(64), out offset:int(64), out path:string):bool {
+      return false;
+    }
+    proc _directEnd(len:int(64)) { }
     proc readIt(x:?t) where isClassType(t) {
       // FUTURE -- write the class name/ID? or nil?
       // possibly in a different 'Reader'
@@ -612,6 +612,38 @@ module DefaultRectangular {
     }
   }
   
+  //
+  // Storage that a DefaultRectangularArr uses but did not allocate,
+  // such as a mapped file (see chpl__buildArrayOverData). Subclasses
+  // override release(), which is called instead of freeing the data
+  // when the array is destroyed.
+  //
+  class DefaultRectangularExternStorage {
+    proc release() { }
+  }
+
+  //
+  // Build an array over the default rectangular domain D that uses
+  // data as its storage, with the elements in the same order as in an
+  // array that allocated its own.
+  //
+  proc chpl__buildArrayOverData(D: domain, type eltType, data: c_void_ptr,
+                                storage: DefaultRectangularExternStorage) {
+    var x = new DefaultRectangularArr(eltType=eltType, rank=D.rank,
+                                      idxType=D.idxType,
+                                      stridable=D.stridable,
+                                      dom=D._value, noinit_data=true);
+    x.setExternData(data, storage);
+    pragma "dont disable remote value forwarding"
+    proc help() {
+      D._value.add_arr(x);
+      if !noRefCount then
+        D._value.incRefCount();
+    }
+    help();
+    return _newArray(x);
+  }
+
   class DefaultRectangularArr: BaseArr {
     type eltType;
     param rank : int;
@@ -630,6 +662,8 @@ module DefaultRectangular {
     pragma "local field"
     var shiftedData : _ddata(eltType);
     var noinit_data: bool = false;
+    // non-nil when data was not allocated by this array
+    var externStorage: DefaultRectangularExternStorage;
     //var numelm: int = -1; // for correctness checking
   
     // end class definition here, then defined secondary methods below
@@ -647,6 +681,12 @@ module DefaultRectangular {
     proc dsiGetBaseDom() return dom;
   
     proc dsiDestroyData() {
+      if externStorage != nil {
+        externStorage.release();
+        delete externStorage;
+        externStorage = nil;
+        return;
+      }
       if dom.dsiNumIndices > 0 {
         pragma "no copy" pragma "no auto destroy" var dr = data;
         pragma "no copy" pragma "no auto destroy" var dv = __primitive("deref", dr);
@@ -785,6 +825,14 @@ module DefaultRectangular {
     // we want to get rid of all initialize functions everywhere
     proc initialize() {
       if noinit_data == true then return;
+      var size = computeLayout();
+      data = _ddata_allocate(eltType, size);
+      initShiftedData();
+    }
+
+    // Set up off, str, blk and factoredOffs for dom and return the
+    // number of elements to store.
+    proc computeLayout() {
       for param dim in 1..rank {
         off(dim) = dom.dsiDim(dim).alignedLow;
         str(dim) = dom.dsiDim(dim).stride;
@@ -793,8 +841,16 @@ module DefaultRectangular {
       for param dim in 1..(rank-1) by -1 do
         blk(dim) = blk(dim+1) * dom.dsiDim(dim+1).length;
       computeFactoredOffs();
-      var size = blk(1) * dom.dsiDim(1).length;
-      data = _ddata_allocate(eltType, size);
+      return blk(1) * dom.dsiDim(1).length;
+    }
+
+    // Use ptr as the data for this array instead of allocating it.
+    // storage.release() is called when the array is destroyed.
+    proc setExternData(ptr: c_void_ptr,
+                       storage: DefaultRectangularExternStorage) {
+      computeLayout();
+      data = __primitive("cast", _ddata(eltType), ptr);
+      externStorage = storage;
       initShiftedData();
     }
   
@@ -1068,47 +1124,128 @@ module DefaultRectangular {
     recursiveArrayWriter(zeroTup);
   }
 
+  // If arrays of eltType can be read or written with f as raw bytes,
+  // return the swapSize to pass to readBulk/writeBulk (0 when f uses
+  // the native byte order); otherwise, return -1.
+  proc _bulkIOSwapSize(f, type eltType): int {
+    pragma "no prototype"
+    extern proc sizeof(type x): size_t;
+
+    if _isSimpleIoType(eltType) {
+      if !f.binary() then return -1;
+      if f.styleElement(QIO_STYLE_ELEMENT_IS_NATIVE_BYTE_ORDER) != 0 then
+        return 0;
+      // Otherwise, the bytes of each number need to be reversed.
+      if isIntegralType(eltType) || isRealType(eltType) || isImagType(eltType) then
+        return sizeof(eltType):int;
+      if isComplexType(eltType) then
+        return sizeof(eltType):int / 2;
+    }
+    return -1;
+  }
+
   proc DefaultRectangularArr.dsiSerialWrite(f: Writer) {
-    var isNative = f.styleElement(QIO_STYLE_ELEMENT_IS_NATIVE_BYTE_ORDER): bool;
+    const swapSize = _bulkIOSwapSize(f, eltType);
 
-    if _isSimpleIoType(this.eltType) && f.binary() &&
-       isNative && this.isDataContiguous() {
-      // If we can, we would like to write the array out as a single write op
-      // since _ddata is just a pointer to the memory location we just pass
-      // that along with the size of the array. This is only possible when the
-      // byte order is set to native or it's equivalent.
+    if _isSimpleIoType(eltType) && swapSize >= 0 &&
+       this._rowsAreContiguous() {
+      // If we can, we would like to write the array out with a single
+      // write op (or one per row, for strided arrays) since _ddata is
+      // just a pointer to the memory location; we just pass that along
+      // with the size of each run of elements.
       pragma "no prototype"
       extern proc sizeof(type x): size_t;
       const elemSize = sizeof(eltType);
-      const len = dom.dsiNumIndices;
       if boundsChecking then
-        assert((len:uint*elemSize:uint) <= max(ssize_t):uint,
+        assert((dom.dsiNumIndices:uint*elemSize:uint) <= max(ssize_t):uint,
                "length of array to write is greater than ssize_t can hold");
-      f.writeBytes(data, len:ssize_t*elemSize:ssize_t);
+      for (start, count, first) in this._contiguousRuns() do
+        f.writeBulk(_ddata_shift(eltType, theData, start),
+                    count:ssize_t*elemSize:ssize_t, swapSize);
     } else {
       this.dsiSerialReadWrite(f);
     }
   }
 
   proc DefaultRectangularArr.dsiSerialRead(f: Reader) {
-    var isNative = f.styleElement(QIO_STYLE_ELEMENT_IS_NATIVE_BYTE_ORDER): bool;
+    const swapSize = _bulkIOSwapSize(f, eltType);
 
-    if _isSimpleIoType(this.eltType) && f.binary() &&
-       isNative && this.isDataContiguous() {
-      // read the data in one op if possible, same comments as above apply
+    if _isSimpleIoType(eltType) && swapSize >= 0 &&
+       this._rowsAreContiguous() {
+      // read the data in as few ops as possible, same comments as above apply
       pragma "no prototype"
       extern proc sizeof(type x): size_t;
       const elemSize = sizeof(eltType);
-      const len = dom.dsiNumIndices;
       if boundsChecking then
-        assert((len:uint*elemSize:uint) <= max(ssize_t):uint,
+        assert((dom.dsiNumIndices:uint*elemSize:uint) <= max(ssize_t):uint,
                "length of array to read is greater than ssize_t can hold");
-      f.readBytes(data, len:ssize_t*elemSize:ssize_t);
+      for (start, count, first) in this._contiguousRuns() do
+        f.readBulk(_ddata_shift(eltType, theData, start),
+                   count:ssize_t*elemSize:ssize_t, swapSize);
     } else {
       this.dsiSerialReadWrite(f);
     }
   }
 
+  // Are the elements of each row (that is, along the last dimension)
+  // adjacent in memory? This is the same for every row, so just check
+  // the first one.
+  proc DefaultRectangularArr._rowsAreContiguous(): bool {
+    const rowLen = dom.dsiDim(rank).length;
+    if rowLen <= 1 then return true;
+    var first, last: rank*idxType;
+    for param dim in 1..rank do
+      first(dim) = dom.dsiDim(dim).alignedLow;
+    last = first;
+    last(rank) = dom.dsiDim(rank).alignedHigh;
+    return getDataIndex(last) - getDataIndex(first) == (rowLen-1):idxType;
+  }
+
+  // Yield (data index, number of elements, first index) for each run
+  // of elements that are adjacent in memory, in the order that the
+  // elements are read and written (row-major, with each dimension
+  // going from low to high). Requires _rowsAreContiguous(). If coalesce
+  // is false, each run is a single row.
+  iter DefaultRectangularArr._contiguousRuns(coalesce = true) {
+    if dom.dsiNumIndices == 0 then return;
+
+    const rowLen = dom.dsiDim(rank).length;
+    var idx: rank*idxType;
+    for param dim in 1..rank do
+      idx(dim) = dom.dsiDim(dim).alignedLow;
+
+    var runStart = getDataIndex(idx);
+    var runLen = 0;
+    var runFirst = idx;
+
+    while true {
+      const rowStart = getDataIndex(idx);
+      if coalesce && runLen > 0 && rowStart == runStart + runLen:idxType {
+        runLen += rowLen;
+      } else {
+        if runLen > 0 then yield (runStart, runLen, runFirst);
+        runStart = rowStart;
+        runLen = rowLen;
+        runFirst = idx;
+      }
+
+      // move on to the next row
+      var dim = rank - 1;
+      while dim >= 1 {
+        if idx(dim) < dom.dsiDim(dim).alignedHigh {
+          idx(dim) += abs(dom.dsiDim(dim).stride):idxType;
+          for dim2 in dim+1..rank-1 do
+            idx(dim2) = dom.dsiDim(dim2).alignedLow;
+          break;
+        }
+        dim -= 1;
+      }
+      if dim < 1 then break;
+    }
+
+    yield (runStart, runLen, runFirst);
+  }
+
   // This is very conservative.  For example, it will return false for
   // 1-d array aliases that are shifted from the aliased array.
   proc DefaultRectangularArr.isDataContiguous() {
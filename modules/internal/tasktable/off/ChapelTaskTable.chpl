@@ -57,4 +57,9 @@ module ChapelTaskTable {
   {
     halt("To use task tracking, you must recompile with --task-tracking");
   }
+
+  export proc chpldev_taskTable_num_shards() : int(32)
+  {
+    return 1;
+  }
 }
@@ -58,10 +58,32 @@ module ChapelTaskTable {
     var tl_info   : uint(64);
   }
   
-  class chpldev_taskTable_t {
+  //
+  // The table is split into shards by task ID.  The tasking layer
+  // serializes operations on each shard with a lock of its own, so
+  // tasks whose IDs fall in different shards can update the table at
+  // the same time.
+  //
+  param chpldev_taskTable_numShards = 64;
+
+  class chpldev_taskTableShard_t {
     var dom : domain(chpl_taskID_t, parSafe=false);
     var map : [dom] chpldev_Task;
   }
+
+  class chpldev_taskTable_t {
+    var shards : [0..#chpldev_taskTable_numShards] chpldev_taskTableShard_t;
+
+    proc initShards() {
+      for s in shards do
+        s = new chpldev_taskTableShard_t();
+    }
+
+    inline proc shard(taskID : chpl_taskID_t) {
+      const id = taskID:uint(64);
+      return shards[(id % chpldev_taskTable_numShards:uint(64)):int];
+    }
+  }
   
   pragma "private"
   var chpldev_taskTable : chpldev_taskTable_t;
@@ -75,6 +97,7 @@ module ChapelTaskTable {
     // internal modules are already initialized)
     coforall loc in Locales with (ref chpldev_taskTable) do on loc {
       chpldev_taskTable = new chpldev_taskTable_t();
+      chpldev_taskTable.initShards();
     }
   }
 
@@ -103,63 +126,84 @@ module ChapelTaskTable {
                                     tl_info  : uint(64))
   {
     if (chpldev_taskTable == nil) then return;
-  
-    if (!chpldev_taskTable.dom.member(taskID)) then
+
+    const s = chpldev_taskTable.shard(taskID);
+
+    if (!s.dom.member(taskID)) then
       // This must be serial, because if add() results in parallelism
       // (due to _resize), it may lead to deadlock (due to reentry
       // into the runtime tasking layer for task table operations).
       serial true do
-        chpldev_taskTable.dom.add(taskID);
+        s.dom.add(taskID);
   
-    chpldev_taskTable.map[taskID] = new chpldev_Task(taskState.pending,
-                                                 lineno, filename, tl_info);
+    s.map[taskID] = new chpldev_Task(taskState.pending,
+                                     lineno, filename, tl_info);
   }
   
   export proc chpldev_taskTable_remove(taskID : chpl_taskID_t)
   {
-    if (chpldev_taskTable == nil ||
-        !chpldev_taskTable.dom.member(taskID)) then return;
+    if (chpldev_taskTable == nil) then return;
+
+    const s = chpldev_taskTable.shard(taskID);
+
+    if (!s.dom.member(taskID)) then return;
   
     // This must be serial, because if remove() results in parallelism
     // (due to _resize), it may lead to deadlock (due to reentry into
     // the runtime tasking layer for task table operations).
     serial true do
-      chpldev_taskTable.dom.remove(taskID);
+      s.dom.remove(taskID);
   }
   
   export proc chpldev_taskTable_set_active(taskID : chpl_taskID_t)
   {
-    if (chpldev_taskTable == nil ||
-        !chpldev_taskTable.dom.member(taskID)) then return;
+    if (chpldev_taskTable == nil) then return;
+
+    const s = chpldev_taskTable.shard(taskID);
+
+    if (!s.dom.member(taskID)) then return;
   
-    chpldev_taskTable.map[taskID].state = taskState.active;
+    s.map[taskID].state = taskState.active;
   }
   
   export proc chpldev_taskTable_set_suspended(taskID : chpl_taskID_t)
   {
-    if (chpldev_taskTable == nil ||
-        !chpldev_taskTable.dom.member(taskID)) then return;
+    if (chpldev_taskTable == nil) then return;
+
+    const s = chpldev_taskTable.shard(taskID);
+
+    if (!s.dom.member(taskID)) then return;
   
-    chpldev_taskTable.map[taskID].state = taskState.suspended;
+    s.map[taskID].state = taskState.suspended;
   }
   
   export proc chpldev_taskTable_get_tl_info(taskID : chpl_taskID_t)
   {
-    if (chpldev_taskTable == nil ||
-        !chpldev_taskTable.dom.member(taskID)) then return 0:uint(64);
+    if (chpldev_taskTable == nil) then return 0:uint(64);
+
+    const s = chpldev_taskTable.shard(taskID);
+
+    if (!s.dom.member(taskID)) then return 0:uint(64);
   
-    return chpldev_taskTable.map[taskID].tl_info;
+    return s.map[taskID].tl_info;
   }
   
   export proc chpldev_taskTable_print() 
   {
     if (chpldev_taskTable == nil) then return;
   
-    for taskID in chpldev_taskTable.dom {
-      stderr.writeln("- ", chpldev_taskTable.map[taskID].filename,
-                     ":",  chpldev_taskTable.map[taskID].lineno,
-                     " is ", chpldev_taskTable.map[taskID].state);
+    for s in chpldev_taskTable.shards {
+      for taskID in s.dom {
+        stderr.writeln("- ", s.map[taskID].filename,
+                       ":",  s.map[taskID].lineno,
+                       " is ", s.map[taskID].state);
+      }
     }
   }
+
+  export proc chpldev_taskTable_num_shards() : int(32)
+  {
+    return chpldev_taskTable_numShards:int(32);
+  }
   
 }
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+  This module provides aggregation of small remote atomic updates.
+  Programs that make many small, independent updates to data on other
+  locales (histograms, scatters, graph traversals) can spend most of
+  their time waiting for one message per update.  An
+  :class:`Aggregator` instead collects the updates bound for each
+  locale in a buffer and sends the whole buffer as one message, which
+  the other locale runs in bulk.
+
+  For example, this counts keys into a distributed histogram with one
+  aggregator per locale::
+
+    use Aggregation;
+
+    coforall loc in Locales do on loc {
+      var agg = new Aggregator();
+      for key in myKeys do
+        agg.add(histogram[key % numBins], 1);
+      delete agg;   // waits until all of the updates have been done
+    }
+
+  Updates are not done in program order: an update may not have
+  happened until :proc:`Aggregator.flush` is called or the aggregator
+  is deleted.  Updates to the calling locale's memory are done right
+  away.
+
+  A buffer is sent when it is full, when the oldest update in it has
+  waited longer than a timeout, or when the aggregator is flushed.
+  Both limits are runtime settings, read from the environment when the
+  program starts:
+
+    ``CHPL_RT_COMM_AGG_BUFFER_SIZE``
+      the size in bytes of each locale's buffer (default 8192; it is
+      limited by the largest message the communication layer can send)
+
+    ``CHPL_RT_COMM_AGG_TIMEOUT``
+      the number of microseconds an update may wait in a buffer before
+      it is sent (default 1000; 0 means buffers are only sent when they
+      are full or flushed)
+
+  The timeout is only checked when updates are added, so a task that
+  stops adding updates must flush (or delete) its aggregator.
+
+  Counts of aggregated updates and the messages used for them are kept
+  while communication diagnostics are on; see
+  :proc:`CommDiagnostics.getAggregationDiagnostics`.
+
+  When the network does the atomic operations itself
+  (``CHPL_NETWORK_ATOMICS`` is not ``none``), an aggregator simply does
+  each update right away.
+ */
+module Aggregation {
+
+  pragma "no doc"
+  extern proc chpl_comm_agg_create(): c_void_ptr;
+
+  pragma "no doc"
+  extern proc chpl_comm_agg_destroy(agg: c_void_ptr);
+
+  pragma "no doc"
+  extern proc chpl_comm_agg_atomic(agg: c_void_ptr, node: int(32),
+                                   op: int(32), raddr: uint(64),
+                                   operand: uint(64));
+
+  pragma "no doc"
+  extern proc chpl_comm_agg_flush(agg: c_void_ptr);
+
+  pragma "no doc" extern const CHPL_COMM_AGG_ADD_64: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_OR_64: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_AND_64: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_XOR_64: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_WRITE_64: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_ADD_32: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_OR_32: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_AND_32: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_XOR_32: int(32);
+  pragma "no doc" extern const CHPL_COMM_AGG_WRITE_32: int(32);
+
+  /*
+    Collects remote atomic updates and sends them in bulk.
+
+    An aggregator may only be used by one task at a time, on the locale
+    where it was created.
+   */
+  class Aggregator {
+    pragma "no doc"
+    var _agg: c_void_ptr = chpl_comm_agg_create();
+
+    pragma "no doc"
+    proc ~Aggregator() {
+      chpl_comm_agg_destroy(_agg);
+    }
+
+    /*
+      Send all of the buffered updates and wait until they have been
+      done.
+     */
+    proc flush() {
+      _checkHere();
+      chpl_comm_agg_flush(_agg);
+    }
+
+    /* Add `value` to `x`. */
+    inline proc add(ref x: atomic int(64), value: int(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.add(value);
+      else _update(x, CHPL_COMM_AGG_ADD_64, value:uint(64));
+    }
+
+    /* Subtract `value` from `x`. */
+    inline proc sub(ref x: atomic int(64), value: int(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.sub(value);
+      else _update(x, CHPL_COMM_AGG_ADD_64, 0:uint(64) - value:uint(64));
+    }
+
+    /* Bitwise or `value` into `x`. */
+    inline proc or(ref x: atomic int(64), value: int(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.or(value);
+      else _update(x, CHPL_COMM_AGG_OR_64, value:uint(64));
+    }
+
+    /* Bitwise and `value` into `x`. */
+    inline proc and(ref x: atomic int(64), value: int(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.and(value);
+      else _update(x, CHPL_COMM_AGG_AND_64, value:uint(64));
+    }
+
+    /* Bitwise xor `value` into `x`. */
+    inline proc xor(ref x: atomic int(64), value: int(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.xor(value);
+      else _update(x, CHPL_COMM_AGG_XOR_64, value:uint(64));
+    }
+
+    /* Store `value` in `x`. */
+    inline proc write(ref x: atomic int(64), value: int(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.write(value);
+      else _update(x, CHPL_COMM_AGG_WRITE_64, value:uint(64));
+    }
+
+    pragma "no doc"
+    inline proc add(ref x: atomic uint(64), value: uint(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.add(value);
+      else _update(x, CHPL_COMM_AGG_ADD_64, value);
+    }
+
+    pragma "no doc"
+    inline proc sub(ref x: atomic uint(64), value: uint(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.sub(value);
+      else _update(x, CHPL_COMM_AGG_ADD_64, 0:uint(64) - value);
+    }
+
+    pragma "no doc"
+    inline proc or(ref x: atomic uint(64), value: uint(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.or(value);
+      else _update(x, CHPL_COMM_AGG_OR_64, value);
+    }
+
+    pragma "no doc"
+    inline proc and(ref x: atomic uint(64), value: uint(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.and(value);
+      else _update(x, CHPL_COMM_AGG_AND_64, value);
+    }
+
+    pragma "no doc"
+    inline proc xor(ref x: atomic uint(64), value: uint(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.xor(value);
+      else _update(x, CHPL_COMM_AGG_XOR_64, value);
+    }
+
+    pragma "no doc"
+    inline proc write(ref x: atomic uint(64), value: uint(64)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.write(value);
+      else _update(x, CHPL_COMM_AGG_WRITE_64, value);
+    }
+
+    pragma "no doc"
+    inline proc add(ref x: atomic int(32), value: int(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.add(value);
+      else _update(x, CHPL_COMM_AGG_ADD_32, value:uint(32):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc sub(ref x: atomic int(32), value: int(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.sub(value);
+      else _update(x, CHPL_COMM_AGG_ADD_32,
+                   (0:uint(32) - value:uint(32)):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc or(ref x: atomic int(32), value: int(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.or(value);
+      else _update(x, CHPL_COMM_AGG_OR_32, value:uint(32):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc and(ref x: atomic int(32), value: int(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.and(value);
+      else _update(x, CHPL_COMM_AGG_AND_32, value:uint(32):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc xor(ref x: atomic int(32), value: int(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.xor(value);
+      else _update(x, CHPL_COMM_AGG_XOR_32, value:uint(32):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc write(ref x: atomic int(32), value: int(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.write(value);
+      else _update(x, CHPL_COMM_AGG_WRITE_32, value:uint(32):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc add(ref x: atomic uint(32), value: uint(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.add(value);
+      else _update(x, CHPL_COMM_AGG_ADD_32, value:uint(64));
+    }
+
+    pragma "no doc"
+    inline proc sub(ref x: atomic uint(32), value: uint(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.sub(value);
+      else _update(x, CHPL_COMM_AGG_ADD_32, (0:uint(32) - value):uint(64));
+    }
+
+    pragma "no doc"
+    inline proc or(ref x: atomic uint(32), value: uint(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.or(value);
+      else _update(x, CHPL_COMM_AGG_OR_32, value:uint(64));
+    }
+
+    pragma "no doc"
+    inline proc and(ref x: atomic uint(32), value: uint(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.and(value);
+      else _update(x, CHPL_COMM_AGG_AND_32, value:uint(64));
+    }
+
+    pragma "no doc"
+    inline proc xor(ref x: atomic uint(32), value: uint(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.xor(value);
+      else _update(x, CHPL_COMM_AGG_XOR_32, value:uint(64));
+    }
+
+    pragma "no doc"
+    inline proc write(ref x: atomic uint(32), value: uint(32)) {
+      if CHPL_NETWORK_ATOMICS != "none" then x.write(value);
+      else _update(x, CHPL_COMM_AGG_WRITE_32, value:uint(64));
+    }
+
+    // The runtime updates the atomic's value in place, which is the
+    // first (and only) field of the atomic record.
+    pragma "no doc"
+    inline proc _update(ref x, op: int(32), operand: uint(64)) {
+      _checkHere();
+      const node = __primitive("_wide_get_node", x);
+      const addr = __primitive("_wide_get_addr", x);
+      chpl_comm_agg_atomic(_agg, node:int(32), op, addr:uint(64), operand);
+    }
+
+    pragma "no doc"
+    inline proc _checkHere() {
+      if boundsChecking && this.locale != here then
+        halt("an Aggregator can only be used on the locale that created it");
+    }
+  }
+}
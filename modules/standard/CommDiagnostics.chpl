@@ -138,6 +138,22 @@
   was executed on locale 0, and a remote get and a remote put were
   executed on locale 1.
 
+  **Remote Data Cache Counts**
+
+  When a program is compiled with ``--cache-remote``, the remote data
+  cache keeps some counts of its own while counting is turned on.
+  These are reset along with the communication counts, and retrieved
+  with :proc:`getCacheDiagnostics` or :proc:`getCacheDiagnosticsHere`.
+  They are always zero for programs that do not use the cache.
+
+  **Aggregation Counts**
+
+  Aggregators from the :mod:`Aggregation` module also keep counts while
+  counting is turned on.  These are reset along with the communication
+  counts, and retrieved with :proc:`getAggregationDiagnostics` or
+  :proc:`getAggregationDiagnosticsHere`.  The messages an aggregator
+  sends are not included in the communication counts.
+
   **Studying Communication During Module Initialization**
 
   It is hard for a programmer to determine exactly what happens during
@@ -321,6 +337,8 @@ module CommDiagnostics
    */
   inline proc resetCommDiagnosticsHere() {
     chpl_resetCommDiagnosticsHere();
+    chpl_resetCacheDiagnosticsHere();
+    chpl_resetCommAggDiagnosticsHere();
   }
 
   // See note above regarding extern records
@@ -354,6 +372,63 @@ module CommDiagnostics
   pragma "no doc"
   extern proc chpl_numCommNBForks(): uint(64);
 
+  pragma "no doc"
+  extern proc chpl_resetCacheDiagnosticsHere();
+
+  pragma "no doc"
+  extern proc chpl_numCacheHits(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheMisses(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheReadaheadHits(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheReadaheadUnused(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheAinEvicts(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheAoutEvicts(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheAmEvicts(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheDirtyFlushes(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheCombinedPuts(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheCombinedFlushes(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCacheFenceWaits(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_resetCommAggDiagnosticsHere();
+
+  pragma "no doc"
+  extern proc chpl_numCommAggOps(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCommAggLocalOps(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCommAggMsgs(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCommAggFullSends(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCommAggTimeoutSends(): uint(64);
+
+  pragma "no doc"
+  extern proc chpl_numCommAggFlushes(): uint(64);
+
   /*
     Retrieve aggregate communication counts for the whole program.
 
@@ -399,6 +474,157 @@ module CommDiagnostics
     return cd;
   }
 
+  /*
+    Counts kept by the remote data cache.
+   */
+  record cacheDiagnostics {
+    /*
+      cache pages read by a GET without communication
+     */
+    var hit: uint(64);
+    /*
+      cache pages that a GET had to fetch
+     */
+    var miss: uint(64);
+    /*
+      prefetched cache lines that were later used by a GET
+     */
+    var readahead_hit: uint(64);
+    /*
+      prefetched cache lines that were evicted or invalidated
+      without being used
+     */
+    var readahead_unused: uint(64);
+    /*
+      pages moved out of the cache's first-access queue (Ain)
+     */
+    var ain_evict: uint(64);
+    /*
+      evicted pages that the cache stopped remembering (Aout)
+     */
+    var aout_evict: uint(64);
+    /*
+      pages evicted from the cache's frequently-used queue (Am)
+     */
+    var am_evict: uint(64);
+    /*
+      regions of dirty cached data written back
+     */
+    var dirty_flush: uint(64);
+    /*
+      regions of dirty cached data that were combined with others
+      into a single message
+     */
+    var combined_put: uint(64);
+    /*
+      messages of combined PUTs sent
+     */
+    var combined_flush: uint(64);
+    /*
+      release fences that had to wait for pending GETs or PUTs
+     */
+    var fence_wait: uint(64);
+  };
+
+  /*
+    Retrieve remote data cache counts for the whole program.
+
+    :returns: array of cache counts for each locale
+    :rtype: `[LocaleSpace] cacheDiagnostics`
+   */
+  proc getCacheDiagnostics() {
+    var D: [LocaleSpace] cacheDiagnostics;
+    for loc in Locales do on loc {
+      D(loc.id) = getCacheDiagnosticsHere();
+    }
+    return D;
+  }
+
+  /*
+    Retrieve remote data cache counts for this locale.
+
+    :returns: cache counts for this locale
+    :rtype: `cacheDiagnostics`
+   */
+  proc getCacheDiagnosticsHere() {
+    var cd: cacheDiagnostics;
+    cd.hit = chpl_numCacheHits();
+    cd.miss = chpl_numCacheMisses();
+    cd.readahead_hit = chpl_numCacheReadaheadHits();
+    cd.readahead_unused = chpl_numCacheReadaheadUnused();
+    cd.ain_evict = chpl_numCacheAinEvicts();
+    cd.aout_evict = chpl_numCacheAoutEvicts();
+    cd.am_evict = chpl_numCacheAmEvicts();
+    cd.dirty_flush = chpl_numCacheDirtyFlushes();
+    cd.combined_put = chpl_numCacheCombinedPuts();
+    cd.combined_flush = chpl_numCacheCombinedFlushes();
+    cd.fence_wait = chpl_numCacheFenceWaits();
+    return cd;
+  }
+
+  /*
+    Counts kept by aggregators.
+   */
+  record aggregationDiagnostics {
+    /*
+      operations added to an aggregator for another locale
+     */
+    var op: uint(64);
+    /*
+      operations added to an aggregator for this locale, which were
+      done right away
+     */
+    var local_op: uint(64);
+    /*
+      messages of aggregated operations sent
+     */
+    var msg: uint(64);
+    /*
+      messages sent because the buffer was full
+     */
+    var full_send: uint(64);
+    /*
+      messages sent because the oldest operation in the buffer had
+      waited too long
+     */
+    var timeout_send: uint(64);
+    /*
+      aggregator flushes
+     */
+    var flush: uint(64);
+  };
+
+  /*
+    Retrieve aggregation counts for the whole program.
+
+    :returns: array of aggregation counts for each locale
+    :rtype: `[LocaleSpace] aggregationDiagnostics`
+   */
+  proc getAggregationDiagnostics() {
+    var D: [LocaleSpace] aggregationDiagnostics;
+    for loc in Locales do on loc {
+      D(loc.id) = getAggregationDiagnosticsHere();
+    }
+    return D;
+  }
+
+  /*
+    Retrieve aggregation counts for this locale.
+
+    :returns: aggregation counts for this locale
+    :rtype: `aggregationDiagnostics`
+   */
+  proc getAggregationDiagnosticsHere() {
+    var ad: aggregationDiagnostics;
+    ad.op = chpl_numCommAggOps();
+    ad.local_op = chpl_numCommAggLocalOps();
+    ad.msg = chpl_numCommAggMsgs();
+    ad.full_send = chpl_numCommAggFullSends();
+    ad.timeout_send = chpl_numCommAggTimeoutSends();
+    ad.flush = chpl_numCommAggFlushes();
+    return ad;
+  }
+
   /*
     If this is set, on-the-fly reporting of communication operations
     will be turned on before any module initialization begins and
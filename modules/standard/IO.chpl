@@ -1355,6 +1355,8 @@ extern const QIO_METHOD_FREADFWRITE:c_int;
 pragma "no doc"
 extern const QIO_METHOD_MMAP:c_int;
 pragma "no doc"
+extern const QIO_METHOD_URING:c_int;
+pragma "no doc"
 extern const QIO_METHODMASK:c_int;
 pragma "no doc"
 extern const QIO_HINT_RANDOM:c_int;
@@ -1400,6 +1402,23 @@ const IOHINT_CACHED = QIO_HINT_CACHED;
  */
 const IOHINT_PARALLEL = QIO_HINT_PARALLEL;
 
+/*  IOHINT_URING requests that reads and writes be submitted as
+    batches of asynchronous requests with Linux io_uring. Buffered
+    channels keep several requests in flight at once and let other
+    tasks run while waiting for them. Where io_uring is not
+    available, pread and pwrite are used instead.
+ */
+const IOHINT_URING = QIO_METHOD_URING;
+
+/*  IOHINT_DIRECT requests that file data bypass the operating
+    system's page cache (O_DIRECT). Channels can still read and
+    write at any position; parts of a request that are not aligned
+    to the file system block size, such as the end of a file, go
+    through the page cache. On file systems that don't support it,
+    or that are memory-backed, this hint has no effect.
+ */
+const IOHINT_DIRECT = QIO_HINT_DIRECT;
+
 pragma "no doc"
 extern type qio_file_ptr_t;
 pragma "no doc"
@@ -1579,6 +1598,14 @@ pragma "no doc"
 extern proc qio_file_get_style(f:qio_file_ptr_t, ref style:iostyle);
 pragma "no doc"
 extern proc qio_file_length(f:qio_file_ptr_t, ref len:int(64)):syserr;
+pragma "no doc"
+extern proc qio_file_find_record_start(f:qio_file_ptr_t, start:int(64), end:int(64), delim:int(32), ref pos:int(64)):syserr;
+pragma "no doc"
+extern proc qio_file_prefetch(f:qio_file_ptr_t, start:int(64), len:int(64)):syserr;
+pragma "no doc"
+extern proc qio_file_map_region(f:qio_file_ptr_t, start:int(64), len:int(64), hints:c_int, ref data:c_void_ptr):syserr;
+pragma "no doc"
+extern proc qio_unmap_region(data:c_void_ptr, len:int(64)):syserr;
 
 pragma "no doc"
 pragma "no prototype" // FIXME
@@ -1639,6 +1666,21 @@ extern proc qio_channel_write_amt(threadsafe:c_int, ch:qio_channel_ptr_t, const
 pragma "no doc"
 extern proc qio_channel_write_byte(threadsafe:c_int, ch:qio_channel_ptr_t, byte:uint(8)):syserr;
 
+pragma "no doc"
+extern proc qio_channel_read_bulk(threadsafe:c_int, ch:qio_channel_ptr_t, ptr:_ddata, len:ssize_t, swap_size:ssize_t):syserr;
+pragma "no doc"
+extern proc qio_channel_write_bulk(threadsafe:c_int, ch:qio_channel_ptr_t, const ptr:_ddata, len:ssize_t, swap_size:ssize_t):syserr;
+pragma "no doc"
+extern proc qio_channel_direct_start(threadsafe:c_int, ch:qio_channel_ptr_t, len:int(64), ref offset:int(64)):syserr;
+pragma "no doc"
+extern proc qio_channel_direct_end(threadsafe:c_int, ch:qio_channel_ptr_t, len:int(64));
+pragma "no doc"
+extern proc qio_channel_get_file(ch:qio_channel_ptr_t):qio_file_ptr_t;
+pragma "no doc"
+extern proc qio_file_pread_amt(f:qio_file_ptr_t, ptr:_ddata, len:int(64), offset:int(64), swap_size:ssize_t):syserr;
+pragma "no doc"
+extern proc qio_file_pwrite_amt(f:qio_file_ptr_t, const ptr:_ddata, len:int(64), offset:int(64), swap_size:ssize_t):syserr;
+
 pragma "no doc"
 extern proc qio_channel_offset_unlocked(ch:qio_channel_ptr_t):int(64);
 pragma "no doc"
@@ -1782,6 +1824,10 @@ pragma "no doc"
 extern proc hdfs_connect(out fs: c_void_ptr, path: c_string, port: int): syserr; 
 pragma "no doc"
 extern proc hdfs_do_release(fs:c_void_ptr);
+
+/****************** G Z I P ******************/
+pragma "no doc"
+extern const gzip_function_struct_ptr:qio_file_functions_ptr_t;
 // End
 
 pragma "no doc"
@@ -1968,6 +2014,9 @@ The following :type:`iohints` constants are provided:
     cached in memory, possibly all at once.
   * :const:`IOHINT_PARALLEL` suggests to expect many channels
     working with this file in parallel.
+  * :const:`IOHINT_URING` requests batched asynchronous I/O with
+    Linux io_uring.
+  * :const:`IOHINT_DIRECT` requests I/O that bypasses the page cache.
 
 
 Other hints might be added in the future.
@@ -1991,6 +2040,7 @@ The default value of the :type:`iohints` type is undefined.
 //  QIO_METHOD_READWRITE,
 //  QIO_METHOD_P_READWRITE,
 //  QIO_METHOD_MMAP,
+//  QIO_METHOD_URING,
 //  QIO_HINT_RANDOM,
 //  QIO_HINT_SEQUENTIAL,
 //  QIO_HINT_LATENCY,
@@ -2290,7 +2340,15 @@ to create a channel to actually perform I/O operations
           arguments of the form "hdfs://<host>:<port>/<path>". If Curl is
           enabled, this function supports ``url=`` starting with
           ``http://``, ``https://``, ``ftp://``, ``ftps://``, ``smtp://``,
-          ``smtps://``, ``imap://``, or ``imaps://``
+          ``smtps://``, ``imap://``, or ``imaps://``. If gzip support is
+          enabled (``CHPL_AUX_FILESYS=gzip``), ``url="gzip://<path>"``
+          opens the file at ``<path>`` with transparent gzip compression.
+          Such a file can be opened with ``iomode.r`` or ``iomode.cw``.
+          Data written to it is compressed in independent blocks by several
+          threads at once (see ``CHPL_RT_GZIP_THREADS``), and reading a
+          file written that way decompresses several blocks at once and
+          supports reading from any offset. Other gzip files can only be
+          read sequentially.
 :returns: an open file to the requested resource. If the ``error=`` argument
           was provided and the file was not opened because of an error, returns
           the default :record:`file` value.
@@ -2365,6 +2423,9 @@ proc open(out error:syserr, path:string="", mode:iomode, hints:iohints=IOHINT_NO
          (2015-02-04, lydia)
 
       */
+    } else if (url.startsWith("gzip://")) { // compressed local file
+      var file_path = url.substring(8..url.length);
+      error = qio_file_open_access_usr(ret._file_internal, file_path.c_str(), _modestring(mode).c_str(), hints, local_style, c_nil, gzip_function_struct_ptr);
     } else {
       ioerror(ENOENT:syserr, "Invalid URL passed to open");
       /* TODO: This code is an alternative to the above line, which breaks the
@@ -2855,6 +2916,13 @@ proc channel._ch_ioerror(errstr:string, msg:string) {
 
 /*
    Acquire a channel's lock.
+
+   The lock is re-entrant. Each operation on a locking channel
+   acquires and releases it, but when the calling task already holds
+   the lock that only updates a count. So a task that performs many
+   small operations on a channel can lock it once around the batch
+   (and :proc:`channel.unlock` it afterwards) to avoid the full
+   locking cost for each one.
    
    :arg error: optional argument to capture an error code. If this argument
                is not provided and an error is encountered, this function
@@ -3085,7 +3153,8 @@ This function is equivalent to calling :proc:`open` and then
           arguments of the form "hdfs://<host>:<port>/<path>". If Curl is
           enabled, this function supports ``url=`` starting with
           ``http://``, ``https://``, ``ftp://``, ``ftps://``, ``smtp://``,
-          ``smtps://``, ``imap://``, or ``imaps://``
+          ``smtps://``, ``imap://``, or ``imaps://``. ``gzip://<path>``
+          is also supported when gzip support is enabled; see :proc:`open`.
 :returns: an open reading channel to the requested resource. If the ``error=``
           argument was provided and the channel was not opened because of an
           error, returns the default :record:`channel` value.
@@ -3154,7 +3223,8 @@ This function is equivalent to calling :proc:`open` with ``iomode.cwr`` and then
           arguments of the form "hdfs://<host>:<port>/<path>". If Curl is
           enabled, this function supports ``url=`` starting with
           ``http://``, ``https://``, ``ftp://``, ``ftps://``, ``smtp://``,
-          ``smtps://``, ``imap://``, or ``imaps://``
+          ``smtps://``, ``imap://``, or ``imaps://``. ``gzip://<path>``
+          is also supported when gzip support is enabled; see :proc:`open`.
 :returns: an open reading channel to the requested resource. If the ``error=``
           argument was provided and the channel was not opened because of an
           error, returns the default :record:`channel` value.
@@ -3279,6 +3349,210 @@ proc file.lines(param locking:bool = true, start:int(64) = 0, end:int(64) = max(
   return ret;
 }
 
+/* Iterate over all of the lines in a file. When used in a ``forall`` loop,
+   the file is split into chunks that are read by separate tasks.
+
+   Each chunk is read with its own unlocked channel, so the tasks do not
+   share a buffer or a lock. A chunk's boundaries are moved forward to just
+   past the next ``delimiter`` byte, so each line is yielded exactly once,
+   by the chunk it starts in. The serial version yields the lines in order;
+   the parallel version yields them in order within each chunk, but the
+   chunks are read in no particular order.
+
+   :arg start: the byte offset at which to start reading
+   :arg end: the byte offset at which to stop reading; the file length is
+             used if that is smaller
+   :arg hints: hints to use for the channels reading the file
+   :arg delimiter: the byte that ends each line or record. The default is
+                   ``'\n'``
+   :arg chunkSize: the size of each chunk in bytes. The default of 0 picks
+                   a size based on the amount to read and the number of
+                   tasks. The size is rounded up to a multiple of 64 KiB.
+   :yields: strings containing each line, including the delimiter
+ */
+iter file.parallelLines(start:int(64) = 0, end:int(64) = max(int(64)), hints:iohints = IOHINT_NONE, delimiter:uint(8) = 0x0a, chunkSize:int(64) = 0): string {
+  var r = this._linesReader(start, end, hints, delimiter);
+  var line:string;
+  while r.read(line) do yield line;
+  r.close();
+}
+
+pragma "no doc"
+iter file.parallelLines(param tag:iterKind, start:int(64) = 0, end:int(64) = max(int(64)), hints:iohints = IOHINT_NONE, delimiter:uint(8) = 0x0a, chunkSize:int(64) = 0): string
+    where tag == iterKind.standalone {
+  // chunks are aligned to this many bytes
+  param chunkAlign = 64*1024;
+  // and are no smaller than this unless chunkSize is given
+  param minChunkSize = 1024*1024;
+
+  check();
+
+  on this.home {
+    const readEnd = min(end, this.length());
+
+    if start < readEnd {
+      const ntasksPerLocale = if dataParTasksPerLocale == 0 then here.maxTaskPar
+                              else dataParTasksPerLocale;
+      var size = chunkSize;
+      if size <= 0 {
+        // Make a few chunks per task to even out the load.
+        size = max((readEnd - start) / (4 * ntasksPerLocale), minChunkSize);
+      }
+      size = ((size + chunkAlign - 1) / chunkAlign) * chunkAlign;
+
+      const nchunks = (readEnd - start + size - 1) / size;
+      const ntasks = min(ntasksPerLocale, nchunks);
+      var nextChunk:atomic int(64);
+
+      coforall tid in 0..#ntasks {
+        while true {
+          const i = nextChunk.fetchAdd(1);
+          if i >= nchunks then break;
+
+          const chunkStart = start + i*size;
+          const chunkEnd = min(chunkStart + size, readEnd);
+          const lo = if i == 0 then start
+                     else this._recordStart(chunkStart - 1, readEnd, delimiter);
+          const hi = if chunkEnd == readEnd then readEnd
+                     else this._recordStart(chunkEnd - 1, readEnd, delimiter);
+
+          // If a line spans the whole chunk, the chunk
+          // it started in handles it.
+          if lo < hi {
+            qio_file_prefetch(this._file_internal, lo, hi - lo);
+            var r = this._linesReader(lo, hi, hints, delimiter);
+            var line:string;
+            while r.read(line) do yield line;
+            r.close();
+          }
+        }
+      }
+    }
+  }
+}
+
+pragma "no doc"
+proc file._linesReader(start:int(64), end:int(64), hints:iohints, delimiter:uint(8)) {
+  var style = this._style;
+  style.string_format = QIO_STRING_FORMAT_TOEND;
+  style.string_end = delimiter;
+  return this.reader(locking=false, start=start, end=end, hints=hints, style=style);
+}
+
+// Returns the offset just past the first delimiter in [start, end),
+// or end if there isn't one.
+pragma "no doc"
+proc file._recordStart(start:int(64), end:int(64), delimiter:uint(8)):int(64) {
+  var pos:int(64);
+  var err = qio_file_find_record_start(_file_internal, start, end, delimiter, pos);
+  if err then ioerror(err, "in file.parallelLines", this.tryGetPath());
+  return pos;
+}
+
+/*
+   Map part of the file into memory and return an array that uses the file
+   data directly as its storage. Nothing is copied: the OS reads each page of
+   the file when it is first accessed, so creating the array is fast no
+   matter how large it is, and parts of the file that are never used are
+   never read. The mapping is removed when the array is destroyed.
+
+   This is meant for large, read-only tables. The file data is used as-is,
+   so it must hold ``eltType`` values in the native binary format, and
+   ``eltType`` must be a numeric or boolean type. If the file was opened
+   for writing, assigning to array elements changes the file; otherwise
+   the array must not be modified.
+
+   Initializing a variable from the result (``var A = f.mapArray(real);``)
+   copies the data into a new array. Declare an alias instead to use the
+   mapped data directly:
+
+   .. code-block:: chapel
+
+     var A => f.mapArray(real);
+
+   The array is stored on the calling locale, which must be the locale
+   where the file was opened. To give each locale its own region of a file,
+   open the file and call this method in an ``on`` statement on each
+   locale.
+
+   :arg eltType: the type of the array elements
+   :arg error: optional argument to capture an error code. If this argument
+               is not provided and an error is encountered, this function
+               will halt with an error message.
+   :arg start: the byte offset of the first element in the file
+   :arg count: the number of elements. The default of -1 uses the rest of
+               the file after ``start``, ignoring any partial element at the
+               end.
+   :arg hints: the expected access pattern, e.g. :const:`IOHINT_RANDOM` or
+               :const:`IOHINT_SEQUENTIAL`. :const:`IOHINT_CACHED` reads the
+               whole region in right away. The file's hints are used if
+               this is :const:`IOHINT_NONE`.
+   :returns: an array over ``{0..#count}`` (empty if there is an error)
+ */
+proc file.mapArray(type eltType, out error:syserr, start:int(64) = 0, count:int(64) = -1, hints:iohints = IOHINT_NONE) {
+  var data:c_void_ptr;
+  const n = this._mapRegion(eltType, error, start, count, hints, data);
+  return _arrayOverMapping(eltType, data, n);
+}
+
+// documented in the error= version
+pragma "no doc"
+proc file.mapArray(type eltType, start:int(64) = 0, count:int(64) = -1, hints:iohints = IOHINT_NONE) {
+  var err:syserr = ENOERR;
+  var data:c_void_ptr;
+  const n = this._mapRegion(eltType, err, start, count, hints, data);
+  if err then ioerror(err, "in file.mapArray", this.tryGetPath());
+  // Return the new array directly; storing it in a variable first
+  // would copy the mapped data.
+  return _arrayOverMapping(eltType, data, n);
+}
+
+// Maps the region for file.mapArray and returns the number of elements,
+// or 0 if there was an error.
+pragma "no doc"
+proc file._mapRegion(type eltType, out error:syserr, start:int(64), count:int(64), hints:iohints, ref data:c_void_ptr):int(64) {
+  if !(isNumericType(eltType) || isBoolType(eltType)) then
+    compilerError("file.mapArray requires a numeric or boolean element type");
+
+  check();
+
+  const eltSize = numBytes(eltType);
+  var n = count;
+
+  error = ENOERR;
+  if this.home != here || count < -1 || start < 0 {
+    error = EINVAL;
+  } else if count == -1 {
+    var len:int(64);
+    error = qio_file_length(_file_internal, len);
+    n = if len > start then (len - start) / eltSize else 0;
+  }
+
+  if !error then
+    error = qio_file_map_region(_file_internal, start, n*eltSize, hints, data);
+
+  if error then return 0;
+  return n;
+}
+
+pragma "no doc"
+proc _arrayOverMapping(type eltType, data:c_void_ptr, n:int(64)) {
+  var storage:_MappedFileStorage;
+  if n > 0 then storage = new _MappedFileStorage(data, n*numBytes(eltType));
+  return chpl__buildArrayOverData({0..#n}, eltType, data, storage);
+}
+
+// Unmaps the data of an array returned by file.mapArray.
+pragma "no doc"
+class _MappedFileStorage: DefaultRectangularExternStorage {
+  var data:c_void_ptr;
+  var len:int(64);
+  proc release() {
+    var err = qio_unmap_region(data, len);
+    if err then ioerror(err, "in unmapping an array mapped from a file");
+  }
+}
+
 /*
    Create a :record:`channel` that supports writing to a file. See
    :ref:`about-io-overview`.
@@ -4577,6 +4851,29 @@ class ChannelWriter : Writer {
     }
   }
 
+  proc writeBulk(x, len:ssize_t, swapSize:ssize_t) {
+    if ! err {
+      on this {
+        err = qio_channel_write_bulk(false, _channel_internal, x, len, swapSize);
+      }
+    }
+  }
+
+  proc _directStart(len:int(64), out offset:int(64), out path:string):bool {
+    var ret = false;
+    if ! err {
+      on this {
+        ret = _channelDirectStart(_channel_internal, len, offset, path);
+      }
+    }
+    return ret;
+  }
+  proc _directEnd(len:int(64)) {
+    on this {
+      qio_channel_direct_end(false, _channel_internal, len);
+    }
+  }
+
   proc writeThis(w:Writer) {
     // MPF - I don't understand why I had to add this,
     // but without it test/modules/diten/returnClassDiffModule5.chpl fails.
@@ -4630,12 +4927,58 @@ class ChannelReader : Reader {
     }
   }
 
+  proc readBulk(x, len:ssize_t, swapSize:ssize_t) {
+    if ! err {
+      on this {
+        err = qio_channel_read_bulk(false, _channel_internal, x, len, swapSize);
+      }
+    }
+  }
+
+  proc _directStart(len:int(64), out offset:int(64), out path:string):bool {
+    var ret = false;
+    if ! err {
+      on this {
+        ret = _channelDirectStart(_channel_internal, len, offset, path);
+      }
+    }
+    return ret;
+  }
+  proc _directEnd(len:int(64)) {
+    on this {
+      qio_channel_direct_end(false, _channel_internal, len);
+    }
+  }
+
   proc writeThis(w:Writer) {
     compilerError("writeThis on ChannelReader called");
   }
   // writeThis + no readThis -> ChannelReader itself cannot be read
 }
 
+// Support for distributed arrays that read or write their parts of a
+// channel in parallel. Each locale opens the channel's file again by
+// path (so this only works for files that all of the locales can see)
+// and transfers its part with qio_file_pread_amt/qio_file_pwrite_amt.
+// _channelDirectStart returns false if the channel doesn't support it.
+pragma "no doc"
+proc _channelDirectStart(ch:qio_channel_ptr_t, len:int(64), out offset:int(64), out path:string):bool {
+  var tmp:c_string_copy;
+  if qio_file_path(qio_channel_get_file(ch), tmp) then return false;
+  // This uses the version of toString that steals its operand.
+  path = toString(tmp);
+  return ! qio_channel_direct_start(false, ch, len, offset);
+}
+
+pragma "no doc"
+proc _directFileOpen(path:string, writing:bool, out error:syserr):qio_file_ptr_t {
+  var ret:qio_file_ptr_t = QIO_FILE_PTR_NULL;
+  var style = defaultIOStyle();
+  var access = if writing then "r+" else "r";
+  error = qio_file_open_access(ret, path.c_str(), access.c_str(), 0, style);
+  return ret;
+}
+
 
 /* Delete a file. This function is likely to be replaced
    by :proc:`FileSystem.remove`.
@@ -6639,6 +6982,8 @@ pragma "no doc"
 extern const FTYPE_LUSTRE : c_int;
 pragma "no doc"
 extern const FTYPE_CURL   : c_int;
+pragma "no doc"
+extern const FTYPE_GZIP   : c_int;
 
 pragma "no doc"
 proc file.fstype():int {
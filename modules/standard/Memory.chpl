@@ -186,7 +186,11 @@ proc printMemLeaksTable() {
 proc printMemStat() {
   pragma "insert line file info"
   extern proc chpl_printMemStat();
+  extern proc chpl_snapshotMemStat();
 
+  // Other locales' counters are read from their snapshots.
+  if numLocales > 1 then
+    for loc in Locales do on loc do chpl_snapshotMemStat();
   chpl_printMemStat();
 }
 
@@ -23,6 +23,8 @@
 // This is the type of the task private data used by the cache
 typedef struct {
   int64_t last_acquire; // cache acquire barrier sets this
+  int64_t shared_acquire; // same, for the node-level shared cache
+  int shared_puts; // PUTs since last release (shared cache bypassed)
 } chpl_cache_taskPrvData_t;
 
 #endif
@@ -88,6 +88,22 @@ void chpl_cache_print(void);
 #endif
 // ifdef HAS_CHPL_CACHE_FNS
 
+// Cache counters for the CommDiagnostics module. These are only
+// counted while comm diagnostics are on, and are always 0 if the
+// comm layer has no cache.
+void chpl_resetCacheDiagnosticsHere(void);
+uint64_t chpl_numCacheHits(void);
+uint64_t chpl_numCacheMisses(void);
+uint64_t chpl_numCacheReadaheadHits(void);
+uint64_t chpl_numCacheReadaheadUnused(void);
+uint64_t chpl_numCacheAinEvicts(void);
+uint64_t chpl_numCacheAoutEvicts(void);
+uint64_t chpl_numCacheAmEvicts(void);
+uint64_t chpl_numCacheDirtyFlushes(void);
+uint64_t chpl_numCacheCombinedPuts(void);
+uint64_t chpl_numCacheCombinedFlushes(void);
+uint64_t chpl_numCacheFenceWaits(void);
+
 
 #endif
 
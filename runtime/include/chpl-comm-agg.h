@@ -0,0 +1,157 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_comm_agg_h_
+#define _chpl_comm_agg_h_
+
+#ifndef LAUNCHER
+
+#include <stdint.h>
+#include "chpltypes.h"
+
+//
+// Aggregation of small remote operations.
+//
+// An aggregator collects operations bound for other nodes in one buffer
+// per destination node. A buffer is sent as a single message when it
+// is full, when its oldest operation has waited longer than the
+// aggregation timeout (checked as more operations are added), or when
+// the aggregator is flushed. The destination node runs all of the
+// operations in a message together. Operations for this node are run
+// right away.
+//
+// An aggregator is not thread-safe; each task should use its own.
+// chpl_comm_agg_flush returns once every operation added so far has
+// been run, and chpl_comm_agg_destroy flushes before freeing.
+//
+// Settings (read once at startup):
+//   CHPL_RT_COMM_AGG_BUFFER_SIZE  bytes of operations per destination
+//                                 buffer (limited by the comm layer's
+//                                 largest message)
+//   CHPL_RT_COMM_AGG_TIMEOUT      microseconds an operation may wait in
+//                                 a buffer before it is sent (0 means
+//                                 only send full or flushed buffers)
+//
+
+// Built-in operations. Each is an atomic update of a 64-bit or 32-bit
+// integer on the destination node, and is cheap enough to run in the
+// comm layer's message handler. Unsigned values can use the same
+// operations, since they only depend on the bits.
+typedef enum {
+  CHPL_COMM_AGG_ADD_64,
+  CHPL_COMM_AGG_OR_64,
+  CHPL_COMM_AGG_AND_64,
+  CHPL_COMM_AGG_XOR_64,
+  CHPL_COMM_AGG_WRITE_64,
+  CHPL_COMM_AGG_ADD_32,
+  CHPL_COMM_AGG_OR_32,
+  CHPL_COMM_AGG_AND_32,
+  CHPL_COMM_AGG_XOR_32,
+  CHPL_COMM_AGG_WRITE_32,
+  CHPL_COMM_AGG_NUM_OPS
+} chpl_comm_agg_op_t;
+
+// A message is a sequence of these records, each followed by arg_size
+// bytes of arguments padded out to a multiple of 8 bytes. If fn is
+// less than CHPL_COMM_AGG_NUM_OPS, it is a chpl_comm_agg_op_t and the
+// arguments are a chpl_comm_agg_atomic_t. Otherwise it is a function
+// call: fn - CHPL_COMM_AGG_NUM_OPS is the function table index, and the
+// arguments are passed to the function. Function calls can block, so
+// messages containing them are run in a task rather than the handler.
+typedef struct {
+  uint32_t fn;
+  uint32_t arg_size;
+} chpl_comm_agg_record_t;
+
+typedef struct {
+  uint64_t raddr;
+  uint64_t operand;
+} chpl_comm_agg_atomic_t;
+
+#define CHPL_COMM_AGG_RECORD_SIZE(arg_size) \
+  (sizeof(chpl_comm_agg_record_t) + ((((size_t) (arg_size)) + 7) & ~((size_t) 7)))
+
+// Space reserved at the start of each message for the comm layer.
+#define CHPL_COMM_AGG_MSG_HEADER 24
+
+typedef struct chpl_comm_agg_s chpl_comm_agg_t;
+
+chpl_comm_agg_t* chpl_comm_agg_create(void);
+void chpl_comm_agg_destroy(chpl_comm_agg_t* agg);
+
+// Add a built-in operation on raddr on node.
+void chpl_comm_agg_atomic(chpl_comm_agg_t* agg, c_nodeid_t node,
+                          int32_t op, uint64_t raddr, uint64_t operand);
+
+// Add a call of function fid on node with a copy of arg_size bytes at
+// arg. A call whose arguments don't fit in a buffer is done right away
+// with chpl_comm_fork.
+void chpl_comm_agg_call(chpl_comm_agg_t* agg, c_nodeid_t node,
+                        chpl_fn_int_t fid, void* arg, int32_t arg_size);
+
+// Send all buffered operations and wait until they have been run.
+void chpl_comm_agg_flush(chpl_comm_agg_t* agg);
+
+// Read the settings. Called by the comm layer once it can answer
+// chpl_comm_agg_max_msg.
+void chpl_comm_agg_init(void);
+
+// Run the records in buf (nbytes long) on this node. Comm layers call
+// this when a message arrives.
+void chpl_comm_agg_apply(void* buf, size_t nbytes);
+
+// Called on the sending node once the operations in a message sent
+// for agg have been run.
+void chpl_comm_agg_acked(chpl_comm_agg_t* agg);
+
+// The number of messages sent for agg that have not been acked yet.
+uint64_t chpl_comm_agg_pending(chpl_comm_agg_t* agg);
+
+//
+// The comm layers implement these.
+//
+
+// The largest message (including the header) chpl_comm_agg_send takes.
+size_t chpl_comm_agg_max_msg(void);
+
+// Send the message in msg (nbytes long, starting with
+// CHPL_COMM_AGG_MSG_HEADER bytes the comm layer may overwrite) to node.
+// in_task says whether it contains any function calls. This can return
+// before the operations run; when they have, the comm layer calls
+// chpl_comm_agg_acked(agg) on this node. msg can be reused right away.
+void chpl_comm_agg_send(c_nodeid_t node, void* msg, size_t nbytes,
+                        int in_task, chpl_comm_agg_t* agg);
+
+// Wait until chpl_comm_agg_pending(agg) is 0.
+void chpl_comm_agg_wait(chpl_comm_agg_t* agg);
+
+//
+// Counts, kept while communication diagnostics are on.
+//
+void chpl_resetCommAggDiagnosticsHere(void);
+uint64_t chpl_numCommAggOps(void);
+uint64_t chpl_numCommAggLocalOps(void);
+uint64_t chpl_numCommAggMsgs(void);
+uint64_t chpl_numCommAggFullSends(void);
+uint64_t chpl_numCommAggTimeoutSends(void);
+uint64_t chpl_numCommAggFlushes(void);
+
+#endif // LAUNCHER
+
+#endif
@@ -23,6 +23,7 @@
 #ifndef LAUNCHER
 
 #include <stdint.h>
+#include <string.h>
 #include "chpltypes.h"
 #include "chpl-comm-impl.h"
 #include "chpl-comm-heap-macros.h"
@@ -108,6 +109,38 @@ void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles);
 // detected.
 int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles);
 
+// A buffer for chpl_comm_put_combined is a sequence of these records,
+// each followed by len bytes of data padded out to a multiple of 8 bytes.
+typedef struct {
+  uint64_t raddr;
+  uint32_t len;
+  uint32_t pad;
+} chpl_comm_put_record_t;
+
+#define CHPL_COMM_PUT_RECORD_SIZE(len) \
+  (sizeof(chpl_comm_put_record_t) + ((((size_t) (len)) + 7) & ~((size_t) 7)))
+
+// Store the data in each record of buf (nbytes long) to its raddr on
+// this node. Comm layers use this to apply chpl_comm_put_combined.
+static inline
+void chpl_comm_apply_put_records(void* buf, size_t nbytes) {
+  unsigned char* cur = (unsigned char*) buf;
+  unsigned char* end = cur + nbytes;
+  chpl_comm_put_record_t r;
+
+  while (cur < end) {
+    memcpy(&r, cur, sizeof(r));
+    memcpy((void*) (intptr_t) r.raddr, cur + sizeof(r), r.len);
+    cur += CHPL_COMM_PUT_RECORD_SIZE(r.len);
+  }
+}
+
+// Do the PUTs described by the nbytes of records in buf to node. Many
+// small PUTs can be sent in a single message this way and applied on
+// the remote side. Returns once all of the PUTs are complete.
+void chpl_comm_put_combined(c_nodeid_t node, void* buf, size_t nbytes,
+                            int ln, c_string fn);
+
 // Returns whether or not the passed wide address is known to be in
 // a communicable memory region - that is, a region for which it is
 // guaranteed that puts/gets will succeed without access violation or
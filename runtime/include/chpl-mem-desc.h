@@ -86,6 +86,16 @@
           "comm layer private objects array"),                          \
         m(COMM_PRIVATE_BROADCAST_DATA,                                  \
           "comm layer private broadcast data"),                         \
+        m(COMM_PUT_COMBINED_DATA,                                       \
+          "comm layer combined put data"),                              \
+        m(COMM_AGG,                                                     \
+          "comm layer aggregator"),                                     \
+        m(COMM_AGG_BUFFER,                                              \
+          "comm layer aggregation buffer"),                             \
+        m(COMM_AGG_RECV,                                                \
+          "comm layer received aggregated operations"),                 \
+        m(COMM_STRD_BUFFER,                                             \
+          "comm layer packed strided transfer data"),                   \
         m(GLOM_STRINGS_DATA,                                            \
           "glom strings data"),                                         \
         m(STRING_COPY_DATA,                                             \
@@ -118,6 +128,8 @@
           "task pool descriptor"),                                      \
         m(TASK_LIST_DESCRIPTOR,                                         \
           "task list descriptor"),                                      \
+        m(TASK_DEQUE,                                                   \
+          "task deque"),                                                \
         m(THREAD_PRIVATE_DATA,                                          \
           "thread private data"),                                       \
         m(THREAD_LIST_DESCRIPTOR,                                       \
@@ -22,13 +22,44 @@
 #ifndef LAUNCHER
 #include <stdint.h>
 #include "chpltypes.h"
+#include "chpl-atomics.h"
+#include "chpl-bitops.h"
 
-extern void** chpl_privateObjects; // privatized array and domain objects
+//
+// Privatized array, domain, and distribution objects, indexed by pid.
+//
+// The table is a series of chunks, where chunk k holds
+// CHPL_PRIVATIZATION_CHUNK0 << k entries.  Chunks are added as needed
+// and never move or shrink, so the table can grow without copying
+// while other tasks read it.  Only adding a chunk takes a lock.
+//
+#define CHPL_PRIVATIZATION_CHUNK0_LOG2 6
+#define CHPL_PRIVATIZATION_CHUNK0 (1 << CHPL_PRIVATIZATION_CHUNK0_LOG2)
+#define CHPL_PRIVATIZATION_MAX_CHUNKS 48
+
+extern atomic_uintptr_t chpl_privateObjectChunks[CHPL_PRIVATIZATION_MAX_CHUNKS];
+
+// The chunk holding pid, and pid's index within it.
+static inline int chpl_privatization_chunk(int64_t pid) {
+  uint64_t q = (((uint64_t) pid) >> CHPL_PRIVATIZATION_CHUNK0_LOG2) + 1;
+  return 63 - (int) chpl_bitops_clz_64(q);
+}
+
+static inline int64_t chpl_privatization_index(int64_t pid, int chunk) {
+  return pid - ((((int64_t) 1) << chunk) - 1) * CHPL_PRIVATIZATION_CHUNK0;
+}
 
 extern void chpl_privatization_init(void);
 
 extern void chpl_newPrivatizedClass(void*, int64_t);
-extern void* chpl_getPrivatizedClass(int64_t);
+
+static inline void* chpl_getPrivatizedClass(int64_t i) {
+  int chunk = chpl_privatization_chunk(i);
+  void** c = (void**)
+    atomic_load_explicit_uintptr_t(&chpl_privateObjectChunks[chunk],
+                                   memory_order_acquire);
+  return c[chpl_privatization_index(i, chunk)];
+}
 
 #endif // LAUNCHER
 #endif // _chpl_privatization_h_
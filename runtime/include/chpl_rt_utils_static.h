@@ -26,4 +26,5 @@ void chpldev_taskTable_set_active(chpl_taskID_t taskID);
 void chpldev_taskTable_set_suspended(chpl_taskID_t taskID);
 uint64_t chpldev_taskTable_get_tl_info(chpl_taskID_t taskID);
 void chpldev_taskTable_print(void);
+int32_t chpldev_taskTable_num_shards(void);
 #endif
@@ -34,6 +34,7 @@ extern chpl_bool chpl_memTrack;
 
 void chpl_setMemFlags(void);
 uint64_t chpl_memoryUsed(int32_t lineno, c_string filename);
+void chpl_snapshotMemStat(void);
 void chpl_printMemStat(int32_t lineno, c_string filename);
 void chpl_printLeakedMemTable(void);
 void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename);
@@ -157,8 +157,22 @@ void qbytes_free_qio_free(qbytes_t* b);
 
 void _qbytes_init_generic(qbytes_t* ret, void* give_data, int64_t len, qbytes_free_t free_function);
 qioerr qbytes_create_generic(qbytes_t** out, void* give_data, int64_t len, qbytes_free_t free_function);
+// iobufs come from a recycling pool; reused ones are zeroed.
 qioerr _qbytes_init_iobuf(qbytes_t* ret);
 qioerr qbytes_create_iobuf(qbytes_t** out);
+
+// Counters for the iobuf pool on this locale, for tuning
+// CHPL_RT_IOBUF_POOL_SIZE.
+typedef struct qbytes_iobuf_pool_stats_s {
+  uint64_t allocated; // iobufs allocated from the system
+  uint64_t reused; // iobufs handed out again from the pool
+  uint64_t recycled; // released iobufs kept in the pool
+  uint64_t freed; // iobufs returned to the system
+} qbytes_iobuf_pool_stats_t;
+
+void qbytes_iobuf_pool_stats(qbytes_iobuf_pool_stats_t* stats);
+// Return the pooled iobufs to the system, at shutdown.
+void qbytes_iobuf_pool_exit(void);
 qioerr _qbytes_init_calloc(qbytes_t* ret, int64_t len);
 
 // The caller is responsible for calling qbytes_release on the return value.
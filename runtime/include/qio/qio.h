@@ -74,6 +74,10 @@ typedef uint32_t qio_hint_t;
 #define FTYPE_CURL 3
 #endif
 
+#ifndef FTYPE_GZIP
+#define FTYPE_GZIP 4
+#endif
+
 // So that we can free c_strings from Chapel
 // This is temporary for now, one Sung's 'string_free' function goes in, this
 // and the use of it in IO.chpl can go away.
@@ -210,8 +214,31 @@ typedef struct {
 
 #define NULL_OWNER chpl_nullTaskID
 
-qioerr qio_lock(qio_lock_t* x);
-void qio_unlock(qio_lock_t* x);
+qioerr qio_lock_slow(qio_lock_t* x, int64_t id);
+void qio_unlock_slow(qio_lock_t* x);
+
+// Only the owner can store its own ID in x->owner, so a task can
+// check whether it already holds the lock without synchronizing. Such
+// a task only bumps the count; this is what makes holding a channel's
+// lock across a batch of operations (see qio_channel_lock) cheaper
+// than locking for each one.
+static inline qioerr qio_lock(qio_lock_t* x) {
+  int64_t id = chpl_task_getId();
+
+  if( x->owner == id ) {
+    ++x->count;
+    return 0;
+  }
+  return qio_lock_slow(x, id);
+}
+
+static inline void qio_unlock(qio_lock_t* x) {
+  if( x->owner == chpl_task_getId() && x->count > 1 ) {
+    --x->count;
+    return;
+  }
+  qio_unlock_slow(x);
+}
 
 static inline qioerr qio_lock_init(qio_lock_t* x) {
   x->owner = NULL_OWNER;
@@ -224,6 +251,68 @@ static inline void qio_lock_destroy(qio_lock_t* x) {
   chpl_sync_destroyAux(&x->sv);
 }
 
+// A lock that can be held by one exclusive user or by any number of
+// shared users. Exclusive users hold 'lock' (so exclusive locking is
+// re-entrant); shared users just count themselves in 'shared', which
+// the exclusive user waits to drain. The task holding the lock
+// exclusively can also lock it shared, but a task holding it shared
+// must not try to get it exclusively.
+typedef struct {
+  qio_lock_t lock;
+  atomic_int_least64_t shared;
+} qio_rwlock_t;
+
+qioerr qio_lock_shared_slow(qio_rwlock_t* x);
+
+static inline qioerr qio_rwlock_init(qio_rwlock_t* x) {
+  atomic_init_int_least64_t(&x->shared, 0);
+  return qio_lock_init(&x->lock);
+}
+
+static inline void qio_rwlock_destroy(qio_rwlock_t* x) {
+  atomic_destroy_int_least64_t(&x->shared);
+  qio_lock_destroy(&x->lock);
+}
+
+static inline qioerr qio_lock_exclusive(qio_rwlock_t* x) {
+  qioerr err;
+
+  err = qio_lock(&x->lock);
+  if( err ) return err;
+
+  // Our store to lock.owner must be visible before we read 'shared'.
+  // qio_lock_shared does the reverse (counts itself, then reads the
+  // owner), so without this fence each of us could miss the other.
+  atomic_thread_fence(memory_order_seq_cst);
+
+  // wait for shared users to finish (unless they are us).
+  while( atomic_load_int_least64_t(&x->shared) != 0 ) {
+    chpl_task_yield();
+  }
+  return 0;
+}
+
+static inline void qio_unlock_exclusive(qio_rwlock_t* x) {
+  qio_unlock(&x->lock);
+}
+
+static inline qioerr qio_lock_shared(qio_rwlock_t* x) {
+  int64_t owner;
+
+  atomic_fetch_add_int_least64_t(&x->shared, 1);
+  // Pairs with the fence in qio_lock_exclusive: this read can't
+  // happen before we are counted.
+  atomic_thread_fence(memory_order_seq_cst);
+  owner = x->lock.owner;
+  if( owner == NULL_OWNER || owner == chpl_task_getId() ) return 0;
+
+  return qio_lock_shared_slow(x);
+}
+
+static inline void qio_unlock_shared(qio_rwlock_t* x) {
+  atomic_fetch_sub_int_least64_t(&x->shared, 1);
+}
+
 #else
 
 #ifndef CHPL_RT_UNIT_TEST
@@ -263,6 +352,19 @@ static inline qioerr qio_lock_init(qio_lock_t* x) {
 
 // returns void for the same reason as qio_unlock.
 static inline void qio_lock_destroy(qio_lock_t* x) { int rc = pthread_mutex_destroy(x); if( rc ) { assert(rc == 0); abort(); } }
+
+// The unit tests don't need concurrent shared users, so
+// shared locking is the same as exclusive locking here.
+typedef struct {
+  qio_lock_t lock;
+} qio_rwlock_t;
+
+static inline qioerr qio_rwlock_init(qio_rwlock_t* x) { return qio_lock_init(&x->lock); }
+static inline void qio_rwlock_destroy(qio_rwlock_t* x) { qio_lock_destroy(&x->lock); }
+static inline qioerr qio_lock_exclusive(qio_rwlock_t* x) { return qio_lock(&x->lock); }
+static inline void qio_unlock_exclusive(qio_rwlock_t* x) { qio_unlock(&x->lock); }
+static inline qioerr qio_lock_shared(qio_rwlock_t* x) { return qio_lock(&x->lock); }
+static inline void qio_unlock_shared(qio_rwlock_t* x) { qio_unlock(&x->lock); }
 #endif
 
 
@@ -316,6 +418,8 @@ char* qio_chtype_to_string(qio_chtype_t type);
      -- noreuse -- pread/pwrite
      -- cached -- mmap for reads and writes
      -- force_readwrite
+     -- uring -- only if requested; batched preadv/pwritev through
+                 io_uring (Linux), falling back to pread/pwrite
  */
 
 #define QIO_HINT_AFTERCHTYPE 0x0010
@@ -326,13 +430,14 @@ typedef enum {
   QIO_METHOD_FREADFWRITE = 3*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MMAP = 4*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MEMORY = 5*QIO_HINT_AFTERCHTYPE,
+  QIO_METHOD_URING = 6*QIO_HINT_AFTERCHTYPE,
   //QIO_METHOD_LIBEVENT,
 } qio_method_t;
 #define QIO_METHODMASK 0x00f0
 #define QIO_HINT_AFTERMETHOD 0x0100
 #define QIO_METHOD_DEFAULT 0
 #define QIO_MIN_METHOD QIO_METHOD_READWRITE
-#define QIO_MAX_METHOD QIO_METHOD_MEMORY
+#define QIO_MAX_METHOD QIO_METHOD_URING
 
 enum {
   QIO_HINT_RANDOM       = QIO_HINT_AFTERMETHOD,
@@ -342,20 +447,18 @@ enum {
   QIO_HINT_CACHED       = QIO_HINT_BANDWIDTH<<1,
   QIO_HINT_PARALLEL     = QIO_HINT_CACHED<<1,
   QIO_HINT_DIRECT       = QIO_HINT_PARALLEL<<1,
-     // note -- if DIRECT is set, you must do aligned I/O;
-     // offset, request size must be 512-byte aligned, and
-     // user buffer must be page-aligned. This should more or
-     // less work the way you expect for a buffered channel,
-     // but you'll have to round out all files to a multiple of 512
-     // bytes. This library could help by turning off O_DIRECT when
-     // encountering improper alignment, but the linux open man page
-     // says:
-//Applications should avoid mixing O_DIRECT and normal I/O to the same file, and
-//especially to overlapping byte regions in the same file.  Even when the file
-//system correctly handles the coherency issues in this situation, overall I/O
-//throughput is likely to be slower than using either mode alone.  Likewise,
-//applications should avoid mixing mmap(2) of files with direct I/O to the same
-//files.
+     // DIRECT asks for file data to bypass the OS page cache (O_DIRECT).
+     // It only has an effect when a file is opened. The file keeps its
+     // normal descriptor and also opens a second one with O_DIRECT;
+     // buffered channels then allocate buffers so that memory addresses
+     // line up with file offsets, and qio_preadv/qio_pwritev use the
+     // O_DIRECT descriptor for the aligned middle of each request and
+     // the normal descriptor for any unaligned head or tail (such as
+     // the last partial block of a file). Channels on such files always
+     // use QIO_METHOD_PREADPWRITE.
+     //
+     // If the file system is memory-backed or refuses O_DIRECT, the hint
+     // is cleared and the file is accessed normally.
 
   QIO_HINT_NOREUSE      = QIO_HINT_DIRECT<<1,
 
@@ -427,6 +530,9 @@ char* qio_hints_to_string(qio_hint_t hint)
       case QIO_METHOD_MEMORY:
         strcat(buf, " memory"); ok = 1;
         break;
+      case QIO_METHOD_URING:
+        strcat(buf, " uring"); ok = 1;
+        break;
       // no default to get warned if any are added.
     }
   }
@@ -460,6 +566,8 @@ typedef struct qio_file_s {
   // An (arguably) better solution is to put 
   FILE* fp; // set if this file wraps a FILE*
   fd_t fd; // -1 if not set
+  fd_t direct_fd; // O_DIRECT descriptor for fd, or -1 (see QIO_HINT_DIRECT)
+  int64_t direct_align; // alignment needed for I/O on direct_fd
   int use_fp; // we only default to FREADFWRITE if this and fp are set.
   qbuffer_t* buf; // NULL if not set.
                   // if set, fp==NULL, fd==-1, is memory-only file.
@@ -510,8 +618,10 @@ typedef struct qio_file_s {
   // again (by the OS).
   //
   // The locking discipline is that channel locks must
-  // always be held before a file lock.
-  qio_lock_t lock;
+  // always be held before a file lock. Operations that only
+  // read the file's state (e.g. channels reading a MEMORY file)
+  // can hold it shared.
+  qio_rwlock_t lock;
   int64_t max_initial_position;
 
   qio_style_t style;
@@ -593,13 +703,13 @@ void qio_file_release(qio_file_t* f) {
 static inline
 qioerr qio_file_lock(qio_file_t* f)
 {
-  return qio_lock(&f->lock);
+  return qio_lock_exclusive(&f->lock);
 }
 
 static inline
 void qio_file_unlock(qio_file_t* f)
 {
-  qio_unlock(&f->lock);
+  qio_unlock_exclusive(&f->lock);
 }
 
 static inline
@@ -613,6 +723,26 @@ void qio_file_get_style(qio_file_t* f, qio_style_t* style)
 // Calls fflush on a FILE* first.
 qioerr qio_file_length(qio_file_t* f, int64_t *len_out);
 
+// Set *pos_out to the offset just past the first 'delim' byte
+// in [start, end) of the file, or to where the file data ends
+// (at most 'end') if there is no such byte. This is used to find
+// where the next record begins when splitting a file into chunks.
+qioerr qio_file_find_record_start(qio_file_t* f, int64_t start, int64_t end, int32_t delim, int64_t* pos_out);
+
+// Ask the OS to start reading [start, start+len) of the file
+// into memory in the background. Does nothing if the file
+// is not backed by a file descriptor.
+qioerr qio_file_prefetch(qio_file_t* f, int64_t start, int64_t len);
+
+// Map [start, start+len) of the file into memory, read-only unless the
+// file is writeable, and set *data_out to the address of the byte at
+// 'start'. Pages are read from the file as they are first touched,
+// unless hints include QIO_HINT_CACHED. The access pattern hints are
+// passed on to the OS; if hints is 0, the file's hints are used.
+// The region must be within the file. Unmap it with qio_unmap_region.
+qioerr qio_file_map_region(qio_file_t* f, int64_t start, int64_t len, qio_hint_t hints, void** data_out);
+qioerr qio_unmap_region(void* data, int64_t len);
+
 /* CHANNELS ..... */
 
 /* A Read and Write Buffered channels support:
@@ -802,6 +932,12 @@ typedef struct qio_channel_s {
   // for the common case of very few marks.
   int64_t mark_space[MARK_INITIAL_STACK_SZ];
 
+  // For QIO_METHOD_URING, the io_uring instance used for this
+  // channel's reads and writes. It's created on first use; if that
+  // fails, uring_failed is set and we use pread/pwrite instead.
+  struct qio_uring_s* uring;
+  int uring_failed;
+
   qio_style_t style;
 } qio_channel_t;
 
@@ -1041,6 +1177,11 @@ uint8_t qio_channel_binary(qio_channel_t* ch)
   return ch->style.binary;
 }
 static inline
+qio_file_t* qio_channel_get_file(qio_channel_t* ch)
+{
+  return ch->file;
+}
+static inline
 uint8_t qio_channel_byteorder(qio_channel_t* ch)
 {
   return ch->style.byteorder;
@@ -1145,6 +1286,44 @@ qioerr qio_channel_write_amt(const int threadsafe, qio_channel_t* restrict ch, c
   return err;
 }
 
+/* Bulk transfers, for reading and writing arrays of simple types.
+ *
+ * qio_channel_read_bulk and qio_channel_write_bulk work like
+ * qio_channel_read_amt and qio_channel_write_amt, except that:
+ *  - if swap_size > 1, the bytes of each swap_size-byte element of the
+ *    data are reversed (for data in the other byte order)
+ *  - large transfers on channels that use pread/pwrite go directly
+ *    between ptr and the file instead of through the channel buffer
+ *    (see qio_channel_direct_start)
+ */
+qioerr qio_channel_read_bulk(const int threadsafe, qio_channel_t* ch, void* ptr, ssize_t len, ssize_t swap_size);
+qioerr qio_channel_write_bulk(const int threadsafe, qio_channel_t* ch, const void* ptr, ssize_t len, ssize_t swap_size);
+
+// Transfers this large go directly to or from the file when they can.
+#define QIO_DIRECT_TRANSFER_MIN (1024*1024)
+
+/* qio_channel_direct_start prepares for the next len bytes of the
+ * channel to be transferred directly to or from the file, without
+ * going through the channel at all -- for example, by several tasks
+ * (or locales) calling qio_file_pread_amt/qio_file_pwrite_amt for
+ * different parts of it. It writes out any buffered data, discards
+ * the rest of the buffer, and returns the file offset of the channel
+ * in *offset_out. After the transfer, qio_channel_direct_end moves the
+ * channel past those len bytes.
+ *
+ * Returns ENOTSUP if the channel doesn't support this; that is, if it
+ * doesn't use pread/pwrite on a file descriptor, has a mark or bits
+ * pending, or if len bytes would go past the end of the channel.
+ */
+qioerr qio_channel_direct_start(const int threadsafe, qio_channel_t* ch, int64_t len, int64_t* offset_out);
+void qio_channel_direct_end(const int threadsafe, qio_channel_t* ch, int64_t len);
+
+// Read or write exactly len bytes at offset in the file, reversing the
+// bytes of each swap_size-byte element as above. Reading returns EEOF
+// if the file ends first.
+qioerr qio_file_pread_amt(qio_file_t* f, void* ptr, int64_t len, int64_t offset, ssize_t swap_size);
+qioerr qio_file_pwrite_amt(qio_file_t* f, const void* ptr, int64_t len, int64_t offset, ssize_t swap_size);
+
 qioerr _qio_channel_require_unlocked(qio_channel_t* ch, int64_t space, int writing);
 
 static inline
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_NUMBER_H_
+#define _QIO_NUMBER_H_
+
+#include "sys_basic.h"
+
+#include <inttypes.h>
+
+/* Decimal conversion kernels for the fast paths in qio_formatted.c.
+ *
+ * These only deal with plain decimal digits; signs, whitespace,
+ * padding and all of the other qio_style_t options are handled by
+ * the callers. The conversions between decimal and double either
+ * produce the correctly rounded result or return 0, in which case
+ * the caller should use strtod/snprintf instead.
+ */
+
+// Can't use more than this many digits in a uint64_t without overflow.
+#define QIO_MAX_EXACT_DECIMAL_DIGITS 19
+
+// Write num in decimal to dst, which must have room for 20 bytes.
+// Does not write a '\0'. Returns the number of bytes written.
+size_t qio_format_uint_dec(char* restrict dst, uint64_t num);
+
+// Parse up to max_digits (at most QIO_MAX_EXACT_DECIMAL_DIGITS) decimal
+// digits from p[0..len), stopping at the first non-digit. The digits
+// are appended to *num_inout (i.e. *num_inout = *num_inout*10^n + digits),
+// which the caller must ensure won't overflow. Returns the number of
+// digits parsed.
+size_t qio_scan_dec_digits(const uint8_t* restrict p, size_t len, size_t max_digits, uint64_t* restrict num_inout);
+
+// Compute the double nearest to mantissa * 10^exp10 (with the given
+// sign), storing it in *out. Returns 1 on success or 0 if the result
+// could not be determined quickly (including when it is subnormal,
+// zero because of underflow, or infinite).
+int qio_dec_to_double(uint64_t mantissa, int64_t exp10, int negative, double* restrict out);
+
+// Compute the first ndigits (1 <= ndigits <= 17) significant decimal
+// digits of num (which must be finite and > 0), correctly rounded as
+// printf would round them. On success, *digits_out has exactly ndigits
+// digits and num ~= *digits_out * 10^(*exp10_out - ndigits + 1), and
+// the return value is 1. Returns 0 if the rounding could not be
+// determined quickly.
+int qio_double_to_dec(double num, int ndigits, uint64_t* restrict digits_out, int* restrict exp10_out);
+
+#endif
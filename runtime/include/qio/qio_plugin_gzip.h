@@ -0,0 +1,60 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef QIOPLUGIN_GZIP_H_
+#define QIOPLUGIN_GZIP_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Transparent gzip compression for files opened with a "gzip://" URL.
+ *
+ * When writing, data is gathered into blocks of QIO_GZIP_BLOCK_SIZE
+ * bytes and each block is compressed as a separate gzip member. A batch
+ * of blocks is compressed in parallel, one thread per block. Each
+ * member records its compressed and uncompressed sizes in a gzip extra
+ * field, so the output is an ordinary multi-member .gz file that gzip
+ * and zcat can read, and that we can index when reading it back.
+ *
+ * When reading a file written this way, the member headers are scanned
+ * once to build an index. The file is then seekable in terms of the
+ * uncompressed data and reads decompress a window of consecutive blocks
+ * in parallel. Other gzip files can still be read, but only
+ * sequentially.
+ *
+ * The number of threads defaults to QIO_GZIP_DEFAULT_THREADS and can be
+ * set with the CHPL_RT_GZIP_THREADS environment variable. A compressed
+ * file can be opened for reading or for writing, but not both.
+ */
+
+#define QIO_GZIP_BLOCK_SIZE (1024*1024)
+#define QIO_GZIP_DEFAULT_THREADS 4
+#define QIO_GZIP_MAX_THREADS 64
+
+extern qio_file_functions_t gzip_function_struct;
+extern const qio_file_functions_ptr_t gzip_function_struct_ptr;
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_URING_H_
+#define _QIO_URING_H_
+
+#include "sys_basic.h"
+#include "sys.h"
+#include "qbuffer.h"
+
+/* Support for QIO_METHOD_URING.
+ *
+ * A qio_uring_t wraps a Linux io_uring instance. The read and write
+ * routines here split a request into up to QIO_URING_DEPTH pieces,
+ * submit them all with one system call, and then wait for the
+ * completions -- yielding the calling Chapel task while they are
+ * outstanding, so that other tasks can run on this thread while the
+ * kernel does the I/O.
+ *
+ * Each routine returns only after all of the requests it submitted
+ * have completed, so the caller's buffers need only remain valid for
+ * the duration of the call. Like preadv/pwritev, the amount
+ * transferred is always a prefix of the requested range; if one piece
+ * comes up short, data transferred by the pieces after it is ignored.
+ *
+ * A qio_uring_t is not thread-safe; channels keep one each and only
+ * use it while holding the channel lock.
+ *
+ * qio_uring_create returns ENOSYS when io_uring is not available
+ * (non-Linux systems, older kernels or headers, or when the system
+ * call is blocked); callers should fall back to pread/pwrite.
+ */
+
+// How many requests can be in flight at once.
+#define QIO_URING_DEPTH 4
+
+// Requests smaller than this are not split any further.
+#define QIO_URING_MIN_REQUEST (16*1024)
+
+typedef struct qio_uring_s qio_uring_t;
+
+qioerr qio_uring_create(qio_uring_t** ring_out);
+void qio_uring_destroy(qio_uring_t* ring);
+
+qioerr qio_uring_preadv(qio_uring_t* ring, fd_t fd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_uring_pwritev(qio_uring_t* ring, fd_t fd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+
+qioerr qio_uring_pread(qio_uring_t* ring, fd_t fd, void* ptr, ssize_t len, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_uring_pwrite(qio_uring_t* ring, fd_t fd, const void* ptr, ssize_t len, int64_t seek_to_offset, ssize_t* num_written);
+
+#endif
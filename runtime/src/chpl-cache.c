@@ -197,6 +197,19 @@ buffer.
 When processing GETs on adjacent memory locations, the cache triggers
 both synchronous and asynchronous read-ahead.
 
+Besides that, each cache runs a stride prefetcher over a small table of GET
+'streams'. A stream is identified by a node and the address of its last GET;
+a GET that is within PREFETCH_STREAM_WINDOW bytes of that address continues
+the stream. Only GETs that miss in the cache or use prefetched data are
+considered, so GETs of data that stays in the cache don't interrupt a stream.
+Once the same stride (distance between GET addresses) has been seen
+PREFETCH_STREAM_CONFIDENCE times in a row, the prefetcher starts prefetching
+'distance' strides ahead of the program. The distance starts at
+1, doubles whenever a GET uses prefetched data, and is halved whenever
+prefetched data is evicted or invalidated without having been used. Strides
+smaller than a cache page are prefetched a cache page at a time. Prefetches
+are not started when the cache already has many pending operations.
+
 When processing a PUT, we similarly check for the requested cache page in the
 pointer tree and use an unused page if not. We find a unused 'dirty entry' to
 track the dirty bits of the cache page if the cache entry does not already have
@@ -208,6 +221,13 @@ appropriate bits in the dirty entry.
 On a release barrier or when we have too many 'dirty entries', we go through
 dirty pages and create and start PUTs for each contiguous section with the dirty
 bits set. In this manner, PUTs to adjacent memory locations are aggregated.
+Sections of at most MAX_COMBINED_PUT_BYTES are not PUT directly but copied into
+a write-combining buffer for their node (see chpl_comm_put_combined). A buffer
+holds small PUTs from any number of pages and is sent as a single message,
+which the remote node applies, when it fills up or at a release barrier. So
+that PUTs and GETs stay in order, the buffer for a node is also sent before
+this cache starts another GET or PUT to that node that overlaps one of its
+PUTs.
 
 Note that it took significant effort to implement this cache efficiently
 enough.  The implementation we are presenting here is the 5th design we tried.
@@ -254,6 +274,56 @@ would be to only move tasks between threads in situations that create full
 barriers anyway; notably a full barrier occurs on task start and sync variable
 use.
 
+== Node-level Shared Cache ==
+
+Programs in which every task scans the same read-mostly remote data cause each
+pthread's cache to GET (and store) its own copy of the same pages. Setting
+CHPL_RT_CACHE_SHARED=1 in the environment enables a second mode in which GETs
+are served from a single cache shared by all of the pthreads on a locale.
+PUTs and prefetches still go through the pthread-local cache, which in this
+mode is given the minimum size since it only holds write-behind data.
+
+The shared cache is a direct-mapped table of cache pages. Each slot has a
+version stamp that works like a seqlock: it is odd while the slot is being
+filled. Lookups take no locks; a reader copies out of the page and then checks
+that the version did not change, treating the access as a miss otherwise. A
+miss claims the slot with a compare-and-swap and fills the whole page with a
+blocking GET (nonblocking handles are pthread-specific, so they can't be
+shared between readers). If the slot is already being filled, the reader just
+does an uncached GET.
+
+Acquire barriers are handled with a locale-wide epoch counter rather than with
+the per-cache sequence numbers. Each slot records the epoch in effect when its
+GET was started and an acquire barrier moves the task to a new epoch, so a
+task only uses pages that were fetched after its last acquire. A task that
+has done a PUT bypasses the shared cache until its next release barrier
+(since the shared copy of a page might not include that PUT); once the release
+has completed the PUTs, the task moves to a new epoch as well.
+
+== Tuning ==
+
+The cache geometry can be set with environment variables when the program
+starts:
+
+  CHPL_RT_CACHE_PAGE_SIZE       cache page size in bytes (64, 256, 1024
+                                or 4096; default 1024)
+  CHPL_RT_CACHE_LINE_SIZE       cache line size in bytes (a power of 2
+                                between 64 and the page size; default 64)
+  CHPL_RT_CACHE_PAGES_PER_NODE  cache pages per locale, used to size the
+                                cache within its bounds (default 4)
+  CHPL_RT_CACHE_MAX_PENDING     pending operations per cache (rounded up
+                                to a power of 2; default 32)
+  CHPL_RT_CACHE_AIN_PERCENT     size of Ain as a percentage of the cache
+                                pages (default 25)
+  CHPL_RT_CACHE_AOUT_PERCENT    number of entries remembered in Aout as a
+                                percentage of the cache pages (default 50)
+
+Invalid settings are warned about and the default is used instead. While
+comm diagnostics are on, each locale also counts cache hits and misses,
+readahead hits, evictions from each of the 2Q queues, PUTs started to write
+back dirty data and release fences that had to wait; the CommDiagnostics
+module reports these.
+
  */
 
 // ASSUMES THAT TASKS DO NOT MIGRATE BETWEEN PTHREADS
@@ -291,15 +361,36 @@ use.
 //int CHPL_CACHE_REMOTE = 1;
 #define VERIFY 0
 
+// The cache geometry below is given by default values, but each of
+// these can be changed with an environment variable when the program
+// starts (see cache_read_geometry()).
+
 // We try to auto-size the cache so that we
 // can have CACHE_PAGES_PER_NODE cache pages per locale, but we
 // do so within the below bounds.
-#define CACHE_PAGES_PER_NODE 4
+// Set with CHPL_RT_CACHE_PAGES_PER_NODE.
+#define DEFAULT_CACHE_PAGES_PER_NODE 4
+static int cache_pages_per_node = DEFAULT_CACHE_PAGES_PER_NODE;
+#define CACHE_PAGES_PER_NODE cache_pages_per_node
 #define MIN_CACHE_DATA_SIZE (1024*1024)
 #define MAX_CACHE_DATA_SIZE (256*1024*1024)
 
 // How many pending operations can we have at once?
-#define MAX_PENDING 32
+// Set with CHPL_RT_CACHE_MAX_PENDING (rounded up to a power of 2).
+#define DEFAULT_MAX_PENDING 32
+static int cache_max_pending = DEFAULT_MAX_PENDING;
+#define MAX_PENDING cache_max_pending
+
+// What percentage of the cache pages can be in Ain, and how many pages
+// (as a percentage of the cache pages) does Aout remember?
+// Set with CHPL_RT_CACHE_AIN_PERCENT and CHPL_RT_CACHE_AOUT_PERCENT.
+// 2Q: "Kin should be 25% of page slots"
+// 2Q: "Kout should hold identifiers for as many pages as would fit in
+//      50% of the buffer"
+#define DEFAULT_AIN_PERCENT 25
+#define DEFAULT_AOUT_PERCENT 50
+static int cache_ain_percent = DEFAULT_AIN_PERCENT;
+static int cache_aout_percent = DEFAULT_AOUT_PERCENT;
 
 // CACHEPAGE_BITS 
 // Controls the cache page size - the cache manages items of this many bytes
@@ -308,20 +399,31 @@ use.
 // Reasonable values for CACHEPAGE_BITS are between 6 and 12
 // (64 bytes and 4k bytes. CACHEPAGE_BITS should not be larger than the
 // page size) and it must currently be even.
-// Here we set it to 1k bytes (ie 2^10).
-#define CACHEPAGE_BITS 10
+// By default we set it to 1k bytes (ie 2^10).
+// Set with CHPL_RT_CACHE_PAGE_SIZE (in bytes).
+#define DEFAULT_CACHEPAGE_BITS 10
+#define MIN_CACHEPAGE_BITS 6
+#define MAX_CACHEPAGE_BITS 12
+static int cache_page_bits = DEFAULT_CACHEPAGE_BITS;
+#define CACHEPAGE_BITS cache_page_bits
 #define CACHEPAGE_SIZE (1 << CACHEPAGE_BITS)
 #define CACHEPAGE_MASK (CACHEPAGE_SIZE-1)
+#define MAX_CACHEPAGE_SIZE (1 << MAX_CACHEPAGE_BITS)
 
 // CACHELINE_BITS 
 // Controls the cache line size - that is, the minimum number of bytes
 // that are fetched for any 'get' operation.
 //
 // Reasonable values for CACHELINE_BITS are between 6 and CACHEPAGE_BITS.
-// Here we set it to 64 bytes (ie 2^6)
-#define CACHELINE_BITS 6
+// By default we set it to 64 bytes (ie 2^6)
+// Set with CHPL_RT_CACHE_LINE_SIZE (in bytes).
+#define DEFAULT_CACHELINE_BITS 6
+#define MIN_CACHELINE_BITS 6
+static int cache_line_bits = DEFAULT_CACHELINE_BITS;
+#define CACHELINE_BITS cache_line_bits
 #define CACHELINE_SIZE (1 << CACHELINE_BITS)
 #define CACHELINE_MASK (CACHELINE_SIZE-1)
+#define MIN_CACHELINE_SIZE (1 << MIN_CACHELINE_BITS)
 
 // What type can store the number of cache lines in a cache page?
 typedef int8_t line_per_page_t; 
@@ -340,6 +442,24 @@ typedef int16_t readahead_distance_t;
 #define ENABLE_READAHEAD_TRIGGER_SEQUENTIAL 0
 #define MAX_SEQUENTIAL_READAHEAD_BYTES (MAX_PAGES_PER_PREFETCH*CACHEPAGE_SIZE)
 
+// Should small PUTs to the same node be sent together in one message?
+#define ENABLE_PUT_COMBINING 1
+// Dirty regions of at most this many bytes are combined.
+#define MAX_COMBINED_PUT_BYTES 256
+// How many bytes of combined PUTs can we hold for each node?
+#define PUT_COMBINE_BUFFER_BYTES (16*1024)
+
+// Should we enable the stride prefetcher?
+#define ENABLE_STREAM_PREFETCH 1
+// How many GET streams does each cache track?
+#define PREFETCH_STREAMS 8
+// How close does a GET need to be to a stream's last GET to continue it?
+#define PREFETCH_STREAM_WINDOW (1024*1024)
+// How many times in a row must we see a stride before prefetching?
+#define PREFETCH_STREAM_CONFIDENCE 2
+// How many strides ahead can a stream prefetch?
+#define MAX_PREFETCH_STREAM_DISTANCE 16
+
 //#define TIME
 //#define TRACE
 //#define DEBUG
@@ -393,6 +513,34 @@ static long time_duration(const struct timespec* t1, const struct timespec* t2)
 #include "chpl-cache-support.c"
 
 
+// ----------  DIAGNOSTICS
+// These are counted for all of the caches on this locale while comm
+// diagnostics are on, and reported by the CommDiagnostics module.
+typedef enum {
+  CACHE_DIAG_HIT, // pages read by a GET without communication
+  CACHE_DIAG_MISS, // pages a GET had to fetch
+  CACHE_DIAG_READAHEAD_HIT, // prefetched lines later used by a GET
+  CACHE_DIAG_READAHEAD_UNUSED, // prefetched lines dropped without use
+  CACHE_DIAG_AIN_EVICT, // pages moved from Ain to Aout
+  CACHE_DIAG_AOUT_EVICT, // entries forgotten by Aout
+  CACHE_DIAG_AM_EVICT, // pages evicted from Am
+  CACHE_DIAG_DIRTY_FLUSH, // dirty regions written back
+  CACHE_DIAG_COMBINED_PUT, // ... of which were combined with others
+  CACHE_DIAG_COMBINED_FLUSH, // buffers of combined PUTs sent
+  CACHE_DIAG_FENCE_WAIT, // release fences that waited for pending ops
+  CACHE_DIAG_NUM
+} cache_diag_t;
+
+static atomic_uint_least64_t cache_diags[CACHE_DIAG_NUM];
+
+static inline
+void cache_diag_add(cache_diag_t which, uint64_t n)
+{
+  if( chpl_comm_diagnostics && n )
+    atomic_fetch_add_uint_least64_t(&cache_diags[which], n);
+}
+
+
 
 
 // Forward Declarations.
@@ -439,15 +587,17 @@ struct rdcache_s;
 #define HALF_SIZE (1L << HALF_BITS)
 
 // How many uint64_t words do we need to create a bitmask for CACHEPAGE_SIZE?
-// Divide # bytes in cache by 64, rounding up.
-#define CACHEPAGE_BITMASK_WORDS ((CACHEPAGE_SIZE+63)/64)
+// Divide # bytes in cache by 64, rounding up. Since the page size is set
+// at run time, we size bitmasks for the largest page allowed.
+#define CACHEPAGE_BITMASK_WORDS ((MAX_CACHEPAGE_SIZE+63)/64)
 
 // How many cache lines per cache page?
 #define CACHE_LINES_PER_PAGE (CACHEPAGE_SIZE/CACHELINE_SIZE)
 
 // How many uint64_t words do we need to create a bitmask for CACHE_LINES_PER_PAGE
-// ie, a mask recording a bit per cache line?
-#define CACHE_LINES_PER_PAGE_BITMASK_WORDS (((CACHEPAGE_SIZE/CACHELINE_SIZE)+63)/64)
+// ie, a mask recording a bit per cache line? (again, for the largest
+// number of lines per page allowed)
+#define CACHE_LINES_PER_PAGE_BITMASK_WORDS (((MAX_CACHEPAGE_SIZE/MIN_CACHELINE_SIZE)+63)/64)
 
 struct cache_entry_base_s {
   uint32_t index_bits;
@@ -508,6 +658,8 @@ struct cache_entry_s {
   unsigned char* page;
   // Which of the cache lines have we done 'get's for?
   uint64_t valid_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  // Which of the valid lines were prefetched and not yet used by a 'get'?
+  uint64_t prefetched_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
   // dirty info if this cache page is dirty, NULL otherwise.
   struct dirty_entry_s* dirty;
   // What is the mininimum sequence number stored in this cache entry?
@@ -566,6 +718,25 @@ struct top_entry_s {
   struct cache_entry_s* bottom_index[BOTTOM_SIZE];
 };
 
+// A stream of GETs for the stride prefetcher.
+struct prefetch_stream_s {
+  c_nodeid_t node; // -1 if this stream is unused
+  raddr_t last_raddr; // address of the last GET in this stream
+  intptr_t stride; // bytes between the last two GETs
+  int confidence; // number of times in a row we have seen stride
+  int distance; // how many strides ahead to prefetch
+  raddr_t prefetched_to; // address of the furthest prefetch started
+};
+
+// Small PUTs waiting to be sent to one node, as a buffer of
+// chpl_comm_put_record_t records for chpl_comm_put_combined.
+struct put_combine_s {
+  size_t len; // bytes of records in data
+  raddr_t min_raddr; // lowest address written by a record
+  raddr_t max_raddr; // one past the highest address written by a record
+  uint64_t data[PUT_COMBINE_BUFFER_BYTES/sizeof(uint64_t)];
+};
+
 struct rdcache_s {
   // A 2Q cache.
   // See "2Q: A Low Overhead High Performance Buffer Management
@@ -583,6 +754,16 @@ struct rdcache_s {
   c_nodeid_t last_cache_miss_read_node;
   raddr_t last_cache_miss_read_addr;
 
+  // GET streams for the stride prefetcher.
+  int next_stream; // which stream to replace next
+  struct prefetch_stream_s streams[PREFETCH_STREAMS];
+
+  // Buffers of small PUTs for each node (allocated when first used),
+  // and the nodes that have PUTs waiting in their buffers.
+  struct put_combine_s** combine;
+  c_nodeid_t* combine_nodes;
+  int num_combine_nodes;
+
   // The variable names Ain Aout and Am come from the 2Q paper
 
   // Ain is a FIFO queue storing entries initially as they go into
@@ -670,6 +851,23 @@ struct rdcache_s {
 
 static void validate_cache(struct rdcache_s* tree);
 
+// Is the node-level shared cache in use? (see CHPL_RT_CACHE_SHARED)
+static int chpl_cache_shared = 0;
+
+// How many cache pages should a cache for GETs have?
+static
+int cache_num_pages(void)
+{
+  int cache_pages;
+
+  cache_pages = CACHE_PAGES_PER_NODE * chpl_numNodes;
+  if( cache_pages < MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
+    cache_pages = MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+  if( cache_pages > MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
+    cache_pages = MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+
+  return cache_pages;
+}
 
 static
 struct rdcache_s* cache_create(void) {
@@ -692,16 +890,15 @@ struct rdcache_s* cache_create(void) {
   unsigned char* buffer;
   unsigned char* pages;
 
-  cache_pages = CACHE_PAGES_PER_NODE * chpl_numNodes;
-  if( cache_pages < MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
-    cache_pages = MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
-  if( cache_pages > MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
-    cache_pages = MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+  // When GETs go through the shared cache, the pthread-local cache
+  // only needs to hold write-behind data.
+  if( chpl_cache_shared ) cache_pages = MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+  else cache_pages = cache_num_pages();
 
-  ain_pages = cache_pages / 4; // 2Q: "Kin should be 25% of page slots"
-  aout_pages = cache_pages / 2; // 2Q: "Kout should hold identifiers for as
-                                // many pages as would fit in 50% of the
-                                // buffer"
+  ain_pages = cache_pages * cache_ain_percent / 100;
+  aout_pages = cache_pages * cache_aout_percent / 100;
+  if( ain_pages < 1 ) ain_pages = 1;
+  if( aout_pages < 1 ) aout_pages = 1;
   // How many pages can be dirty at once?
   dirty_pages = 16 + cache_pages / 64; 
   // How many mid-level elements can we have in our tree? Note each is 8k in the current config..
@@ -716,6 +913,8 @@ struct rdcache_s* cache_create(void) {
   total_size += sizeof(chpl_comm_nb_handle_t) * pending_len;
   total_size += sizeof(cache_seqn_t) * pending_len;
   total_size += sizeof(struct top_entry_s) * top_entries;
+  total_size += sizeof(struct put_combine_s*) * chpl_numNodes;
+  total_size += sizeof(c_nodeid_t) * chpl_numNodes;
   // We allocate an extra page for alignment
   total_size += CACHEPAGE_SIZE + CACHEPAGE_SIZE * cache_pages;
 
@@ -745,6 +944,11 @@ struct rdcache_s* cache_create(void) {
   // and the top entries
   top_nodes = (struct top_entry_s*) (buffer + total_size);
   total_size += sizeof(struct top_entry_s) * top_entries;
+  // and the write-combining buffer pointers and node list
+  c->combine = (struct put_combine_s**) (buffer + total_size);
+  total_size += sizeof(struct put_combine_s*) * chpl_numNodes;
+  c->combine_nodes = (c_nodeid_t*) (buffer + total_size);
+  total_size += sizeof(c_nodeid_t) * chpl_numNodes;
   // Now, page-align the page allocations.
   offset = (((uintptr_t) buffer) + total_size) % CACHEPAGE_SIZE;
   if( offset != 0 ) offset = CACHEPAGE_SIZE - offset;
@@ -765,6 +969,16 @@ struct rdcache_s* cache_create(void) {
   c->last_cache_miss_read_node = -1;
   c->last_cache_miss_read_addr = 0;
 
+  c->next_stream = 0;
+  for( i = 0; i < PREFETCH_STREAMS; i++ ) {
+    c->streams[i].node = -1;
+  }
+
+  for( i = 0; i < chpl_numNodes; i++ ) {
+    c->combine[i] = NULL;
+  }
+  c->num_combine_nodes = 0;
+
   c->max_pages = cache_pages;
   c->max_entries = n_entries;
   c->max_top_nodes = top_entries;
@@ -854,6 +1068,10 @@ struct rdcache_s* cache_create(void) {
 
 static
 void cache_destroy(struct rdcache_s *cache) {
+  int i;
+  for( i = 0; i < chpl_numNodes; i++ ) {
+    if( cache->combine[i] ) chpl_free(cache->combine[i]);
+  }
   chpl_free(cache);
 }
 
@@ -1115,6 +1333,107 @@ static
 void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
                  raddr_t raddr, int32_t len_in);
 
+// Find the stream that a GET of node:raddr continues, or NULL if none does.
+static
+struct prefetch_stream_s* find_stream(struct rdcache_s* cache,
+                                      c_nodeid_t node, raddr_t raddr)
+{
+  struct prefetch_stream_s* s;
+  int i;
+
+  for( i = 0; i < PREFETCH_STREAMS; i++ ) {
+    s = &cache->streams[i];
+    if( s->node == node &&
+        raddr + PREFETCH_STREAM_WINDOW >= s->last_raddr &&
+        raddr <= s->last_raddr + PREFETCH_STREAM_WINDOW ) {
+      return s;
+    }
+  }
+  return NULL;
+}
+
+// Find the stream that prefetched the page at node:page_raddr, if any.
+static
+struct prefetch_stream_s* find_stream_for_page(struct rdcache_s* cache,
+                                               c_nodeid_t node,
+                                               raddr_t page_raddr)
+{
+  struct prefetch_stream_s* s;
+  raddr_t lo, hi;
+  int i;
+
+  for( i = 0; i < PREFETCH_STREAMS; i++ ) {
+    s = &cache->streams[i];
+    if( s->node != node || s->distance == 0 ) continue;
+    lo = round_down_to_mask(raddr_min(s->last_raddr, s->prefetched_to),
+                            CACHEPAGE_MASK);
+    hi = raddr_max(s->last_raddr, s->prefetched_to);
+    if( lo <= page_raddr && page_raddr <= hi ) return s;
+  }
+  return NULL;
+}
+
+// Note skip/len are in line numbers, NOT byte offsets!
+// Forget that these lines were prefetched, returning how many were.
+static
+int clear_prefetched_lines(struct cache_entry_s* entry,
+                           uintptr_t skip, uintptr_t len)
+{
+  uint64_t tmp[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  int count;
+
+  count = count_valid_at_after(entry->prefetched_lines, skip,
+                               CACHE_LINES_PER_PAGE_BITMASK_WORDS) -
+          count_valid_at_after(entry->prefetched_lines, skip + len,
+                               CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+  if( count )
+    unset_valids_for_skip_len(entry->prefetched_lines, tmp, skip, len,
+                              CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+  return count;
+}
+
+// A GET used prefetched lines, so prefetch further ahead.
+// Returns the number of prefetched lines used.
+static
+int prefetch_was_used(struct rdcache_s* cache, struct cache_entry_s* entry,
+                      uintptr_t skip, uintptr_t len)
+{
+  struct prefetch_stream_s* s;
+  int used;
+
+  used = clear_prefetched_lines(entry, skip, len);
+  if( ! used ) return 0;
+
+  cache_diag_add(CACHE_DIAG_READAHEAD_HIT, used);
+
+  s = find_stream(cache, entry->base.node, entry->raddr);
+  if( s && s->distance > 0 && s->distance < MAX_PREFETCH_STREAM_DISTANCE ) {
+    s->distance *= 2;
+    if( s->distance > MAX_PREFETCH_STREAM_DISTANCE )
+      s->distance = MAX_PREFETCH_STREAM_DISTANCE;
+  }
+
+  return used;
+}
+
+// Prefetched lines are being dropped, so prefetch less far ahead if
+// they were never used.
+static
+void prefetch_was_dropped(struct rdcache_s* cache, struct cache_entry_s* entry,
+                          uintptr_t skip, uintptr_t len)
+{
+  struct prefetch_stream_s* s;
+  int unused;
+
+  unused = clear_prefetched_lines(entry, skip, len);
+  if( ! unused ) return;
+
+  cache_diag_add(CACHE_DIAG_READAHEAD_UNUSED, unused);
+
+  s = find_stream_for_page(cache, entry->base.node, entry->raddr);
+  if( s && s->distance > 1 ) s->distance /= 2;
+}
+
 static
 void aout_evict(struct rdcache_s* cache)
 {
@@ -1125,6 +1444,8 @@ void aout_evict(struct rdcache_s* cache)
 
   if( !z ) return;
 
+  cache_diag_add(CACHE_DIAG_AOUT_EVICT, 1);
+
   // Remove the tail element from Aout
   DOUBLE_REMOVE_TAIL(cache, aout);
   cache->aout_current--;
@@ -1166,6 +1487,7 @@ void ain_evict(struct rdcache_s* cache, struct cache_entry_s* dont_evict_me)
   // immediately wait for them to complete, before we modify the contents
   // of Ain in any way (or reuse the associated page).
   flush_entry(cache, y, FLUSH_EVICT, 0, CACHEPAGE_SIZE);
+  cache_diag_add(CACHE_DIAG_AIN_EVICT, 1);
 
   DOUBLE_REMOVE_TAIL(cache, ain);
   cache->ain_current--;
@@ -1204,6 +1526,7 @@ void am_evict(struct rdcache_s *cache, struct cache_entry_s* dont_evict_me) {
   // immediately wait for them to complete, before we modify the contents
   // of Ain in any way (or reuse the associated page).
   flush_entry(cache, y, FLUSH_EVICT, 0, CACHEPAGE_SIZE);
+  cache_diag_add(CACHE_DIAG_AM_EVICT, 1);
 
   DOUBLE_REMOVE_TAIL(cache, am_lru);
   cache->am_current--;
@@ -1668,6 +1991,120 @@ void do_wait_for(struct rdcache_s* cache, cache_seqn_t sn)
 
 
 
+// ----------  WRITE COMBINING
+// Small dirty regions are copied into a buffer for their node instead of
+// being written back with a PUT each. A buffer is sent in one go (and
+// applied on the remote node) when it fills up, at a release fence, or
+// when a GET or PUT (combined or not) is about to start that overlaps
+// with one of its PUTs.
+
+// Send the PUTs waiting for node.
+static
+void combine_flush_node(struct rdcache_s* cache, c_nodeid_t node)
+{
+  struct put_combine_s* pc = cache->combine[node];
+  int i;
+
+  if( ! pc || pc->len == 0 ) return;
+
+  chpl_comm_put_combined(node, pc->data, pc->len, 0, "");
+  cache_diag_add(CACHE_DIAG_COMBINED_FLUSH, 1);
+  pc->len = 0;
+
+  // Remove node from the list of nodes with PUTs waiting.
+  for( i = cache->num_combine_nodes - 1; i >= 0; i-- ) {
+    if( cache->combine_nodes[i] == node ) {
+      cache->num_combine_nodes--;
+      cache->combine_nodes[i] = cache->combine_nodes[cache->num_combine_nodes];
+      break;
+    }
+  }
+}
+
+// Send all of the PUTs waiting in this cache.
+static
+void combine_flush_all(struct rdcache_s* cache)
+{
+  while( cache->num_combine_nodes > 0 ) {
+    combine_flush_node(cache,
+                       cache->combine_nodes[cache->num_combine_nodes - 1]);
+  }
+}
+
+// If any waiting PUT to node overlaps with raddr,len, send the PUTs
+// for node now so that they stay in order with the operation on raddr.
+static
+void combine_flush_overlapping(struct rdcache_s* cache, c_nodeid_t node,
+                               raddr_t raddr, uintptr_t len)
+{
+  struct put_combine_s* pc = cache->combine[node];
+  unsigned char* cur;
+  unsigned char* end;
+  chpl_comm_put_record_t r;
+
+  if( ! pc || pc->len == 0 ) return;
+  if( raddr + len <= pc->min_raddr || raddr >= pc->max_raddr ) return;
+
+  cur = (unsigned char*) pc->data;
+  end = cur + pc->len;
+  while( cur < end ) {
+    memcpy(&r, cur, sizeof(r));
+    if( raddr < r.raddr + r.len && r.raddr < raddr + len ) {
+      combine_flush_node(cache, node);
+      return;
+    }
+    cur += CHPL_COMM_PUT_RECORD_SIZE(r.len);
+  }
+}
+
+// Add a PUT of len bytes from addr to node:raddr to the buffer for node.
+// Returns 0 if the PUT can't be combined (and should be done separately).
+static
+int combine_put(struct rdcache_s* cache, c_nodeid_t node, raddr_t raddr,
+                unsigned char* addr, uintptr_t len)
+{
+  struct put_combine_s* pc;
+  chpl_comm_put_record_t r;
+  size_t rsize = CHPL_COMM_PUT_RECORD_SIZE(len);
+
+  if( ! ENABLE_PUT_COMBINING || len > MAX_COMBINED_PUT_BYTES ) return 0;
+
+  pc = cache->combine[node];
+  if( ! pc ) {
+    pc = chpl_malloc(sizeof(struct put_combine_s));
+    pc->len = 0;
+    cache->combine[node] = pc;
+  }
+
+  // The records in a buffer can be applied in any order (it may be sent
+  // as several unordered messages), so they must not overlap. Send the
+  // older value first if we are rewriting any of the same bytes.
+  combine_flush_overlapping(cache, node, raddr, len);
+
+  if( pc->len + rsize > PUT_COMBINE_BUFFER_BYTES ) {
+    combine_flush_node(cache, node);
+  }
+
+  if( pc->len == 0 ) {
+    cache->combine_nodes[cache->num_combine_nodes++] = node;
+    pc->min_raddr = raddr;
+    pc->max_raddr = raddr + len;
+  } else {
+    if( raddr < pc->min_raddr ) pc->min_raddr = raddr;
+    if( raddr + len > pc->max_raddr ) pc->max_raddr = raddr + len;
+  }
+
+  r.raddr = raddr;
+  r.len = len;
+  r.pad = 0;
+  memcpy((unsigned char*) pc->data + pc->len, &r, sizeof(r));
+  memcpy((unsigned char*) pc->data + pc->len + sizeof(r), addr, len);
+  pc->len += rsize;
+
+  cache_diag_add(CACHE_DIAG_COMBINED_PUT, 1);
+  return 1;
+}
+
 // For the region of this page in raddr,len, we complete any pending/not
 // started operations that possibly overlap with that region.
 // If FLUSH_EVICT or FLUSH_INVALIDATE_PAGE is set, we will ignore the region.
@@ -1722,21 +2159,31 @@ void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
         while( get_skip_len_for_valids(dirty_bits, start, &got_skip, &got_len, CACHEPAGE_BITMASK_WORDS) ) {
 
           start = got_skip;
-          // Start a put for len bytes starting at page + start
-          DEBUG_PRINT(("chpl_comm_start_put(%p, %i, %p, %i)\n",
-                 page+start, entry->base.node, (void*) (entry->raddr+start),
-                 (int) got_len));
-
-          handle = 
-            chpl_comm_put_nb(page+start, /*local addr*/
-                             entry->base.node,
-                             (void*)(entry->raddr+start),
-                             1 /*elmsize*/, -1/*typei*/,
-                             got_len /*len*/,
-                             -1, NULL);
-
-          // Save the handle in the list of pending requests.
-          entry->max_put_sequence_number = pending_push(cache, handle);
+          cache_diag_add(CACHE_DIAG_DIRTY_FLUSH, 1);
+
+          // Small regions are copied into the write-combining buffer,
+          // so there is nothing to wait for before reusing the page.
+          if( ! combine_put(cache, entry->base.node, entry->raddr+start,
+                            page+start, got_len) ) {
+            combine_flush_overlapping(cache, entry->base.node,
+                                      entry->raddr+start, got_len);
+
+            // Start a put for len bytes starting at page + start
+            DEBUG_PRINT(("chpl_comm_start_put(%p, %i, %p, %i)\n",
+                   page+start, entry->base.node, (void*) (entry->raddr+start),
+                   (int) got_len));
+
+            handle = 
+              chpl_comm_put_nb(page+start, /*local addr*/
+                               entry->base.node,
+                               (void*)(entry->raddr+start),
+                               1 /*elmsize*/, -1/*typei*/,
+                               got_len /*len*/,
+                               -1, NULL);
+
+            // Save the handle in the list of pending requests.
+            entry->max_put_sequence_number = pending_push(cache, handle);
+          }
 
           // Move past this region of 1s in dirty bits.
           start = got_skip + got_len;
@@ -1769,6 +2216,7 @@ void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
 
   // If invalidating, clear valid bits.
   if( op & FLUSH_DO_INVALIDATE ) {
+    prefetch_was_dropped(cache, entry, skip_lines, num_lines);
     if( len == CACHEPAGE_SIZE ) {
       entry->readahead_skip = 0;
       entry->readahead_len = 0;
@@ -1783,6 +2231,7 @@ void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
 
   // If evicting, remove the page from the cache and put it on a free list.
   if( op & FLUSH_DO_EVICT ) {
+    prefetch_was_dropped(cache, entry, 0, CACHE_LINES_PER_PAGE);
     // But, our entry no longer can have a page associated with it.
     page = entry->page;
     entry->page = NULL;
@@ -1878,6 +2327,7 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_match->page = page;
     // Clear the valid lines
     memset(&bottom_match->valid_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    memset(&bottom_match->prefetched_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
     // Clear the dirty pointer and sequence numbers.
     bottom_match->dirty = NULL;
     bottom_match->min_sequence_number = NO_SEQUENCE_NUMBER;
@@ -1905,6 +2355,7 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_tmp->prev = NULL;
     bottom_tmp->page = page;
     memset(&bottom_tmp->valid_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    memset(&bottom_tmp->prefetched_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
     bottom_tmp->dirty = NULL;
     bottom_tmp->min_sequence_number = NO_SEQUENCE_NUMBER;
     bottom_tmp->max_put_sequence_number = NO_SEQUENCE_NUMBER;
@@ -2225,6 +2676,104 @@ int should_readahead_extend(uint64_t* valid,
 }
 
 
+// Can we prefetch node:target..target+len-1 given that the program
+// just did a GET of node:raddr..raddr+size-1 ?
+static
+int stream_prefetch_ok(c_nodeid_t node, raddr_t raddr, int32_t size,
+                       raddr_t target, int32_t len)
+{
+  uintptr_t page_mask;
+
+  if( chpl_comm_is_in_segment(node, (void*) target, len) ) return 1;
+
+  // Without segment information, stay within the system pages
+  // of the request.
+  page_mask = sys_page_size() - 1;
+  return round_down_to_mask(raddr, page_mask) <=
+           round_down_to_mask(target, page_mask) &&
+         round_down_to_mask(target+len-1, page_mask) <=
+           round_down_to_mask(raddr+size-1, page_mask);
+}
+
+// Record a GET of node:raddr..raddr+size-1 in the stride prefetcher
+// and start any prefetches that it calls for.
+static
+void cache_stream_prefetch(struct rdcache_s* cache,
+                           c_nodeid_t node, raddr_t raddr, int32_t size,
+                           cache_seqn_t last_acquire,
+                           int ln, c_string fn)
+{
+  struct prefetch_stream_s* s;
+  intptr_t stride, step;
+  raddr_t base, target;
+  int32_t len;
+  int i;
+
+  s = find_stream(cache, node, raddr);
+  if( ! s ) {
+    // Start a new stream, replacing the oldest one.
+    s = &cache->streams[cache->next_stream];
+    cache->next_stream = (cache->next_stream + 1) % PREFETCH_STREAMS;
+    s->node = node;
+    s->last_raddr = raddr;
+    s->stride = 0;
+    s->confidence = 0;
+    s->distance = 0;
+    s->prefetched_to = raddr;
+    return;
+  }
+
+  stride = raddr - s->last_raddr;
+  if( stride == 0 ) return; // e.g. several GETs of one record's fields
+
+  s->last_raddr = raddr;
+
+  if( stride != s->stride ) {
+    s->stride = stride;
+    s->confidence = 0;
+    s->distance = 0;
+    s->prefetched_to = raddr;
+    return;
+  }
+
+  if( s->confidence < PREFETCH_STREAM_CONFIDENCE ) {
+    s->confidence++;
+    if( s->confidence < PREFETCH_STREAM_CONFIDENCE ) return;
+    s->distance = 1;
+  }
+
+  // Prefetch strides smaller than a cache page a page at a time,
+  // since one large GET is cheaper than several small ones.
+  base = raddr;
+  step = stride;
+  len = size;
+  if( step > -CACHEPAGE_SIZE && step < CACHEPAGE_SIZE ) {
+    base = round_down_to_mask(raddr, CACHEPAGE_MASK);
+    step = (step < 0) ? -CACHEPAGE_SIZE : CACHEPAGE_SIZE;
+    len = CACHEPAGE_SIZE;
+  }
+  // Leave larger requests to the sequential readahead.
+  if( len > CACHEPAGE_SIZE ) return;
+
+  for( i = 1; i <= s->distance; i++ ) {
+    target = base + i*step;
+    // Skip what this stream has already prefetched.
+    if( step > 0 && target <= s->prefetched_to ) continue;
+    if( step < 0 && target >= s->prefetched_to ) continue;
+    if( is_congested(cache) ) break;
+    if( ! stream_prefetch_ok(node, raddr, size, target, len) ) break;
+
+    INFO_PRINT(("%i stream prefetch %i:%p len %i stride %i distance %i\n",
+                (int) chpl_nodeID, (int) node, (void*) target, (int) len,
+                (int) stride, s->distance));
+
+    cache_get(cache, NULL /* prefetch */, node, target, len,
+              last_acquire, 0, ln, fn);
+    // cache_get could have replaced this stream's pages, but not the stream.
+    s->prefetched_to = target;
+  }
+}
+
 // If addr == NULL, this will prefetch.
 static
 void cache_get(struct rdcache_s* cache,
@@ -2252,6 +2801,7 @@ void cache_get(struct rdcache_s* cache,
   chpl_comm_nb_handle_t handle;
   uintptr_t readahead_len, readahead_skip;
   int ra;
+  int train_prefetcher = 0;
 #ifdef TIME
   struct timespec start_get1, start_get2, wait1, wait2;
 #endif
@@ -2414,6 +2964,12 @@ void cache_get(struct rdcache_s* cache,
           chpl_memcpy(addr+(requested_start-raddr),
                       page+(requested_start-ra_page),
                       requested_size);
+          cache_diag_add(CACHE_DIAG_HIT, 1);
+
+          if( prefetch_was_used(cache, entry,
+                                (ra_line - ra_page) >> CACHELINE_BITS,
+                                (ra_line_end - ra_line) >> CACHELINE_BITS) )
+            train_prefetcher = 1;
     
           // If we are accessing a page that has a readahead condition,
           // trigger that readahead.
@@ -2457,6 +3013,11 @@ void cache_get(struct rdcache_s* cache,
 
     // Otherwise -- start a get !
 
+    if( ! isprefetch ) {
+      cache_diag_add(CACHE_DIAG_MISS, 1);
+      train_prefetcher = 1;
+    }
+
     if( ! page ) {
       // get a page from the free list.
       page = allocate_page(cache);
@@ -2470,6 +3031,9 @@ void cache_get(struct rdcache_s* cache,
                  (int) chpl_nodeID, page+(ra_line-ra_page), node, (void*) ra_line,
                  (int) (ra_line_end - ra_line)));
 
+    // Don't read anything older than what we have waiting to PUT.
+    combine_flush_overlapping(cache, node, ra_line, ra_line_end - ra_line);
+
 #ifdef TIME
     clock_gettime(CLOCK_REALTIME, &start_get1);
 #endif
@@ -2490,10 +3054,25 @@ void cache_get(struct rdcache_s* cache,
       entry = make_entry(cache, node, ra_page, page);
     }
 
-    // Set the valid lines
-    set_valid_lines(entry->valid_lines,
-                    (ra_line - ra_page) >> CACHELINE_BITS,
-                    (ra_line_end - ra_line) >> CACHELINE_BITS);
+    // Set the valid lines, remembering which ones a prefetch added.
+    if( isprefetch ) {
+      uint64_t was_valid[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+      int j;
+      memcpy(was_valid, entry->valid_lines, sizeof(was_valid));
+      set_valid_lines(entry->valid_lines,
+                      (ra_line - ra_page) >> CACHELINE_BITS,
+                      (ra_line_end - ra_line) >> CACHELINE_BITS);
+      for( j = 0; j < CACHE_LINES_PER_PAGE_BITMASK_WORDS; j++ ) {
+        entry->prefetched_lines[j] |= entry->valid_lines[j] & ~was_valid[j];
+      }
+    } else {
+      set_valid_lines(entry->valid_lines,
+                      (ra_line - ra_page) >> CACHELINE_BITS,
+                      (ra_line_end - ra_line) >> CACHELINE_BITS);
+      clear_prefetched_lines(entry,
+                             (ra_line - ra_page) >> CACHELINE_BITS,
+                             (ra_line_end - ra_line) >> CACHELINE_BITS);
+    }
 
     if( ! isprefetch ) {
       // This will increment next request number so cache events are recorded.
@@ -2578,6 +3157,14 @@ void cache_get(struct rdcache_s* cache,
     }
   }
 
+  // Only GETs that missed or used prefetched data update the stride
+  // prefetcher, so that GETs of data that stays cached (such as array
+  // metadata) don't break up a stream.
+  if( ENABLE_STREAM_PREFETCH && train_prefetcher &&
+      sequential_readahead_length == 0 ) {
+    cache_stream_prefetch(cache, node, raddr, size, last_acquire, ln, fn);
+  }
+
   if( VERIFY ) validate_cache(cache);
 
 #ifdef DUMP
@@ -2665,6 +3252,191 @@ void wait_all(struct rdcache_s* cache)
 
 
 
+// ----------  NODE-LEVEL SHARED CACHE
+
+struct shared_page_s {
+  // Odd while the slot is being filled; changes whenever the slot does.
+  atomic_uint_least64_t version;
+  c_nodeid_t node;
+  raddr_t raddr; // aligned to CACHEPAGE_SIZE
+  // shared_epoch when the GET filling this page was started.
+  uint64_t epoch;
+  unsigned char* page;
+};
+
+struct shared_cache_s {
+  uintptr_t num_slots;
+  struct shared_page_s* slots;
+};
+
+static struct shared_cache_s* shared_cache = NULL;
+
+// Acquire barriers move a task to a new epoch (see the comment at the top).
+static atomic_uint_least64_t shared_epoch;
+
+static
+struct shared_cache_s* shared_cache_create(void)
+{
+  struct shared_cache_s* sc;
+  uintptr_t num_slots = cache_num_pages();
+  size_t total_size;
+  unsigned char* buffer;
+  unsigned char* pages;
+  uintptr_t offset;
+  uintptr_t i;
+
+  total_size = sizeof(struct shared_cache_s);
+  total_size += sizeof(struct shared_page_s) * num_slots;
+  // We allocate an extra page for alignment
+  total_size += CACHEPAGE_SIZE + CACHEPAGE_SIZE * num_slots;
+
+  buffer = chpl_malloc(total_size);
+
+  sc = (struct shared_cache_s*) buffer;
+  sc->num_slots = num_slots;
+  sc->slots = (struct shared_page_s*) (buffer + sizeof(struct shared_cache_s));
+  pages = (unsigned char*) (sc->slots + num_slots);
+  offset = ((uintptr_t) pages) % CACHEPAGE_SIZE;
+  if( offset != 0 ) pages += CACHEPAGE_SIZE - offset;
+
+  for( i = 0; i < num_slots; i++ ) {
+    atomic_init_uint_least64_t(&sc->slots[i].version, 0);
+    sc->slots[i].node = -1;
+    sc->slots[i].raddr = 0;
+    sc->slots[i].epoch = 0;
+    sc->slots[i].page = pages + i * CACHEPAGE_SIZE;
+  }
+
+  return sc;
+}
+
+static
+void shared_cache_destroy(struct shared_cache_s* sc)
+{
+  uintptr_t i;
+  for( i = 0; i < sc->num_slots; i++ ) {
+    atomic_destroy_uint_least64_t(&sc->slots[i].version);
+  }
+  chpl_free(sc);
+}
+
+static inline
+struct shared_page_s* shared_cache_slot(struct shared_cache_s* sc,
+                                        c_nodeid_t node, raddr_t page_raddr)
+{
+  uint64_t idx = page_raddr >> CACHEPAGE_BITS;
+  idx ^= ((uint64_t) node) << HALF_BITS;
+  return &sc->slots[idx % sc->num_slots];
+}
+
+// Copy size bytes at node:raddr, which must all be within one cache page,
+// out of the shared cache. Returns 1 if that page was in the cache and was
+// fetched during or after epoch 'after', or 0 for a miss (in which case addr
+// may have been overwritten).
+static
+int shared_cache_read(struct shared_cache_s* sc, unsigned char* addr,
+                      c_nodeid_t node, raddr_t raddr, int32_t size,
+                      uint64_t after)
+{
+  raddr_t page_raddr = round_down_to_mask(raddr, CACHEPAGE_MASK);
+  struct shared_page_s* slot = shared_cache_slot(sc, node, page_raddr);
+  uint_least64_t version;
+
+  version = atomic_load_explicit_uint_least64_t(&slot->version,
+                                                memory_order_acquire);
+  if( version & 1 ) return 0;
+  if( slot->node != node || slot->raddr != page_raddr ) return 0;
+  if( slot->epoch < after ) return 0;
+
+  memcpy(addr, slot->page + (raddr - page_raddr), size);
+
+  // The copy is only good if no one refilled the slot while we were at it.
+  atomic_thread_fence(memory_order_acquire);
+  return version == atomic_load_explicit_uint_least64_t(&slot->version,
+                                                        memory_order_relaxed);
+}
+
+// GET the cache page containing node:raddr into the shared cache and copy
+// size bytes at raddr out of it.
+static
+void shared_cache_fill(struct shared_cache_s* sc, unsigned char* addr,
+                       c_nodeid_t node, raddr_t raddr, int32_t size,
+                       int ln, c_string fn)
+{
+  raddr_t page_raddr = round_down_to_mask(raddr, CACHEPAGE_MASK);
+  struct shared_page_s* slot = shared_cache_slot(sc, node, page_raddr);
+  uint_least64_t version;
+
+  version = atomic_load_explicit_uint_least64_t(&slot->version,
+                                                memory_order_relaxed);
+  if( (version & 1) ||
+      ! atomic_compare_exchange_strong_uint_least64_t(&slot->version,
+                                                      version, version+1) ) {
+    // Another pthread is filling this slot, so don't wait for it.
+    chpl_comm_get(addr, node, (void*) raddr, 1 /*elmsize*/, -1 /*typei*/,
+                  size, ln, fn);
+    return;
+  }
+
+  // Record the epoch before starting the GET, since the data could
+  // be as old as that.
+  slot->node = node;
+  slot->raddr = page_raddr;
+  slot->epoch = atomic_load_uint_least64_t(&shared_epoch);
+
+  // Cache pages never cross a system page, so it's safe to get the
+  // whole thing.
+  chpl_comm_get(slot->page, node, (void*) page_raddr,
+                1 /*elmsize*/, -1 /*typei*/, CACHEPAGE_SIZE, ln, fn);
+
+  memcpy(addr, slot->page + (raddr - page_raddr), size);
+
+  atomic_store_explicit_uint_least64_t(&slot->version, version+2,
+                                       memory_order_release);
+}
+
+static
+void shared_cache_get(struct shared_cache_s* sc, unsigned char* addr,
+                      c_nodeid_t node, raddr_t raddr, int32_t size,
+                      uint64_t after, int ln, c_string fn)
+{
+  raddr_t page_end;
+  int32_t len;
+
+  // Large requests would just thrash the cache.
+  if( size > MAX_SEQUENTIAL_READAHEAD_BYTES ) {
+    chpl_comm_get(addr, node, (void*) raddr, 1 /*elmsize*/, -1 /*typei*/,
+                  size, ln, fn);
+    return;
+  }
+
+  while( size > 0 ) {
+    page_end = round_down_to_mask(raddr, CACHEPAGE_MASK) + CACHEPAGE_SIZE;
+    len = size;
+    if( raddr + len > page_end ) len = page_end - raddr;
+
+    if( shared_cache_read(sc, addr, node, raddr, len, after) ) {
+      cache_diag_add(CACHE_DIAG_HIT, 1);
+    } else {
+      cache_diag_add(CACHE_DIAG_MISS, 1);
+      shared_cache_fill(sc, addr, node, raddr, len, ln, fn);
+    }
+
+    addr += len;
+    raddr += len;
+    size -= len;
+  }
+}
+
+// Move the calling task to a new epoch of the shared cache.
+static inline
+void shared_cache_acquire(chpl_cache_taskPrvData_t* task_local)
+{
+  task_local->shared_acquire =
+    atomic_fetch_add_uint_least64_t(&shared_epoch, 1) + 1;
+}
+
+
 static struct rdcache_s* cache_create(void);
 
 // We access the pthread-specific version of the cache
@@ -2699,6 +3471,86 @@ void destroy_pthread_local_cache(void* arg)
   cache_destroy(s);
 }
 
+// Read an integer cache setting from the environment. Returns the
+// default if the variable is not set or is out of range.
+static
+int cache_getenv_int(const char* name, int def, int min, int max)
+{
+  char* p;
+  char* end;
+  long v;
+
+  if( (p = getenv(name)) == NULL )
+    return def;
+
+  v = strtol(p, &end, 10);
+  if( end == p || *end != '\0' || v < min || v > max ) {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "unknown setting for %s, try a value in %d..%d", name, min, max);
+    chpl_warning(msg, 0, NULL);
+    return def;
+  }
+
+  return (int) v;
+}
+
+// Returns log2(v) if v is a power of 2 or -1 otherwise.
+static
+int cache_log2(int v)
+{
+  int bits = 0;
+  if( v <= 0 || (v & (v-1)) != 0 ) return -1;
+  while( (1 << bits) < v ) bits++;
+  return bits;
+}
+
+// Set up the cache geometry from the environment. This must run before
+// any cache is created, since everything is sized using these values.
+static
+void cache_read_geometry(void)
+{
+  int v;
+  int bits;
+
+  v = cache_getenv_int("CHPL_RT_CACHE_PAGE_SIZE", CACHEPAGE_SIZE,
+                       1 << MIN_CACHEPAGE_BITS, MAX_CACHEPAGE_SIZE);
+  bits = cache_log2(v);
+  // The page index in the tree is split into halves, so the number of
+  // page bits must be even.
+  if( bits < 0 || (bits & 1) ) {
+    chpl_warning("CHPL_RT_CACHE_PAGE_SIZE must be 64, 256, 1024 or 4096",
+                 0, NULL);
+  } else {
+    cache_page_bits = bits;
+  }
+
+  v = cache_getenv_int("CHPL_RT_CACHE_LINE_SIZE", CACHELINE_SIZE,
+                       MIN_CACHELINE_SIZE, CACHEPAGE_SIZE);
+  bits = cache_log2(v);
+  if( bits < 0 ) {
+    chpl_warning("CHPL_RT_CACHE_LINE_SIZE must be a power of 2", 0, NULL);
+  } else {
+    cache_line_bits = bits;
+  }
+
+  cache_pages_per_node = cache_getenv_int("CHPL_RT_CACHE_PAGES_PER_NODE",
+                                          DEFAULT_CACHE_PAGES_PER_NODE,
+                                          1, MAX_CACHE_DATA_SIZE);
+
+  // The pending request queue is a circular buffer that must have a
+  // power of 2 entries.
+  v = cache_getenv_int("CHPL_RT_CACHE_MAX_PENDING", DEFAULT_MAX_PENDING,
+                       1, 1 << 16);
+  cache_max_pending = 1;
+  while( cache_max_pending < v ) cache_max_pending *= 2;
+
+  cache_ain_percent = cache_getenv_int("CHPL_RT_CACHE_AIN_PERCENT",
+                                       DEFAULT_AIN_PERCENT, 1, 99);
+  cache_aout_percent = cache_getenv_int("CHPL_RT_CACHE_AOUT_PERCENT",
+                                        DEFAULT_AOUT_PERCENT, 1, 1000);
+}
+
 static
 void chpl_cache_do_init(void)
 {
@@ -2725,6 +3577,11 @@ void chpl_cache_do_init(void)
 // The implementation of functions in chpl-cache.h
 
 void chpl_cache_init(void) {
+  int i;
+
+  for( i = 0; i < CACHE_DIAG_NUM; i++ ) {
+    atomic_init_uint_least64_t(&cache_diags[i], 0);
+  }
 
   // Take default CHPL_CACHE_REMOTE value from the environment if it is set.
   /*char* p;
@@ -2745,12 +3602,33 @@ void chpl_cache_init(void) {
   }
 
   //printf("CACHE IS ENABLED\n");
+  cache_read_geometry();
   chpl_cache_do_init();
+
+  // Share one cache for GETs between all of the pthreads on this locale?
+  {
+    char* p;
+    if ((p = getenv("CHPL_RT_CACHE_SHARED")) != NULL) {
+      if( p[0] == 'y' || p[0] == 'Y' || p[0] == '1' ) chpl_cache_shared = 1;
+      else if( p[0] == 'n' || p[0] == 'N' || p[0] == '0' ) chpl_cache_shared = 0;
+      else chpl_warning("unknown setting for CHPL_RT_CACHE_SHARED, try 0 or 1", 0, NULL);
+    }
+  }
+
+  if( chpl_cache_shared ) {
+    atomic_init_uint_least64_t(&shared_epoch, 1);
+    shared_cache = shared_cache_create();
+  }
 }
 
 void chpl_cache_exit(void)
 {
   CHPL_TLS_DELETE(cache_remote_data);
+  if( shared_cache ) {
+    shared_cache_destroy(shared_cache);
+    shared_cache = NULL;
+    atomic_destroy_uint_least64_t(&shared_epoch);
+  }
 }
 
 
@@ -2774,11 +3652,21 @@ void chpl_cache_fence(int acquire, int release, int ln, c_string fn)
     if( acquire ) {
       task_local->last_acquire = cache->next_request_number;
       cache->next_request_number++;
+      if( shared_cache ) shared_cache_acquire(task_local);
     }
 
     if( release ) {
       cache_clean_dirty(cache);
+      if( cache->pending_last_entry >= 0 || cache->num_combine_nodes > 0 )
+        cache_diag_add(CACHE_DIAG_FENCE_WAIT, 1);
+      combine_flush_all(cache);
       wait_all(cache);
+      if( shared_cache && task_local->shared_puts ) {
+        // Our PUTs are complete now, so stop using anything that might
+        // have been fetched before they were.
+        shared_cache_acquire(task_local);
+        task_local->shared_puts = 0;
+      }
     }
 #ifdef DUMP
     DEBUG_PRINT(("%d: task %d after fence\n", chpl_nodeID, (int) chpl_task_getId()));
@@ -2806,6 +3694,7 @@ void chpl_cache_comm_put(void* addr, c_nodeid_t node, void* raddr,
 
   //saturating_increment(&info->put_since_release);
   //task_local->last_op = seqn_max(cache, addr, node, raddr, size);
+  if( shared_cache ) task_local->shared_puts = 1;
   cache_put(cache, addr, node, (raddr_t) raddr, size, task_local->last_acquire, ln, fn);
   return;
 }
@@ -2827,6 +3716,11 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
 #endif
 
   //saturating_increment(&info->get_since_acquire);
+  if( shared_cache && ! task_local->shared_puts ) {
+    shared_cache_get(shared_cache, addr, node, (raddr_t) raddr, size,
+                     task_local->shared_acquire, ln, fn);
+    return;
+  }
   cache_get(cache, addr, node, (raddr_t) raddr, size, task_local->last_acquire, 0, ln, fn);
   return;
 }
@@ -2841,6 +3735,9 @@ void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
   TRACE_PRINT(("%d: in chpl_cache_comm_prefetch\n", chpl_nodeID));
   if (chpl_verbose_comm)
     printf("%d: %s:%d: remote prefetch from %d\n", chpl_nodeID, fn?fn:"", ln, node);
+  // Shared cache pages are filled with blocking GETs, so there is
+  // nothing to overlap a prefetch with.
+  if( shared_cache && ! task_local->shared_puts ) return;
   // Always use the cache for prefetches.
   //saturating_increment(&info->prefetch_since_acquire);
   cache_get(cache, NULL, node, (raddr_t) raddr, size, task_local->last_acquire, 0, ln, fn);
@@ -2906,6 +3803,85 @@ void chpl_cache_set_enabled(int enabled)
 }
 */
 
+void chpl_resetCacheDiagnosticsHere(void)
+{
+  int i;
+  for( i = 0; i < CACHE_DIAG_NUM; i++ ) {
+    atomic_store_uint_least64_t(&cache_diags[i], 0);
+  }
+}
+
+uint64_t chpl_numCacheHits(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_HIT]);
+}
+
+uint64_t chpl_numCacheMisses(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_MISS]);
+}
+
+uint64_t chpl_numCacheReadaheadHits(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_READAHEAD_HIT]);
+}
+
+uint64_t chpl_numCacheReadaheadUnused(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_READAHEAD_UNUSED]);
+}
+
+uint64_t chpl_numCacheAinEvicts(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_AIN_EVICT]);
+}
+
+uint64_t chpl_numCacheAoutEvicts(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_AOUT_EVICT]);
+}
+
+uint64_t chpl_numCacheAmEvicts(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_AM_EVICT]);
+}
+
+uint64_t chpl_numCacheDirtyFlushes(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_DIRTY_FLUSH]);
+}
+
+uint64_t chpl_numCacheCombinedPuts(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_COMBINED_PUT]);
+}
+
+uint64_t chpl_numCacheCombinedFlushes(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_COMBINED_FLUSH]);
+}
+
+uint64_t chpl_numCacheFenceWaits(void)
+{
+  return atomic_load_uint_least64_t(&cache_diags[CACHE_DIAG_FENCE_WAIT]);
+}
+
+#else
+// The cache is not available with this comm layer.
+
+void chpl_resetCacheDiagnosticsHere(void) { }
+uint64_t chpl_numCacheHits(void) { return 0; }
+uint64_t chpl_numCacheMisses(void) { return 0; }
+uint64_t chpl_numCacheReadaheadHits(void) { return 0; }
+uint64_t chpl_numCacheReadaheadUnused(void) { return 0; }
+uint64_t chpl_numCacheAinEvicts(void) { return 0; }
+uint64_t chpl_numCacheAoutEvicts(void) { return 0; }
+uint64_t chpl_numCacheAmEvicts(void) { return 0; }
+uint64_t chpl_numCacheDirtyFlushes(void) { return 0; }
+uint64_t chpl_numCacheCombinedPuts(void) { return 0; }
+uint64_t chpl_numCacheCombinedFlushes(void) { return 0; }
+uint64_t chpl_numCacheFenceWaits(void) { return 0; }
+
 #endif
 // end ifdef HAS_CHPL_CACHE_FNS
 
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Aggregation of small remote operations; see chpl-comm-agg.h. This
+// part is shared by the comm layers, which only have to send, run and
+// acknowledge messages.
+//
+#include "chplrt.h"
+#include "chpl-comm.h"
+#include "chpl-comm-agg.h"
+#include "chpl-mem.h"
+#include "chplcgfns.h"
+#include "chpl-gen-includes.h"
+#include "chpl-atomics.h"
+#include "chpltimers.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_AGG_BUFFER_SIZE 8192
+#define MIN_AGG_BUFFER_SIZE 256
+#define MAX_AGG_BUFFER_SIZE (16*1024*1024)
+#define DEFAULT_AGG_TIMEOUT_US 1000
+
+// How many operations to add between checks for buffers that have
+// waited too long. Reading the clock on every operation would cost
+// more than the operation itself.
+#define AGG_TIMEOUT_CHECK_INTERVAL 64
+
+// Bytes of records per buffer; set with CHPL_RT_COMM_AGG_BUFFER_SIZE.
+static size_t agg_buffer_size = DEFAULT_AGG_BUFFER_SIZE;
+
+// Seconds a buffer may wait; set with CHPL_RT_COMM_AGG_TIMEOUT (in
+// microseconds). 0 disables the check.
+static double agg_timeout = DEFAULT_AGG_TIMEOUT_US / 1e6;
+
+typedef struct {
+  unsigned char* msg;  // CHPL_COMM_AGG_MSG_HEADER + agg_buffer_size bytes
+  size_t         len;  // bytes of records after the header
+  uint64_t       nops;
+  int            in_task;
+  int            active;     // in the aggregator's active list
+  double         first_time; // when the first record was added
+} agg_dest_t;
+
+struct chpl_comm_agg_s {
+  agg_dest_t*           dests;    // one per node, allocated as needed
+  c_nodeid_t*           active;   // nodes with nonempty buffers
+  int32_t               nactive;
+  int32_t               adds_since_check;
+  uint64_t              sent;
+  atomic_uint_least64_t acked;
+};
+
+typedef enum {
+  AGG_SEND_FULL,
+  AGG_SEND_TIMEOUT,
+  AGG_SEND_FLUSH
+} agg_send_reason_t;
+
+static atomic_uint_least64_t agg_diag_ops;
+static atomic_uint_least64_t agg_diag_local_ops;
+static atomic_uint_least64_t agg_diag_msgs;
+static atomic_uint_least64_t agg_diag_full;
+static atomic_uint_least64_t agg_diag_timeout;
+static atomic_uint_least64_t agg_diag_flushes;
+
+static inline
+void agg_count(atomic_uint_least64_t* counter, uint64_t n)
+{
+  if (chpl_comm_diagnostics)
+    atomic_fetch_add_uint_least64_t(counter, n);
+}
+
+// Read an integer setting from the environment. Returns the default if
+// the variable is not set or is out of range.
+static
+long agg_getenv_long(const char* name, long def, long min, long max)
+{
+  char* p;
+  char* end;
+  long v;
+
+  if ((p = getenv(name)) == NULL)
+    return def;
+
+  v = strtol(p, &end, 10);
+  if (end == p || *end != '\0' || v < min || v > max) {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "unknown setting for %s, try a value in %ld..%ld",
+             name, min, max);
+    chpl_warning(msg, 0, NULL);
+    return def;
+  }
+
+  return v;
+}
+
+void chpl_comm_agg_init(void)
+{
+  size_t max_records;
+  long v;
+
+  v = agg_getenv_long("CHPL_RT_COMM_AGG_BUFFER_SIZE",
+                      DEFAULT_AGG_BUFFER_SIZE,
+                      MIN_AGG_BUFFER_SIZE, MAX_AGG_BUFFER_SIZE);
+  max_records = chpl_comm_agg_max_msg() - CHPL_COMM_AGG_MSG_HEADER;
+  if ((size_t) v > max_records)
+    v = max_records;
+  agg_buffer_size = v;
+
+  v = agg_getenv_long("CHPL_RT_COMM_AGG_TIMEOUT",
+                      DEFAULT_AGG_TIMEOUT_US, 0, 1000000000L);
+  agg_timeout = v / 1e6;
+
+  chpl_resetCommAggDiagnosticsHere();
+}
+
+chpl_comm_agg_t* chpl_comm_agg_create(void)
+{
+  chpl_comm_agg_t* agg;
+
+  agg = (chpl_comm_agg_t*) chpl_mem_calloc(sizeof(chpl_comm_agg_t),
+                                           CHPL_RT_MD_COMM_AGG, 0, 0);
+  agg->dests = (agg_dest_t*) chpl_mem_allocManyZero(chpl_numNodes,
+                                                    sizeof(agg_dest_t),
+                                                    CHPL_RT_MD_COMM_AGG,
+                                                    0, 0);
+  agg->active = (c_nodeid_t*) chpl_mem_allocMany(chpl_numNodes,
+                                                 sizeof(c_nodeid_t),
+                                                 CHPL_RT_MD_COMM_AGG, 0, 0);
+  atomic_init_uint_least64_t(&agg->acked, 0);
+  return agg;
+}
+
+void chpl_comm_agg_destroy(chpl_comm_agg_t* agg)
+{
+  int32_t i;
+
+  if (agg == NULL)
+    return;
+
+  chpl_comm_agg_flush(agg);
+
+  for (i = 0; i < chpl_numNodes; i++) {
+    if (agg->dests[i].msg)
+      chpl_mem_free(agg->dests[i].msg, 0, 0);
+  }
+  atomic_destroy_uint_least64_t(&agg->acked);
+  chpl_mem_free(agg->active, 0, 0);
+  chpl_mem_free(agg->dests, 0, 0);
+  chpl_mem_free(agg, 0, 0);
+}
+
+// Send node's buffer, leaving it empty. It stays in agg->active; the
+// caller removes it if needed.
+static
+void agg_send(chpl_comm_agg_t* agg, c_nodeid_t node, agg_send_reason_t why)
+{
+  agg_dest_t* d = &agg->dests[node];
+
+  if (d->len == 0)
+    return;
+
+  agg->sent++;
+  chpl_comm_agg_send(node, d->msg, CHPL_COMM_AGG_MSG_HEADER + d->len,
+                     d->in_task, agg);
+
+  agg_count(&agg_diag_ops, d->nops);
+  agg_count(&agg_diag_msgs, 1);
+  if (why == AGG_SEND_FULL)
+    agg_count(&agg_diag_full, 1);
+  else if (why == AGG_SEND_TIMEOUT)
+    agg_count(&agg_diag_timeout, 1);
+
+  d->len = 0;
+  d->nops = 0;
+  d->in_task = 0;
+}
+
+// Send any buffers that have waited longer than agg_timeout.
+static
+void agg_check_timeouts(chpl_comm_agg_t* agg)
+{
+  double now = chpl_now_time();
+  int32_t i = 0;
+
+  while (i < agg->nactive) {
+    c_nodeid_t node = agg->active[i];
+    if (now - agg->dests[node].first_time > agg_timeout) {
+      agg_send(agg, node, AGG_SEND_TIMEOUT);
+      agg->dests[node].active = 0;
+      agg->active[i] = agg->active[--agg->nactive];
+    } else {
+      i++;
+    }
+  }
+}
+
+// Return space for a record of rsize bytes in node's buffer, sending
+// the buffer first if the record doesn't fit.
+static
+unsigned char* agg_reserve(chpl_comm_agg_t* agg, c_nodeid_t node,
+                           size_t rsize)
+{
+  agg_dest_t* d = &agg->dests[node];
+  unsigned char* ret;
+
+  if (agg_timeout > 0 &&
+      ++agg->adds_since_check >= AGG_TIMEOUT_CHECK_INTERVAL) {
+    agg->adds_since_check = 0;
+    agg_check_timeouts(agg);
+  }
+
+  if (d->msg == NULL) {
+    d->msg = (unsigned char*) chpl_mem_allocMany(1,
+                                                 CHPL_COMM_AGG_MSG_HEADER +
+                                                 agg_buffer_size,
+                                                 CHPL_RT_MD_COMM_AGG_BUFFER,
+                                                 0, 0);
+  }
+
+  if (d->len + rsize > agg_buffer_size)
+    agg_send(agg, node, AGG_SEND_FULL);
+
+  if (d->len == 0) {
+    if (!d->active) {
+      d->active = 1;
+      agg->active[agg->nactive++] = node;
+    }
+    if (agg_timeout > 0)
+      d->first_time = chpl_now_time();
+  }
+
+  ret = d->msg + CHPL_COMM_AGG_MSG_HEADER + d->len;
+  d->len += rsize;
+  d->nops++;
+
+  return ret;
+}
+
+static inline
+void agg_apply_atomic(uint32_t op, chpl_comm_agg_atomic_t* a)
+{
+  atomic_int_least64_t* p64 = (atomic_int_least64_t*) (intptr_t) a->raddr;
+  atomic_int_least32_t* p32 = (atomic_int_least32_t*) (intptr_t) a->raddr;
+  int_least64_t v64 = (int_least64_t) a->operand;
+  int_least32_t v32 = (int_least32_t) a->operand;
+
+  switch ((chpl_comm_agg_op_t) op) {
+    case CHPL_COMM_AGG_ADD_64:
+      atomic_fetch_add_int_least64_t(p64, v64);
+      break;
+    case CHPL_COMM_AGG_OR_64:
+      atomic_fetch_or_int_least64_t(p64, v64);
+      break;
+    case CHPL_COMM_AGG_AND_64:
+      atomic_fetch_and_int_least64_t(p64, v64);
+      break;
+    case CHPL_COMM_AGG_XOR_64:
+      atomic_fetch_xor_int_least64_t(p64, v64);
+      break;
+    case CHPL_COMM_AGG_WRITE_64:
+      atomic_store_int_least64_t(p64, v64);
+      break;
+    case CHPL_COMM_AGG_ADD_32:
+      atomic_fetch_add_int_least32_t(p32, v32);
+      break;
+    case CHPL_COMM_AGG_OR_32:
+      atomic_fetch_or_int_least32_t(p32, v32);
+      break;
+    case CHPL_COMM_AGG_AND_32:
+      atomic_fetch_and_int_least32_t(p32, v32);
+      break;
+    case CHPL_COMM_AGG_XOR_32:
+      atomic_fetch_xor_int_least32_t(p32, v32);
+      break;
+    case CHPL_COMM_AGG_WRITE_32:
+      atomic_store_int_least32_t(p32, v32);
+      break;
+    case CHPL_COMM_AGG_NUM_OPS:
+      chpl_internal_error("bad aggregated operation");
+      break;
+  }
+}
+
+void chpl_comm_agg_apply(void* buf, size_t nbytes)
+{
+  unsigned char* cur = (unsigned char*) buf;
+  unsigned char* end = cur + nbytes;
+  chpl_comm_agg_record_t r;
+
+  while (cur < end) {
+    memcpy(&r, cur, sizeof(r));
+    if (r.fn < CHPL_COMM_AGG_NUM_OPS) {
+      chpl_comm_agg_atomic_t a;
+      memcpy(&a, cur + sizeof(r), sizeof(a));
+      agg_apply_atomic(r.fn, &a);
+    } else {
+      chpl_ftable_call((chpl_fn_int_t) (r.fn - CHPL_COMM_AGG_NUM_OPS),
+                       r.arg_size ? cur + sizeof(r) : NULL);
+    }
+    cur += CHPL_COMM_AGG_RECORD_SIZE(r.arg_size);
+  }
+}
+
+void chpl_comm_agg_atomic(chpl_comm_agg_t* agg, c_nodeid_t node,
+                          int32_t op, uint64_t raddr, uint64_t operand)
+{
+  chpl_comm_agg_record_t r;
+  chpl_comm_agg_atomic_t a;
+  unsigned char* p;
+
+  if (op < 0 || op >= CHPL_COMM_AGG_NUM_OPS)
+    chpl_internal_error("bad aggregated operation");
+
+  a.raddr = raddr;
+  a.operand = operand;
+
+  if (node == chpl_nodeID) {
+    agg_count(&agg_diag_local_ops, 1);
+    agg_apply_atomic(op, &a);
+    return;
+  }
+
+  r.fn = op;
+  r.arg_size = sizeof(a);
+  p = agg_reserve(agg, node, CHPL_COMM_AGG_RECORD_SIZE(sizeof(a)));
+  memcpy(p, &r, sizeof(r));
+  memcpy(p + sizeof(r), &a, sizeof(a));
+}
+
+void chpl_comm_agg_call(chpl_comm_agg_t* agg, c_nodeid_t node,
+                        chpl_fn_int_t fid, void* arg, int32_t arg_size)
+{
+  chpl_comm_agg_record_t r;
+  size_t rsize = CHPL_COMM_AGG_RECORD_SIZE(arg_size);
+  unsigned char* p;
+
+  if (node == chpl_nodeID) {
+    agg_count(&agg_diag_local_ops, 1);
+    chpl_ftable_call(fid, arg);
+    return;
+  }
+
+  if (rsize > agg_buffer_size) {
+    chpl_comm_fork(node, c_sublocid_any, fid, arg, arg_size);
+    return;
+  }
+
+  r.fn = CHPL_COMM_AGG_NUM_OPS + fid;
+  r.arg_size = arg_size;
+  p = agg_reserve(agg, node, rsize);
+  memcpy(p, &r, sizeof(r));
+  if (arg_size > 0)
+    memcpy(p + sizeof(r), arg, arg_size);
+  agg->dests[node].in_task = 1;
+}
+
+void chpl_comm_agg_flush(chpl_comm_agg_t* agg)
+{
+  int32_t i;
+
+  for (i = 0; i < agg->nactive; i++) {
+    agg_send(agg, agg->active[i], AGG_SEND_FLUSH);
+    agg->dests[agg->active[i]].active = 0;
+  }
+  agg->nactive = 0;
+  agg->adds_since_check = 0;
+
+  if (chpl_comm_agg_pending(agg) > 0)
+    chpl_comm_agg_wait(agg);
+
+  agg_count(&agg_diag_flushes, 1);
+}
+
+void chpl_comm_agg_acked(chpl_comm_agg_t* agg)
+{
+  atomic_fetch_add_uint_least64_t(&agg->acked, 1);
+}
+
+uint64_t chpl_comm_agg_pending(chpl_comm_agg_t* agg)
+{
+  return agg->sent - atomic_load_uint_least64_t(&agg->acked);
+}
+
+void chpl_resetCommAggDiagnosticsHere(void)
+{
+  atomic_store_uint_least64_t(&agg_diag_ops, 0);
+  atomic_store_uint_least64_t(&agg_diag_local_ops, 0);
+  atomic_store_uint_least64_t(&agg_diag_msgs, 0);
+  atomic_store_uint_least64_t(&agg_diag_full, 0);
+  atomic_store_uint_least64_t(&agg_diag_timeout, 0);
+  atomic_store_uint_least64_t(&agg_diag_flushes, 0);
+}
+
+uint64_t chpl_numCommAggOps(void)
+{
+  return atomic_load_uint_least64_t(&agg_diag_ops);
+}
+
+uint64_t chpl_numCommAggLocalOps(void)
+{
+  return atomic_load_uint_least64_t(&agg_diag_local_ops);
+}
+
+uint64_t chpl_numCommAggMsgs(void)
+{
+  return atomic_load_uint_least64_t(&agg_diag_msgs);
+}
+
+uint64_t chpl_numCommAggFullSends(void)
+{
+  return atomic_load_uint_least64_t(&agg_diag_full);
+}
+
+uint64_t chpl_numCommAggTimeoutSends(void)
+{
+  return atomic_load_uint_least64_t(&agg_diag_timeout);
+}
+
+uint64_t chpl_numCommAggFlushes(void)
+{
+  return atomic_load_uint_least64_t(&agg_diag_flushes);
+}
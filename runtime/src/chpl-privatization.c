@@ -19,49 +19,58 @@
 
 #include "chplrt.h"
 #include "chpl-privatization.h"
+#include "chpl-atomics.h"
 #include "chpl-mem.h"
 #include "chpl-tasks.h"
+#include "error.h"
 
-static int64_t chpl_capPrivateObjects = 0;
-static chpl_sync_aux_t privatizationSync;
+atomic_uintptr_t chpl_privateObjectChunks[CHPL_PRIVATIZATION_MAX_CHUNKS];
 
-void** chpl_privateObjects;
+// Held while adding a chunk.
+static chpl_sync_aux_t chunksSync;
 
 void chpl_privatization_init(void) {
-    chpl_sync_initAux(&privatizationSync);
+  int i;
+
+  for (i = 0; i < CHPL_PRIVATIZATION_MAX_CHUNKS; i++)
+    atomic_init_uintptr_t(&chpl_privateObjectChunks[i], (uintptr_t) NULL);
+  chpl_sync_initAux(&chunksSync);
 }
 
-void chpl_newPrivatizedClass(void* v, int64_t pid) {
-  // We need to lock around this operation so two calls in rapid succession
-  // that pass the chpl_capPrivateObjects limit don't both try to create a new
-  // array. If they do, one of the calls will be leaked and an invalid pointer
-  // to be placed in the table.
-  chpl_sync_lock(&privatizationSync);
+//
+// Return the given chunk, adding it if need be.  Only adding a chunk
+// takes chunksSync; once added, a chunk never changes.
+//
+static void** getChunk(int chunk) {
+  void** c;
 
-  pid += 1;
-  if (pid == 1) {
-    chpl_capPrivateObjects = 8;
+  c = (void**) atomic_load_explicit_uintptr_t(&chpl_privateObjectChunks[chunk],
+                                              memory_order_acquire);
+  if (c != NULL)
+    return c;
+
+  chpl_sync_lock(&chunksSync);
+  c = (void**) atomic_load_explicit_uintptr_t(&chpl_privateObjectChunks[chunk],
+                                              memory_order_relaxed);
+  if (c == NULL) {
+    size_t n = ((size_t) CHPL_PRIVATIZATION_CHUNK0) << chunk;
     // "private" means "node-private", so we can use the system allocator.
-    chpl_privateObjects = chpl_mem_allocMany(chpl_capPrivateObjects, sizeof(void*), CHPL_RT_MD_COMM_PRIVATE_OBJECTS_ARRAY, 0, "");
-  } else {
-    if (pid > chpl_capPrivateObjects) {
-      void** tmp;
-      chpl_capPrivateObjects *= 2;
-      tmp = chpl_mem_allocMany(chpl_capPrivateObjects, sizeof(void*), CHPL_RT_MD_COMM_PRIVATE_OBJECTS_ARRAY, 0, "");
-      chpl_memcpy((void*)tmp, (void*)chpl_privateObjects, (pid-1)*sizeof(void*));
-      chpl_privateObjects = tmp;
-      // purposely leak old copies of chpl_privateObject to avoid the need to
-      // lock chpl_getPrivatizedClass; TODO: fix with lock free data structure
-    }
+    c = chpl_mem_allocManyZero(n, sizeof(void*),
+                               CHPL_RT_MD_COMM_PRIVATE_OBJECTS_ARRAY,
+                               0, "");
+    atomic_store_explicit_uintptr_t(&chpl_privateObjectChunks[chunk],
+                                    (uintptr_t) c, memory_order_release);
   }
-  chpl_privateObjects[pid-1] = v;
+  chpl_sync_unlock(&chunksSync);
 
-  chpl_sync_unlock(&privatizationSync);
+  return c;
 }
 
+void chpl_newPrivatizedClass(void* v, int64_t pid) {
+  int chunk = chpl_privatization_chunk(pid);
 
-extern void* chpl_getPrivatizedClass(int64_t i) {
-  return chpl_privateObjects[i];
-}
-
+  if (chunk >= CHPL_PRIVATIZATION_MAX_CHUNKS)
+    chpl_internal_error("too many privatized objects");
 
+  getChunk(chunk)[chpl_privatization_index(pid, chunk)] = v;
+}
@@ -25,6 +25,7 @@
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
 #include "gdb.h"
+#include "qbuffer.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,6 +41,7 @@ static void chpl_exit_common(int status, int all) {
   chpl_comm_pre_task_exit(all);
   if (all) {
     chpl_task_exit();
+    qbytes_iobuf_pool_exit();
     chpl_reportMemInfo();
   }
   chpl_mem_exit();
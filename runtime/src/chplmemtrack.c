@@ -23,6 +23,7 @@
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
 #include "chpl-tasks.h"
+#include "chpl-atomics.h"
 #include "chpltypes.h"
 #include "chpl-comm.h"
 #include "chplcgfns.h"
@@ -67,16 +68,29 @@ typedef struct memTableEntry_struct { /* table entry */
   struct memTableEntry_struct* nextInBucket;
 } memTableEntry;
 
-#define NUM_HASH_SIZE_INDICES 20
-
-static int hashSizes[NUM_HASH_SIZE_INDICES] = { 1543, 3079, 6151, 12289, 24593, 49157, 98317,
-                                                196613, 393241, 786433, 1572869, 3145739,
-                                                6291469, 12582917, 25165843, 50331653,
-                                                100663319, 201326611, 402653189, 805306457 };
-static int hashSizeIndex = 0;
-static int hashSize = 0;
-
-static memTableEntry** memTable = NULL;
+//
+// The table is split into shards by address, each with its own lock,
+// so that tasks allocating and freeing at the same time rarely wait
+// for each other.  (Memory is often freed by a different thread than
+// the one that allocated it, so the shards can't be per thread.)
+// Each shard is a chained hash table whose size is a power of 2, and
+// keeps a free list of entries that it allocates in blocks.
+//
+#define NUM_SHARDS_LOG2 6
+#define NUM_SHARDS (1 << NUM_SHARDS_LOG2)
+#define MIN_SHARD_SIZE_LOG2 8
+#define MAX_SHARD_SIZE_LOG2 30
+#define ENTRY_BLOCK_SIZE 256
+
+typedef struct {
+  chpl_sync_aux_t lock;
+  memTableEntry** buckets;
+  int sizeLog2;
+  size_t numEntries;
+  memTableEntry* freeEntries;
+} memTableShard;
+
+static memTableShard memTable[NUM_SHARDS];
 
 static _Bool memLeaks = false;
 static _Bool memLeaksTable = false;
@@ -87,13 +101,25 @@ static c_string memLog = "";
 static FILE* memLogFile = NULL;
 static c_string memLeaksLog = "";
 
-static size_t totalMem = 0;       /* total memory currently allocated */
-static size_t maxMem = 0;         /* maximum total memory during run  */
-static size_t totalAllocated = 0; /* total memory allocated */
-static size_t totalFreed = 0;     /* total memory freed */
-static size_t totalEntries = 0;     /* number of entries in hash table */
+static atomic_uint_least64_t totalMem;       /* total memory currently allocated */
+static atomic_uint_least64_t maxMem;         /* maximum total memory during run  */
+static atomic_uint_least64_t totalAllocated; /* total memory allocated */
+static atomic_uint_least64_t totalFreed;     /* total memory freed */
+
+//
+// Other nodes read our counters with GETs in chpl_printMemStat().  The
+// atomics can be bigger than their values (with CHPL_ATOMICS=locks
+// they include a lock), so they read this copy, which we take in
+// chpl_snapshotMemStat() first.
+//
+typedef struct {
+  uint64_t totalMem;
+  uint64_t maxMem;
+  uint64_t totalAllocated;
+  uint64_t totalFreed;
+} memStat_t;
 
-static chpl_sync_aux_t memTrack_sync;
+static memStat_t memStatSnapshot;
 
 
 void chpl_setMemFlags(void) {
@@ -145,130 +171,189 @@ void chpl_setMemFlags(void) {
     }
   }
 
+  atomic_init_uint_least64_t(&totalMem, 0);
+  atomic_init_uint_least64_t(&maxMem, 0);
+  atomic_init_uint_least64_t(&totalAllocated, 0);
+  atomic_init_uint_least64_t(&totalFreed, 0);
+
   if (chpl_memTrack) {
-    chpl_sync_initAux(&memTrack_sync);
-    hashSizeIndex = 0;
-    hashSize = hashSizes[hashSizeIndex];
-    memTable = calloc(hashSize, sizeof(memTableEntry*));
+    int i;
+    for (i = 0; i < NUM_SHARDS; i++) {
+      chpl_sync_initAux(&memTable[i].lock);
+      memTable[i].sizeLog2 = MIN_SHARD_SIZE_LOG2;
+      memTable[i].buckets = calloc(1 << MIN_SHARD_SIZE_LOG2,
+                                   sizeof(memTableEntry*));
+      memTable[i].numEntries = 0;
+      memTable[i].freeEntries = NULL;
+    }
   }
 }
 
 
-static unsigned hash(void* memAlloc, int hashSize) {
-  unsigned hashValue = 0;
-  char* fakeCharPtr = (char*)&memAlloc;
-  size_t i;
-  for (i = 0; i < sizeof(void*); i++) {
-    hashValue = *fakeCharPtr + 31 * hashValue;
-    fakeCharPtr++;
-  }
-  return hashValue % hashSize;
+//
+// Multiplicative (Fibonacci) hash of an address.  The top bits pick
+// the shard and the bits below them pick the bucket in the shard.
+//
+static inline uint64_t hash(void* memAlloc) {
+  uint64_t p = (uint64_t) (uintptr_t) memAlloc;
+  return (p ^ (p >> 17)) * UINT64_C(0x9E3779B97F4A7C15);
+}
+
+static inline memTableShard* hashShard(uint64_t h) {
+  return &memTable[h >> (64 - NUM_SHARDS_LOG2)];
+}
+
+static inline size_t hashBucket(uint64_t h, int sizeLog2) {
+  return (size_t) ((h << NUM_SHARDS_LOG2) >> (64 - sizeLog2));
 }
 
 
 static void increaseMemStat(size_t chunk, int32_t lineno, c_string filename) {
-  totalMem += chunk;
-  totalAllocated += chunk;
-  if (memMax && (totalMem > memMax)) {
+  uint64_t mem = atomic_fetch_add_uint_least64_t(&totalMem, chunk) + chunk;
+  uint64_t max = atomic_load_uint_least64_t(&maxMem);
+
+  atomic_fetch_add_uint_least64_t(&totalAllocated, chunk);
+  if (memMax && (mem > memMax)) {
     chpl_error("Exceeded memory limit", lineno, filename);
   }
-  if (totalMem > maxMem)
-    maxMem = totalMem;
+  while (mem > max &&
+         !atomic_compare_exchange_weak_uint_least64_t(&maxMem, max, mem))
+    max = atomic_load_uint_least64_t(&maxMem);
 }
 
 
 static void decreaseMemStat(size_t chunk) {
-  totalMem -= chunk; // > totalMem ? 0 : totalMem - chunk;
-  totalFreed += chunk;
+  atomic_fetch_sub_uint_least64_t(&totalMem, chunk);
+  atomic_fetch_add_uint_least64_t(&totalFreed, chunk);
 }
 
 
 static void
-resizeTable(int direction) {
-  memTableEntry** newMemTable = NULL;
-  int newHashSizeIndex, newHashSize, newHashValue;
-  int i;
+resizeShard(memTableShard* shard, int direction) {
+  memTableEntry** newBuckets = NULL;
+  int newSizeLog2 = shard->sizeLog2 + direction;
+  size_t i;
   memTableEntry* me;
   memTableEntry* next;
 
-  newHashSizeIndex = hashSizeIndex + direction;
-  newHashSize = hashSizes[newHashSizeIndex];
-  newMemTable = calloc(newHashSize, sizeof(memTableEntry*));
+  newBuckets = calloc((size_t) 1 << newSizeLog2, sizeof(memTableEntry*));
+  if (!newBuckets)
+    return; // keep using the old size
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = next) {
+  for (i = 0; i < ((size_t) 1 << shard->sizeLog2); i++) {
+    for (me = shard->buckets[i]; me != NULL; me = next) {
+      size_t b = hashBucket(hash(me->memAlloc), newSizeLog2);
       next = me->nextInBucket;
-      newHashValue = hash(me->memAlloc, newHashSize);
-      me->nextInBucket = newMemTable[newHashValue];
-      newMemTable[newHashValue] = me;
+      me->nextInBucket = newBuckets[b];
+      newBuckets[b] = me;
     }
   }
 
-  free(memTable);
-  memTable = newMemTable;
-  hashSize = newHashSize;
-  hashSizeIndex = newHashSizeIndex;
+  free(shard->buckets);
+  shard->buckets = newBuckets;
+  shard->sizeLog2 = newSizeLog2;
+}
+
+
+static memTableEntry* allocMemTableEntry(memTableShard* shard) {
+  memTableEntry* me;
+
+  if (shard->freeEntries == NULL) {
+    // Entries are never given back to the system; freed ones are reused.
+    memTableEntry* block = calloc(ENTRY_BLOCK_SIZE, sizeof(memTableEntry));
+    int i;
+    if (!block)
+      return NULL;
+    for (i = 0; i < ENTRY_BLOCK_SIZE; i++) {
+      block[i].nextInBucket = shard->freeEntries;
+      shard->freeEntries = &block[i];
+    }
+  }
+
+  me = shard->freeEntries;
+  shard->freeEntries = me->nextInBucket;
+  return me;
+}
+
+
+static void freeMemTableEntry(memTableShard* shard, memTableEntry* me) {
+  me->nextInBucket = shard->freeEntries;
+  shard->freeEntries = me;
 }
 
 
 static void addMemTableEntry(void* memAlloc, size_t number, size_t size, chpl_mem_descInt_t description, int32_t lineno, c_string filename) {
-  unsigned hashValue;
+  uint64_t h = hash(memAlloc);
+  memTableShard* shard = hashShard(h);
   memTableEntry* memEntry;
+  size_t b;
+
+  chpl_sync_lock(&shard->lock);
 
-  if ((totalEntries+1)*2 > hashSize && hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
-    resizeTable(1);
+  if ((shard->numEntries+1)*2 > ((size_t) 1 << shard->sizeLog2) &&
+      shard->sizeLog2 < MAX_SHARD_SIZE_LOG2)
+    resizeShard(shard, 1);
 
-  memEntry = (memTableEntry*) calloc(1, sizeof(memTableEntry));
+  memEntry = allocMemTableEntry(shard);
   if (!memEntry) {
+    chpl_sync_unlock(&shard->lock);
     chpl_error("memtrack fault: out of memory allocating memtrack table",
                lineno, filename);
   }
 
-  hashValue = hash(memAlloc, hashSize);
-  memEntry->nextInBucket = memTable[hashValue];
-  memTable[hashValue] = memEntry;
+  b = hashBucket(h, shard->sizeLog2);
+  memEntry->nextInBucket = shard->buckets[b];
+  shard->buckets[b] = memEntry;
   memEntry->description = description;
   memEntry->memAlloc = memAlloc;
   memEntry->lineno = lineno;
   memEntry->filename = filename; // do we want to copy this string?
   memEntry->number = number;
   memEntry->size = size;
-  increaseMemStat(number*size, lineno, filename);
-  totalEntries += 1;
-}
+  shard->numEntries += 1;
 
+  chpl_sync_unlock(&shard->lock);
 
-static memTableEntry* removeMemTableEntry(void* address) {
-  unsigned hashValue = hash(address, hashSize);
-  memTableEntry* thisBucketEntry = memTable[hashValue];
-  memTableEntry* deletedBucket = NULL;
+  increaseMemStat(number*size, lineno, filename);
+}
 
-  if (!thisBucketEntry)
-    return NULL;
 
-  if (thisBucketEntry->memAlloc == address) {
-    memTable[hashValue] = thisBucketEntry->nextInBucket;
-    deletedBucket = thisBucketEntry;
-  } else {
-    for (thisBucketEntry = memTable[hashValue];
-         thisBucketEntry != NULL;
-         thisBucketEntry = thisBucketEntry->nextInBucket) {
+//
+// Remove the entry for address, if there is one.  If found is not
+// NULL, copy the entry to it.  Returns whether there was an entry.
+//
+static _Bool removeMemTableEntry(void* address, memTableEntry* found) {
+  uint64_t h = hash(address);
+  memTableShard* shard = hashShard(h);
+  memTableEntry** prev;
+  memTableEntry* me;
+  size_t chunk = 0;
 
-      memTableEntry* nextBucketEntry = thisBucketEntry->nextInBucket;
+  chpl_sync_lock(&shard->lock);
 
-      if (nextBucketEntry && nextBucketEntry->memAlloc == address) {
-        thisBucketEntry->nextInBucket = nextBucketEntry->nextInBucket;
-        deletedBucket = nextBucketEntry;
-      }
-    }
+  prev = &shard->buckets[hashBucket(h, shard->sizeLog2)];
+  for (me = *prev; me != NULL; prev = &me->nextInBucket, me = *prev) {
+    if (me->memAlloc == address)
+      break;
   }
-  if (deletedBucket) {
-    decreaseMemStat(deletedBucket->number * deletedBucket->size);
-    totalEntries -= 1;
-    if (totalEntries*8 < hashSize && hashSizeIndex > 0)
-      resizeTable(-1);
+
+  if (me) {
+    *prev = me->nextInBucket;
+    chunk = me->number * me->size;
+    if (found)
+      *found = *me;
+    freeMemTableEntry(shard, me);
+    shard->numEntries -= 1;
+    if (shard->numEntries*8 < ((size_t) 1 << shard->sizeLog2) &&
+        shard->sizeLog2 > MIN_SHARD_SIZE_LOG2)
+      resizeShard(shard, -1);
   }
-  return deletedBucket;
+
+  chpl_sync_unlock(&shard->lock);
+
+  if (me)
+    decreaseMemStat(chunk);
+  return me != NULL;
 }
 
 
@@ -276,7 +361,15 @@ uint64_t chpl_memoryUsed(int32_t lineno, c_string filename) {
   if (!chpl_memTrack)
     chpl_error("invalid call to memoryUsed(); rerun with --memTrack",
                lineno, filename);
-  return (uint64_t)totalMem;
+  return atomic_load_uint_least64_t(&totalMem);
+}
+
+
+void chpl_snapshotMemStat(void) {
+  memStatSnapshot.totalMem = atomic_load_uint_least64_t(&totalMem);
+  memStatSnapshot.maxMem = atomic_load_uint_least64_t(&maxMem);
+  memStatSnapshot.totalAllocated = atomic_load_uint_least64_t(&totalAllocated);
+  memStatSnapshot.totalFreed = atomic_load_uint_least64_t(&totalFreed);
 }
 
 
@@ -284,15 +377,14 @@ void chpl_printMemStat(int32_t lineno, c_string filename) {
   if (!chpl_memTrack)
     chpl_error("invalid call to printMemStat(); rerun with --memTrack",
                lineno, filename);
-  chpl_sync_lock(&memTrack_sync);
   fprintf(memLogFile, "=================\n");
   fprintf(memLogFile, "Memory Statistics\n");
   if (chpl_numNodes == 1) {
     fprintf(memLogFile, "==============================================================\n");
-    fprintf(memLogFile, "Current Allocated Memory               %zd\n", totalMem);
-    fprintf(memLogFile, "Maximum Simultaneous Allocated Memory  %zd\n", maxMem);
-    fprintf(memLogFile, "Total Allocated Memory                 %zd\n", totalAllocated);
-    fprintf(memLogFile, "Total Freed Memory                     %zd\n", totalFreed);
+    fprintf(memLogFile, "Current Allocated Memory               %zd\n", (size_t) atomic_load_uint_least64_t(&totalMem));
+    fprintf(memLogFile, "Maximum Simultaneous Allocated Memory  %zd\n", (size_t) atomic_load_uint_least64_t(&maxMem));
+    fprintf(memLogFile, "Total Allocated Memory                 %zd\n", (size_t) atomic_load_uint_least64_t(&totalAllocated));
+    fprintf(memLogFile, "Total Freed Memory                     %zd\n", (size_t) atomic_load_uint_least64_t(&totalFreed));
     fprintf(memLogFile, "==============================================================\n");
   } else {
     int i;
@@ -304,16 +396,12 @@ void chpl_printMemStat(int32_t lineno, c_string filename) {
     fprintf(memLogFile, "                                            Total Freed Memory\n");
     fprintf(memLogFile, "==============================================================\n");
     for (i = 0; i < chpl_numNodes; i++) {
-      static size_t m1, m2, m3, m4;
-      chpl_gen_comm_get(&m1, i, &totalMem, sizeof(size_t), -1 /* broke for hetero */, 1, lineno, filename);
-      chpl_gen_comm_get(&m2, i, &maxMem, sizeof(size_t), -1 /* broke for hetero */, 1, lineno, filename);
-      chpl_gen_comm_get(&m3, i, &totalAllocated,  sizeof(size_t), -1 /* broke for hetero */, 1, lineno, filename);
-      chpl_gen_comm_get(&m4, i, &totalFreed, sizeof(size_t), -1 /*broke for hetero */, 1, lineno, filename);
-      fprintf(memLogFile, "%-9d  %-9zu  %-9zu  %-9zu  %-9zu\n", i, m1, m2, m3, m4);
+      memStat_t m;
+      chpl_gen_comm_get(&m, i, &memStatSnapshot, sizeof(m), -1 /* broke for hetero */, 1, lineno, filename);
+      fprintf(memLogFile, "%-9d  %-9" PRIu64 "  %-9" PRIu64 "  %-9" PRIu64 "  %-9" PRIu64 "\n", i, m.totalMem, m.maxMem, m.totalAllocated, m.totalFreed);
     }
     fprintf(memLogFile, "==============================================================\n");
   }
-  chpl_sync_unlock(&memTrack_sync);
 }
 
 
@@ -325,16 +413,19 @@ void chpl_printLeakedMemTable(void) {
   size_t* table;
   memTableEntry* me;
   int i;
+  size_t b;
   const int numberWidth   = 9;
   const int numEntries = CHPL_RT_MD_NUM+chpl_mem_numDescs;
 
   table = (size_t*)calloc(numEntries, 3*sizeof(size_t));
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = me->nextInBucket) {
-      table[3*me->description] += me->number*me->size;
-      table[3*me->description+1] += 1;
-      table[3*me->description+2] = me->description;
+  for (i = 0; i < NUM_SHARDS; i++) {
+    for (b = 0; memTable[i].buckets && b < ((size_t) 1 << memTable[i].sizeLog2); b++) {
+      for (me = memTable[i].buckets[b]; me != NULL; me = me->nextInBucket) {
+        table[3*me->description] += me->number*me->size;
+        table[3*me->description+1] += 1;
+        table[3*me->description+2] = me->description;
+      }
     }
   }
 
@@ -362,6 +453,13 @@ void chpl_printLeakedMemTable(void) {
 
 
 void chpl_reportMemInfo() {
+  // Every node gets here at exit, so each one can publish its counters
+  // for the others to read.
+  if (chpl_numNodes > 1
+      && (memStats || (memLeaksLog && strcmp(memLeaksLog, "")))) {
+    chpl_snapshotMemStat();
+    chpl_comm_barrier("memStat snapshot");
+  }
   if (memStats) {
     fprintf(memLogFile, "\n");
     chpl_printMemStat(0, 0);
@@ -411,6 +509,7 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
 
   memTableEntry* memEntry;
   int n, i;
+  size_t b;
   char* loc;
   memTableEntry** table;
 
@@ -419,15 +518,17 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
 
   n = 0;
   filenameWidth = strlen("Allocated Memory (Bytes)");
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk >= threshold) {
-        n += 1;
-        if (memEntry->filename) {
-          int filenameLength = strlen(memEntry->filename);
-          if (filenameLength > filenameWidth)
-            filenameWidth = filenameLength;
+  for (i = 0; i < NUM_SHARDS; i++) {
+    for (b = 0; memTable[i].buckets && b < ((size_t) 1 << memTable[i].sizeLog2); b++) {
+      for (memEntry = memTable[i].buckets[b]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
+        size_t chunk = memEntry->number * memEntry->size;
+        if (chunk >= threshold) {
+          n += 1;
+          if (memEntry->filename) {
+            int filenameLength = strlen(memEntry->filename);
+            if (filenameLength > filenameWidth)
+              filenameWidth = filenameLength;
+          }
         }
       }
     }
@@ -453,11 +554,13 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
     chpl_error("out of memory printing memory table", lineno, filename);
 
   n = 0;
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk >= threshold) {
-        table[n++] = memEntry;
+  for (i = 0; i < NUM_SHARDS; i++) {
+    for (b = 0; memTable[i].buckets && b < ((size_t) 1 << memTable[i].sizeLog2); b++) {
+      for (memEntry = memTable[i].buckets[b]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
+        size_t chunk = memEntry->number * memEntry->size;
+        if (chunk >= threshold) {
+          table[n++] = memEntry;
+        }
       }
     }
   }
@@ -494,9 +597,7 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
                        int32_t lineno, c_string filename) {
   if (number * size > memThreshold) {
     if (chpl_memTrack) {
-      chpl_sync_lock(&memTrack_sync);
       addMemTableEntry(memAlloc, number, size, description, lineno, filename);
-      chpl_sync_unlock(&memTrack_sync);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile,
@@ -510,23 +611,19 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
 
 
 void chpl_track_free(void* memAlloc, int32_t lineno, c_string filename) {
-  memTableEntry* memEntry = NULL;
+  memTableEntry memEntry;
   if (chpl_memTrack) {
-    chpl_sync_lock(&memTrack_sync);
-    memEntry = removeMemTableEntry(memAlloc);
-    if (memEntry) {
+    if (removeMemTableEntry(memAlloc, &memEntry)) {
       if (chpl_verbose_mem) {
         fprintf(memLogFile,
                 "%" FORMAT_c_nodeid_t ": %s:%" PRId32
                 ": free %zuB of %s at %p\n",
                 chpl_nodeID, (filename ? filename : "--"), lineno,
-                memEntry->number*memEntry->size,
-                chpl_mem_descString(memEntry->description), memAlloc);
+                memEntry.number*memEntry.size,
+                chpl_mem_descString(memEntry.description), memAlloc);
       }
-      free(memEntry);
     }
-    chpl_sync_unlock(&memTrack_sync);
-  } else if (chpl_verbose_mem && !memEntry) {
+  } else if (chpl_verbose_mem) {
     fprintf(memLogFile,
             "%" FORMAT_c_nodeid_t ": %s:%" PRId32 ": free at %p\n",
             chpl_nodeID, (filename ? filename : "--"), lineno, memAlloc);
@@ -537,16 +634,9 @@ void chpl_track_free(void* memAlloc, int32_t lineno, c_string filename) {
 void chpl_track_realloc_pre(void* memAlloc, size_t size,
                          chpl_mem_descInt_t description,
                          int32_t lineno, c_string filename) {
-  memTableEntry* memEntry = NULL;
-
   if (chpl_memTrack && size > memThreshold) {
-    chpl_sync_lock(&memTrack_sync);
-    if (memAlloc) {
-      memEntry = removeMemTableEntry(memAlloc);
-      if (memEntry)
-        free(memEntry);
-    }
-    chpl_sync_unlock(&memTrack_sync);
+    if (memAlloc)
+      removeMemTableEntry(memAlloc, NULL);
   }
 }
 
@@ -557,9 +647,7 @@ void chpl_track_realloc_post(void* moreMemAlloc,
                          int32_t lineno, c_string filename) {
   if (size > memThreshold) {
     if (chpl_memTrack) {
-      chpl_sync_lock(&memTrack_sync);
       addMemTableEntry(moreMemAlloc, 1, size, description, lineno, filename);
-      chpl_sync_unlock(&memTrack_sync);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile,
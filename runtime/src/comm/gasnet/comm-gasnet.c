@@ -24,6 +24,7 @@
 #include "gasnet_coll.h"
 #include "gasnet_tools.h"
 #include "chpl-comm.h"
+#include "chpl-comm-agg.h"
 #include "chpl-mem.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
@@ -143,6 +144,51 @@ typedef struct {
   char  data[0];  // data
 } priv_bcast_large_t;
 
+typedef struct {
+  void*    ack;
+  uint64_t data[0]; // chpl_comm_put_record_t records
+} put_combined_t;
+
+typedef struct {
+  void*    ack;     // chpl_comm_agg_t* on the caller
+  int32_t  caller;
+  int32_t  in_task; // run in a task rather than the handler
+  uint64_t nbytes;  // size of the whole message
+  uint64_t data[0]; // chpl_comm_agg_record_t records
+} agg_msg_t;
+
+//
+// Strided transfers are done as a series of contiguous segments of
+// cnt[0] bytes each.  Segments of at most STRD_PACK_MAX_SEG bytes are
+// packed into medium AMs and copied into place by the receiver, with
+// at most STRD_MSG_WINDOW messages in flight.  Larger segments are
+// done with non-blocking GETs or PUTs, at most STRD_NB_WINDOW at once.
+//
+#define STRD_PACK_MAX_SEG 256
+#define STRD_MSG_WINDOW   16
+#define STRD_NB_WINDOW    64
+
+typedef struct {
+  void*    ack;       // strd_get_t* (GET) or done_t* (PUT) on the caller
+  void*    addr;      // the strided region on the target
+  uint64_t first_seg; // first segment in this message
+  uint64_t nsegs;     // number of segments in this message
+  int32_t  strlvls;
+  int32_t  pad;
+  size_t   data[0];   // strlvls strides and strlvls+1 counts, then the
+                      // packed segments (none in GET requests, and no
+                      // strides or counts in GET replies)
+} strd_msg_t;
+
+// The caller's side of a packed GET.
+typedef struct {
+  unsigned char* addr;
+  size_t*        str;
+  size_t*        cnt;
+  size_t         strlvls;
+  done_t         done;
+} strd_get_t;
+
 //
 // AM functions
 //
@@ -157,6 +203,12 @@ typedef struct {
 #define FREE          136 // free data at addr
 #define EXIT_ANY      137 // free data at addr
 #define BCAST_SEGINFO 138 // broadcast for segment info table
+#define PUT_COMBINED  139 // apply a buffer of small PUTs
+#define AGG           140 // run a buffer of aggregated operations
+#define AGG_ACK       141 // ack of AGG
+#define STRD_GET      142 // pack strided data and reply with it
+#define STRD_GET_REPLY 143 // unpack the reply to STRD_GET
+#define STRD_PUT      144 // unpack packed strided data
 
 static void AM_fork_fast(gasnet_token_t token, void* buf, size_t nbytes) {
   fork_t *f = buf;
@@ -276,10 +328,7 @@ static void AM_fork_nb_large(gasnet_token_t token, void* buf, size_t nbytes) {
                            f->serial_state);
 }
 
-static void AM_signal(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
-  done_t* done = (done_t*) (intptr_t)
-                 (((uint64_t) (uint32_t) a0)
-                  | (((uint64_t) (uint32_t) a1) << 32UL));
+static void signal_done(done_t* done) {
   uint_least32_t prev;
   prev = atomic_fetch_add_explicit_uint_least32_t(&done->count, 1,
                                                   memory_order_seq_cst);
@@ -287,6 +336,13 @@ static void AM_signal(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handl
     done->flag = 1;
 }
 
+static void AM_signal(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
+  done_t* done = (done_t*) (intptr_t)
+                 (((uint64_t) (uint32_t) a0)
+                  | (((uint64_t) (uint32_t) a1) << 32UL));
+  signal_done(done);
+}
+
 static void AM_priv_bcast(gasnet_token_t token, void* buf, size_t nbytes) {
   priv_bcast_t* pbp = buf;
   chpl_memcpy(chpl_private_broadcast_table[pbp->id], pbp->data, pbp->size);
@@ -340,6 +396,126 @@ static void AM_bcast_seginfo(gasnet_token_t token, void *buf, size_t nbytes) {
   bcast_seginfo_done = 1;
 }
 
+static void AM_put_combined(gasnet_token_t token, void* buf, size_t nbytes) {
+  put_combined_t* pc = buf;
+  chpl_comm_apply_put_records(pc->data, nbytes - sizeof(put_combined_t));
+
+  // Signal that the handler has completed
+  GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL,
+                                   AckArg0(pc->ack), AckArg1(pc->ack)));
+}
+
+static void agg_wrapper(agg_msg_t* m) {
+  chpl_comm_agg_apply(m->data, m->nbytes - sizeof(agg_msg_t));
+  GASNET_Safe(gasnet_AMRequestShort2(m->caller, AGG_ACK,
+                                     AckArg0(m->ack), AckArg1(m->ack)));
+  chpl_mem_free(m, 0, 0);
+}
+
+static void AM_agg(gasnet_token_t token, void* buf, size_t nbytes) {
+  agg_msg_t* m = buf;
+
+  if (!m->in_task) {
+    // Only built-in operations, which can't block.
+    chpl_comm_agg_apply(m->data, nbytes - sizeof(agg_msg_t));
+    GASNET_Safe(gasnet_AMReplyShort2(token, AGG_ACK,
+                                     AckArg0(m->ack), AckArg1(m->ack)));
+  } else {
+    agg_msg_t* copy = (agg_msg_t*) chpl_mem_allocMany(nbytes, sizeof(char),
+                                                      CHPL_RT_MD_COMM_AGG_RECV,
+                                                      0, 0);
+    chpl_memcpy(copy, buf, nbytes);
+    chpl_task_startMovedTask((chpl_fn_p)agg_wrapper, (void*)copy,
+                             c_sublocid_any, chpl_nullTaskID, false);
+  }
+}
+
+static void AM_agg_ack(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
+  chpl_comm_agg_t* agg = (chpl_comm_agg_t*) (intptr_t)
+                         (((uint64_t) (uint32_t) a0)
+                          | (((uint64_t) (uint32_t) a1) << 32UL));
+  chpl_comm_agg_acked(agg);
+}
+
+//
+// Copy segments [first, first+nsegs) of the strided region at base to
+// (if pack) or from (otherwise) the contiguous buffer buf.  Segments
+// are numbered with level 0 varying fastest.
+//
+static void strd_copy_segs(unsigned char* base, const size_t* str,
+                           const size_t* cnt, size_t strlvls,
+                           uint64_t first, uint64_t nsegs,
+                           unsigned char* buf, int pack) {
+  size_t idx[strlvls > 0 ? strlvls : 1];
+  size_t off = 0;
+  uint64_t n;
+  size_t i;
+
+  for (i = 0; i < strlvls; i++) {
+    idx[i] = first % cnt[i+1];
+    first /= cnt[i+1];
+    off += idx[i] * str[i];
+  }
+
+  for (n = 0; n < nsegs; n++) {
+    if (pack)
+      chpl_memcpy(buf, base + off, cnt[0]);
+    else
+      chpl_memcpy(base + off, buf, cnt[0]);
+    buf += cnt[0];
+
+    for (i = 0; i < strlvls; i++) {
+      off += str[i];
+      if (++idx[i] < cnt[i+1])
+        break;
+      off -= idx[i] * str[i];
+      idx[i] = 0;
+    }
+  }
+}
+
+static void AM_strd_get(gasnet_token_t token, void* buf, size_t nbytes) {
+  strd_msg_t* m = buf;
+  size_t* str = m->data;
+  size_t* cnt = str + m->strlvls;
+  size_t len = sizeof(strd_msg_t) + m->nsegs * cnt[0];
+  strd_msg_t* r;
+
+  r = (strd_msg_t*) chpl_mem_allocMany(1, len, CHPL_RT_MD_COMM_STRD_BUFFER,
+                                       0, 0);
+  r->ack = m->ack;
+  r->addr = NULL;
+  r->first_seg = m->first_seg;
+  r->nsegs = m->nsegs;
+  r->strlvls = 0;
+  strd_copy_segs(m->addr, str, cnt, m->strlvls, m->first_seg, m->nsegs,
+                 (unsigned char*) r->data, 1);
+  GASNET_Safe(gasnet_AMReplyMedium0(token, STRD_GET_REPLY, r, len));
+  chpl_mem_free(r, 0, 0);
+}
+
+static void AM_strd_get_reply(gasnet_token_t token, void* buf, size_t nbytes) {
+  strd_msg_t* r = buf;
+  strd_get_t* g = r->ack;
+
+  strd_copy_segs(g->addr, g->str, g->cnt, g->strlvls, r->first_seg, r->nsegs,
+                 (unsigned char*) r->data, 0);
+  signal_done(&g->done);
+}
+
+static void AM_strd_put(gasnet_token_t token, void* buf, size_t nbytes) {
+  strd_msg_t* m = buf;
+  size_t* str = m->data;
+  size_t* cnt = str + m->strlvls;
+
+  strd_copy_segs(m->addr, str, cnt, m->strlvls, m->first_seg, m->nsegs,
+                 (unsigned char*) (cnt + m->strlvls + 1), 0);
+
+  // Signal that the handler has completed
+  GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL,
+                                   AckArg0(m->ack), AckArg1(m->ack)));
+}
+
 static gasnet_handlerentry_t ftable[] = {
   {FORK,          AM_fork},
   {FORK_LARGE,    AM_fork_large},
@@ -351,7 +527,13 @@ static gasnet_handlerentry_t ftable[] = {
   {PRIV_BCAST_LARGE, AM_priv_bcast_large},
   {FREE,          AM_free},
   {EXIT_ANY,      AM_exit_any},
-  {BCAST_SEGINFO, AM_bcast_seginfo}
+  {BCAST_SEGINFO, AM_bcast_seginfo},
+  {PUT_COMBINED,  AM_put_combined},
+  {AGG,           AM_agg},
+  {AGG_ACK,       AM_agg_ack},
+  {STRD_GET,      AM_strd_get},
+  {STRD_GET_REPLY, AM_strd_get_reply},
+  {STRD_PUT,      AM_strd_put}
 };
 
 //
@@ -612,6 +794,8 @@ void chpl_comm_post_task_init(void) {
 
   // Initialize the caching layer, if it is active.
   chpl_cache_init();
+
+  chpl_comm_agg_init();
 }
 
 void chpl_comm_rollcall(void) {
@@ -818,6 +1002,125 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
   }
 }
 
+//
+// Split the records in buf into messages of at most max_data bytes of
+// records. If pc is NULL, just count the messages. Otherwise, send them
+// (with pc as the message buffer). A record that doesn't fit in a
+// message by itself is done with a regular PUT.
+//
+static int put_combined_messages(c_nodeid_t node, unsigned char* buf,
+                                 size_t nbytes, size_t max_data,
+                                 put_combined_t* pc) {
+  unsigned char* cur = buf;
+  unsigned char* start = buf;
+  unsigned char* end = buf + nbytes;
+  int nmsgs = 0;
+  chpl_comm_put_record_t r;
+  size_t rsize;
+
+  while (cur < end) {
+    memcpy(&r, cur, sizeof(r));
+    rsize = CHPL_COMM_PUT_RECORD_SIZE(r.len);
+    if (cur + rsize - start > max_data || rsize > max_data) {
+      // Send what we have so far.
+      if (cur > start) {
+        if (pc) {
+          chpl_memcpy(pc->data, start, cur - start);
+          GASNET_Safe(gasnet_AMRequestMedium0(node, PUT_COMBINED, pc,
+                                              sizeof(put_combined_t) +
+                                              (cur - start)));
+        }
+        nmsgs++;
+      }
+      start = cur;
+      if (rsize > max_data) {
+        if (pc)
+          gasnet_put(node, (void*) (intptr_t) r.raddr, cur + sizeof(r), r.len);
+        start = cur + rsize;
+      }
+    }
+    cur += rsize;
+  }
+
+  if (cur > start) {
+    if (pc) {
+      chpl_memcpy(pc->data, start, cur - start);
+      GASNET_Safe(gasnet_AMRequestMedium0(node, PUT_COMBINED, pc,
+                                          sizeof(put_combined_t) +
+                                          (cur - start)));
+    }
+    nmsgs++;
+  }
+
+  return nmsgs;
+}
+
+void chpl_comm_put_combined(c_nodeid_t node, void* buf, size_t nbytes,
+                            int ln, c_string fn) {
+  put_combined_t* pc;
+  done_t done;
+  size_t max_data;
+  int nmsgs;
+
+  if (chpl_nodeID == node) {
+    chpl_comm_apply_put_records(buf, nbytes);
+    return;
+  }
+
+  if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+    printf("%d: %s:%d: remote combined put to %d\n", chpl_nodeID, fn, ln, node);
+
+  // Count the messages first, so that the acknowledgement knows how
+  // many to expect before any of them can arrive.
+  max_data = gasnet_AMMaxMedium() - sizeof(put_combined_t);
+  nmsgs = put_combined_messages(node, buf, nbytes, max_data, NULL);
+
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
+    chpl_sync_lock(&chpl_comm_diagnostics_sync);
+    chpl_comm_commDiagnostics.put += nmsgs;
+    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
+  }
+
+  pc = (put_combined_t*) chpl_mem_allocMany(1, gasnet_AMMaxMedium(),
+                                            CHPL_RT_MD_COMM_PUT_COMBINED_DATA,
+                                            0, 0);
+  pc->ack = &done;
+  INIT_DONE_OBJ(done, nmsgs);
+  put_combined_messages(node, buf, nbytes, max_data, pc);
+  if (nmsgs > 0)
+    GASNET_BLOCKUNTIL(done.flag);
+  chpl_mem_free(pc, 0, 0);
+}
+
+size_t chpl_comm_agg_max_msg(void) {
+  return gasnet_AMMaxMedium();
+}
+
+void chpl_comm_agg_send(c_nodeid_t node, void* msg, size_t nbytes,
+                        int in_task, chpl_comm_agg_t* agg) {
+  agg_msg_t* m = (agg_msg_t*) msg;
+
+  // Our header fills the space reserved for it, so the records
+  // already follow it.
+  assert(sizeof(agg_msg_t) == CHPL_COMM_AGG_MSG_HEADER);
+
+  if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+    printf("%d: remote aggregated operations sent to %d\n",
+           chpl_nodeID, node);
+
+  m->ack = agg;
+  m->caller = chpl_nodeID;
+  m->in_task = in_task;
+  m->nbytes = nbytes;
+
+  // Medium AMs copy the payload before returning, so msg can be reused.
+  GASNET_Safe(gasnet_AMRequestMedium0(node, AGG, msg, nbytes));
+}
+
+void chpl_comm_agg_wait(chpl_comm_agg_t* agg) {
+  GASNET_BLOCKUNTIL(chpl_comm_agg_pending(agg) == 0);
+}
+
 ////GASNET - pass trace info to gasnet_get
 ////GASNET - define GASNET_E_ PUTGET always REMOTE
 ////GASNET - look at GASNET tools at top of README.tools has atomic counters
@@ -840,7 +1143,217 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
 }
 
 //
-// This is an adaptor from Chapel code to GASNet's gasnet_gets_bulk. It does:
+// Fold stride levels that are contiguous on both sides into the level
+// below them (and drop levels with a count of 1), so the segments are
+// as large as possible.  Returns the new number of levels.
+//
+static size_t strd_merge_levels(size_t* lstr, size_t* rstr, size_t* cnt,
+                                size_t strlvls) {
+  size_t i, k = 0;
+
+  for (i = 0; i < strlvls; i++) {
+    size_t c = cnt[i+1];
+    size_t lext = (k == 0) ? cnt[0] : lstr[k-1] * cnt[k];
+    size_t rext = (k == 0) ? cnt[0] : rstr[k-1] * cnt[k];
+
+    if (c == 1)
+      continue;
+    if (lstr[i] == lext && rstr[i] == rext) {
+      cnt[k] *= c;
+    } else {
+      lstr[k] = lstr[i];
+      rstr[k] = rstr[i];
+      cnt[k+1] = c;
+      k++;
+    }
+  }
+
+  return k;
+}
+
+//
+// Do the segments of a strided transfer as non-blocking GETs (if
+// is_get) or PUTs between laddr here and raddr on node, waiting once
+// at the end.  Segments on this node are just copied.
+//
+static void strd_xfer_nb(int is_get, unsigned char* laddr, size_t* lstr,
+                         c_nodeid_t node, unsigned char* raddr, size_t* rstr,
+                         size_t* cnt, size_t strlvls, uint64_t nsegs) {
+  gasnet_handle_t h[STRD_NB_WINDOW];
+  size_t idx[strlvls > 0 ? strlvls : 1];
+  size_t loff = 0, roff = 0;
+  uint64_t n;
+  int nh = 0;
+  int i, j;
+  size_t l;
+
+  for (l = 0; l < strlvls; l++)
+    idx[l] = 0;
+
+  for (n = 0; n < nsegs; n++) {
+    if (node == chpl_nodeID) {
+      if (is_get)
+        chpl_memcpy(laddr + loff, raddr + roff, cnt[0]);
+      else
+        chpl_memcpy(raddr + roff, laddr + loff, cnt[0]);
+    } else {
+      if (nh == STRD_NB_WINDOW) {
+        // Wait for at least one to finish and drop the finished ones.
+        gasnet_wait_syncnb_some(h, nh);
+        for (i = 0, j = 0; i < nh; i++) {
+          if (h[i] != GASNET_INVALID_HANDLE)
+            h[j++] = h[i];
+        }
+        nh = j;
+      }
+      if (is_get)
+        h[nh++] = gasnet_get_nb_bulk(laddr + loff, node, raddr + roff, cnt[0]);
+      else
+        h[nh++] = gasnet_put_nb_bulk(node, raddr + roff, laddr + loff, cnt[0]);
+    }
+
+    for (l = 0; l < strlvls; l++) {
+      loff += lstr[l];
+      roff += rstr[l];
+      if (++idx[l] < cnt[l+1])
+        break;
+      loff -= idx[l] * lstr[l];
+      roff -= idx[l] * rstr[l];
+      idx[l] = 0;
+    }
+  }
+
+  if (nh > 0)
+    gasnet_wait_syncnb_all(h, nh);
+}
+
+//
+// Do a strided GET with small segments by having node pack them into
+// AM replies.
+//
+static void strd_get_packed(unsigned char* dstaddr, size_t* dststr,
+                            c_nodeid_t node, void* srcaddr, size_t* srcstr,
+                            size_t* cnt, size_t strlvls, uint64_t nsegs) {
+  size_t desc = sizeof(strd_msg_t) + (2 * strlvls + 1) * sizeof(size_t);
+  uint64_t per_msg = (gasnet_AMMaxMedium() - sizeof(strd_msg_t)) / cnt[0];
+  uint64_t nmsgs = (nsegs + per_msg - 1) / per_msg;
+  uint64_t i;
+  strd_get_t g;
+  strd_msg_t* m;
+
+  g.addr = dstaddr;
+  g.str = dststr;
+  g.cnt = cnt;
+  g.strlvls = strlvls;
+  INIT_DONE_OBJ(g.done, nmsgs);
+
+  m = (strd_msg_t*) chpl_mem_allocMany(1, desc, CHPL_RT_MD_COMM_STRD_BUFFER,
+                                       0, 0);
+  m->ack = &g;
+  m->addr = srcaddr;
+  m->strlvls = strlvls;
+  m->pad = 0;
+  chpl_memcpy(m->data, srcstr, strlvls * sizeof(size_t));
+  chpl_memcpy(m->data + strlvls, cnt, (strlvls + 1) * sizeof(size_t));
+
+  for (i = 0; i < nmsgs; i++) {
+    GASNET_BLOCKUNTIL(i - atomic_load_uint_least32_t(&g.done.count)
+                      < STRD_MSG_WINDOW);
+    m->first_seg = i * per_msg;
+    m->nsegs = (nsegs - m->first_seg < per_msg) ? nsegs - m->first_seg
+                                                : per_msg;
+    GASNET_Safe(gasnet_AMRequestMedium0(node, STRD_GET, m, desc));
+  }
+
+  GASNET_BLOCKUNTIL(g.done.flag);
+  chpl_mem_free(m, 0, 0);
+}
+
+//
+// Do a strided PUT with small segments by packing them into AMs that
+// node unpacks.
+//
+static void strd_put_packed(c_nodeid_t node, void* dstaddr, size_t* dststr,
+                            unsigned char* srcaddr, size_t* srcstr,
+                            size_t* cnt, size_t strlvls, uint64_t nsegs) {
+  size_t desc = sizeof(strd_msg_t) + (2 * strlvls + 1) * sizeof(size_t);
+  uint64_t per_msg = (gasnet_AMMaxMedium() - desc) / cnt[0];
+  uint64_t nmsgs = (nsegs + per_msg - 1) / per_msg;
+  uint64_t i;
+  done_t done;
+  strd_msg_t* m;
+
+  INIT_DONE_OBJ(done, nmsgs);
+
+  m = (strd_msg_t*) chpl_mem_allocMany(1, gasnet_AMMaxMedium(),
+                                       CHPL_RT_MD_COMM_STRD_BUFFER, 0, 0);
+  m->ack = &done;
+  m->addr = dstaddr;
+  m->strlvls = strlvls;
+  m->pad = 0;
+  chpl_memcpy(m->data, dststr, strlvls * sizeof(size_t));
+  chpl_memcpy(m->data + strlvls, cnt, (strlvls + 1) * sizeof(size_t));
+
+  for (i = 0; i < nmsgs; i++) {
+    GASNET_BLOCKUNTIL(i - atomic_load_uint_least32_t(&done.count)
+                      < STRD_MSG_WINDOW);
+    m->first_seg = i * per_msg;
+    m->nsegs = (nsegs - m->first_seg < per_msg) ? nsegs - m->first_seg
+                                                : per_msg;
+    strd_copy_segs(srcaddr, srcstr, cnt, strlvls, m->first_seg, m->nsegs,
+                   (unsigned char*) m + desc, 1);
+    // Medium AMs copy the payload before returning, so m can be reused.
+    GASNET_Safe(gasnet_AMRequestMedium0(node, STRD_PUT, m,
+                                        desc + m->nsegs * cnt[0]));
+  }
+
+  GASNET_BLOCKUNTIL(done.flag);
+  chpl_mem_free(m, 0, 0);
+}
+
+//
+// Do a strided transfer between laddr here and raddr on node, with
+// the strides and count[0] in bytes.  The strides and counts may be
+// changed.
+//
+static void strd_xfer(int is_get, void* laddr, size_t* lstr,
+                      c_nodeid_t node, void* raddr, size_t* rstr,
+                      size_t* cnt, size_t strlvls) {
+  uint64_t nsegs = 1;
+  size_t desc;
+  size_t i;
+
+  for (i = 0; i <= strlvls; i++) {
+    if (cnt[i] == 0)
+      return;
+  }
+
+  strlvls = strd_merge_levels(lstr, rstr, cnt, strlvls);
+  for (i = 1; i <= strlvls; i++)
+    nsegs *= cnt[i];
+
+  if (nsegs == 1) {
+    if (is_get)
+      gasnet_get_bulk(laddr, node, raddr, cnt[0]);
+    else
+      gasnet_put_bulk(node, raddr, laddr, cnt[0]);
+    return;
+  }
+
+  desc = sizeof(strd_msg_t) + (2 * strlvls + 1) * sizeof(size_t);
+  if (node != chpl_nodeID && cnt[0] <= STRD_PACK_MAX_SEG &&
+      desc + cnt[0] <= gasnet_AMMaxMedium()) {
+    if (is_get)
+      strd_get_packed(laddr, lstr, node, raddr, rstr, cnt, strlvls, nsegs);
+    else
+      strd_put_packed(node, raddr, rstr, laddr, lstr, cnt, strlvls, nsegs);
+  } else {
+    strd_xfer_nb(is_get, laddr, lstr, node, raddr, rstr, cnt, strlvls, nsegs);
+  }
+}
+
+//
+// This is an adaptor from Chapel code to strd_xfer(). It does:
 // * convert count[0] and all of 'srcstr' and 'dststr' from counts of element
 //   to counts of bytes,
 // * convert the element types of the above C arrays from int32_t to size_t.
@@ -885,7 +1398,7 @@ void  chpl_comm_get_strd(void* dstaddr, void* dststrides, c_nodeid_t srcnode_id,
     for (i=0;i<=strlvls;i++) printf(" %d ",(int)cnt[i]);
     printf("\n");                     
   }
-  // the case (chpl_nodeID == srcnode) is internally managed inside gasnet
+  // the case (chpl_nodeID == srcnode) is handled by strd_xfer()
   if (chpl_verbose_comm && !chpl_comm_no_debug_private)
     printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln, srcnode);
   if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
@@ -893,7 +1406,7 @@ void  chpl_comm_get_strd(void* dstaddr, void* dststrides, c_nodeid_t srcnode_id,
     chpl_comm_commDiagnostics.get++;
     chpl_sync_unlock(&chpl_comm_diagnostics_sync);
   }
-  gasnet_gets_bulk(dstaddr, dststr, srcnode, srcaddr, srcstr, cnt, strlvls); 
+  strd_xfer(1, dstaddr, dststr, srcnode, srcaddr, srcstr, cnt, strlvls);
 }
 
 // See the comment for cmpl_comm_gets().
@@ -935,7 +1448,7 @@ void  chpl_comm_put_strd(void* dstaddr, void* dststrides, c_nodeid_t dstnode_id,
     printf("\n");                     
   }
 
-  // the case (chpl_nodeID == dstnode) is internally managed inside gasnet
+  // the case (chpl_nodeID == dstnode) is handled by strd_xfer()
   if (chpl_verbose_comm && !chpl_comm_no_debug_private)
     printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln, dstnode);
   if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
@@ -943,7 +1456,7 @@ void  chpl_comm_put_strd(void* dstaddr, void* dststrides, c_nodeid_t dstnode_id,
     chpl_comm_commDiagnostics.put++;
     chpl_sync_unlock(&chpl_comm_diagnostics_sync);
   }
-  gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls); 
+  strd_xfer(0, srcaddr, srcstr, dstnode, dstaddr, dststr, cnt, strlvls);
 }
 
 
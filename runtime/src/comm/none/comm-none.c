@@ -20,6 +20,7 @@
 #include "chplrt.h"
 
 #include "chpl-comm.h"
+#include "chpl-comm-agg.h"
 #include "chplexit.h"
 #include "error.h"
 #include "chpl-mem.h"
@@ -74,6 +75,34 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
   return NULL;
 }
 
+void chpl_comm_put_combined(c_nodeid_t node, void* buf, size_t nbytes,
+                            int ln, c_string fn)
+{
+  assert(node == 0);
+  chpl_comm_apply_put_records(buf, nbytes);
+}
+
+size_t chpl_comm_agg_max_msg(void)
+{
+  return SIZE_MAX;
+}
+
+// Operations for this node are run without being sent, so this is
+// never called for a single node, but support it anyway.
+void chpl_comm_agg_send(c_nodeid_t node, void* msg, size_t nbytes,
+                        int in_task, chpl_comm_agg_t* agg)
+{
+  assert(node == 0);
+  chpl_comm_agg_apply((char*) msg + CHPL_COMM_AGG_MSG_HEADER,
+                      nbytes - CHPL_COMM_AGG_MSG_HEADER);
+  chpl_comm_agg_acked(agg);
+}
+
+void chpl_comm_agg_wait(chpl_comm_agg_t* agg)
+{
+  assert(chpl_comm_agg_pending(agg) == 0);
+}
+
 int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h)
 {
   return ((void*) h) == NULL;
@@ -126,7 +155,9 @@ int chpl_comm_run_in_gdb(int argc, char* argv[], int gdbArgnum, int* status) {
   return 1;
 }
 
-void chpl_comm_post_task_init(void) { }
+void chpl_comm_post_task_init(void) {
+  chpl_comm_agg_init();
+}
 
 void chpl_comm_rollcall(void) {
   chpl_msg(2, "executing on a single node\n");
@@ -0,0 +1,815 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// See qio_plugin_gzip.h for an overview.
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "qio_plugin_gzip.h"
+#include "sys.h"
+#include "error.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+// Each member written starts with this 24-byte header: the 10-byte gzip
+// header with FEXTRA set, a 2-byte XLEN and one 12-byte subfield with
+// the id 'Q','B' holding the total member size and the uncompressed
+// size (both little-endian uint32). The member ends with the usual
+// CRC32 and ISIZE trailer.
+#define GZIP_HEADER_SIZE 24
+#define GZIP_TRAILER_SIZE 8
+#define GZIP_XLEN 12
+#define GZIP_SUBFIELD_LEN 8
+#define GZIP_SI1 'Q'
+#define GZIP_SI2 'B'
+
+#define to_gzip_file(f) ((gzip_file_t*)f)
+
+typedef struct gzip_block_s {
+  int64_t comp_offset; // where the member starts in the file
+  int64_t uoffset;     // where its data starts in the uncompressed data
+  uint32_t comp_size;  // size of the whole member
+  uint32_t usize;      // size of its uncompressed data
+} gzip_block_t;
+
+typedef struct gzip_file_s {
+  fd_t fd;
+  char* path;
+  int writing;
+  int nthreads;
+  pthread_mutex_t lock;
+
+  // for readv
+  int64_t pos;
+
+  // Reading an indexed file (gz == NULL).
+  gzip_block_t* blocks;
+  int64_t nblocks;
+  int64_t length;
+  // The window holds blocks win_first..win_first+win_count-1
+  // decompressed into win[0..win_count-1].
+  int64_t win_first;
+  int win_count;
+  unsigned char* win[QIO_GZIP_MAX_THREADS];
+  unsigned char* scratch[QIO_GZIP_MAX_THREADS];
+
+  // Reading any other gzip file.
+  gzFile gz;
+
+  // Writing. Holds up to nthreads blocks of data waiting to be compressed.
+  unsigned char* batch;
+  size_t batch_len;
+  unsigned char* out[QIO_GZIP_MAX_THREADS];
+  size_t out_cap;
+  int64_t nwritten;
+} gzip_file_t;
+
+typedef struct gzip_job_s {
+  gzip_file_t* fl;
+  const unsigned char* src;
+  size_t src_len;
+  unsigned char* dst;
+  size_t dst_len;
+  int64_t block;
+  qioerr err;
+} gzip_job_t;
+
+static int gzip_nthreads = QIO_GZIP_DEFAULT_THREADS;
+static pthread_once_t gzip_nthreads_once = PTHREAD_ONCE_INIT;
+
+static
+void gzip_nthreads_setup(void)
+{
+  char* p;
+  char* end;
+  long v;
+
+  if( (p = getenv("CHPL_RT_GZIP_THREADS")) != NULL ) {
+    v = strtol(p, &end, 10);
+    if( end == p || *end != '\0' || v < 1 || v > QIO_GZIP_MAX_THREADS ) {
+      chpl_warning("CHPL_RT_GZIP_THREADS must be a number of threads from 1 to 64",
+                   0, NULL);
+    } else {
+      gzip_nthreads = v;
+    }
+  }
+}
+
+static
+int gzip_num_threads(void)
+{
+  pthread_once(&gzip_nthreads_once, gzip_nthreads_setup);
+  return gzip_nthreads;
+}
+
+static inline
+void gzip_put32(unsigned char* p, uint32_t x)
+{
+  p[0] = x & 0xff;
+  p[1] = (x >> 8) & 0xff;
+  p[2] = (x >> 16) & 0xff;
+  p[3] = (x >> 24) & 0xff;
+}
+
+static inline
+uint32_t gzip_get32(const unsigned char* p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+         ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+// Returns 1 if p is one of our member headers, storing the sizes.
+static
+int gzip_parse_header(const unsigned char* p, uint32_t* comp_size, uint32_t* usize)
+{
+  if( p[0] != 0x1f || p[1] != 0x8b || p[2] != Z_DEFLATED || p[3] != 4 ) return 0;
+  if( p[10] != GZIP_XLEN || p[11] != 0 ) return 0;
+  if( p[12] != GZIP_SI1 || p[13] != GZIP_SI2 ) return 0;
+  if( p[14] != GZIP_SUBFIELD_LEN || p[15] != 0 ) return 0;
+
+  *comp_size = gzip_get32(p + 16);
+  *usize = gzip_get32(p + 20);
+  if( *comp_size < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE ) return 0;
+  if( *usize > QIO_GZIP_BLOCK_SIZE ) return 0;
+  return 1;
+}
+
+static
+void gzip_make_header(unsigned char* p, uint32_t comp_size, uint32_t usize)
+{
+  memset(p, 0, GZIP_HEADER_SIZE);
+  p[0] = 0x1f;
+  p[1] = 0x8b;
+  p[2] = Z_DEFLATED;
+  p[3] = 4; // FEXTRA
+  // mtime and XFL are 0
+  p[9] = 255; // OS unknown
+  p[10] = GZIP_XLEN;
+  p[12] = GZIP_SI1;
+  p[13] = GZIP_SI2;
+  p[14] = GZIP_SUBFIELD_LEN;
+  gzip_put32(p + 16, comp_size);
+  gzip_put32(p + 20, usize);
+}
+
+// Compress job->src into a complete member in job->dst.
+static
+void* gzip_compress_job(void* arg)
+{
+  gzip_job_t* job = (gzip_job_t*) arg;
+  z_stream z;
+  uLong crc;
+  uint32_t comp_size;
+  int rc;
+
+  memset(&z, 0, sizeof(z));
+  rc = deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                    Z_DEFAULT_STRATEGY);
+  if( rc != Z_OK ) {
+    QIO_GET_CONSTANT_ERROR(job->err, ENOMEM, "could not start compression");
+    return NULL;
+  }
+
+  z.next_in = (Bytef*) job->src;
+  z.avail_in = job->src_len;
+  z.next_out = job->dst + GZIP_HEADER_SIZE;
+  z.avail_out = job->fl->out_cap - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE;
+  rc = deflate(&z, Z_FINISH);
+  comp_size = GZIP_HEADER_SIZE + z.total_out + GZIP_TRAILER_SIZE;
+  deflateEnd(&z);
+  if( rc != Z_STREAM_END ) {
+    QIO_GET_CONSTANT_ERROR(job->err, EINVAL, "compression failed");
+    return NULL;
+  }
+
+  crc = crc32(crc32(0L, Z_NULL, 0), job->src, job->src_len);
+  gzip_make_header(job->dst, comp_size, job->src_len);
+  gzip_put32(job->dst + comp_size - GZIP_TRAILER_SIZE, crc);
+  gzip_put32(job->dst + comp_size - 4, job->src_len);
+  job->dst_len = comp_size;
+  job->err = 0;
+  return NULL;
+}
+
+// Read the member for job->block into job->src and decompress it
+// into job->dst.
+static
+void* gzip_decompress_job(void* arg)
+{
+  gzip_job_t* job = (gzip_job_t*) arg;
+  gzip_block_t* b = &job->fl->blocks[job->block];
+  unsigned char* src = (unsigned char*) job->src;
+  size_t got = 0;
+  ssize_t amt;
+  err_t rc;
+  z_stream z;
+  uLong crc;
+  int zrc;
+
+  while( got < b->comp_size ) {
+    rc = sys_pread(job->fl->fd, src + got, b->comp_size - got,
+                   b->comp_offset + got, &amt);
+    if( rc == EEOF ) {
+      QIO_GET_CONSTANT_ERROR(job->err, EINVAL, "truncated compressed file");
+      return NULL;
+    } else if( rc ) {
+      job->err = qio_int_to_err(rc);
+      return NULL;
+    }
+    got += amt;
+  }
+
+  memset(&z, 0, sizeof(z));
+  zrc = inflateInit2(&z, -MAX_WBITS);
+  if( zrc != Z_OK ) {
+    QIO_GET_CONSTANT_ERROR(job->err, ENOMEM, "could not start decompression");
+    return NULL;
+  }
+  z.next_in = src + GZIP_HEADER_SIZE;
+  z.avail_in = b->comp_size - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE;
+  z.next_out = job->dst;
+  z.avail_out = b->usize;
+  zrc = inflate(&z, Z_FINISH);
+  inflateEnd(&z);
+
+  crc = crc32(crc32(0L, Z_NULL, 0), job->dst, b->usize);
+  if( zrc != Z_STREAM_END || z.total_out != b->usize ||
+      gzip_get32(src + b->comp_size - GZIP_TRAILER_SIZE) != crc ) {
+    QIO_GET_CONSTANT_ERROR(job->err, EINVAL, "corrupt compressed block");
+    return NULL;
+  }
+
+  job->dst_len = b->usize;
+  job->err = 0;
+  return NULL;
+}
+
+// Run fn on each of the jobs, using a thread for each job after the
+// first. Returns the first error.
+static
+qioerr gzip_run_jobs(gzip_job_t* jobs, int njobs, void* (*fn)(void*))
+{
+  pthread_t threads[QIO_GZIP_MAX_THREADS];
+  int started[QIO_GZIP_MAX_THREADS];
+  qioerr err = 0;
+  int i;
+
+  for( i = 1; i < njobs; i++ ) {
+    started[i] = (pthread_create(&threads[i], NULL, fn, &jobs[i]) == 0);
+    // If we couldn't get a thread, just do it ourselves.
+    if( ! started[i] ) fn(&jobs[i]);
+  }
+
+  fn(&jobs[0]);
+
+  for( i = 1; i < njobs; i++ ) {
+    if( started[i] ) pthread_join(threads[i], NULL);
+  }
+
+  for( i = 0; i < njobs; i++ ) {
+    if( jobs[i].err && ! err ) err = jobs[i].err;
+  }
+  return err;
+}
+
+// Build the block index. Returns 0 with fl->blocks set if every member
+// in the file has our header, or 0 with fl->blocks NULL if it isn't
+// one of our files.
+static
+qioerr gzip_build_index(gzip_file_t* fl)
+{
+  unsigned char hdr[GZIP_HEADER_SIZE];
+  gzip_block_t* blocks = NULL;
+  gzip_block_t* tmp;
+  int64_t nblocks = 0;
+  int64_t cap = 0;
+  int64_t offset = 0;
+  int64_t uoffset = 0;
+  uint32_t comp_size, usize;
+  ssize_t amt;
+  size_t got;
+  err_t rc;
+
+  while( 1 ) {
+    got = 0;
+    rc = 0;
+    while( got < GZIP_HEADER_SIZE ) {
+      rc = sys_pread(fl->fd, hdr + got, GZIP_HEADER_SIZE - got, offset + got, &amt);
+      if( rc ) break;
+      got += amt;
+    }
+    if( rc == EEOF && got == 0 && nblocks > 0 ) break; // end of file
+    if( rc && rc != EEOF ) {
+      qio_free(blocks);
+      return qio_int_to_err(rc);
+    }
+    if( got < GZIP_HEADER_SIZE || ! gzip_parse_header(hdr, &comp_size, &usize) ) {
+      // Not (entirely) made up of our members.
+      qio_free(blocks);
+      fl->blocks = NULL;
+      return 0;
+    }
+
+    if( nblocks == cap ) {
+      cap = (cap == 0) ? 64 : 2*cap;
+      tmp = (gzip_block_t*) qio_realloc(blocks, cap*sizeof(gzip_block_t));
+      if( ! tmp ) {
+        qio_free(blocks);
+        return QIO_ENOMEM;
+      }
+      blocks = tmp;
+    }
+    blocks[nblocks].comp_offset = offset;
+    blocks[nblocks].uoffset = uoffset;
+    blocks[nblocks].comp_size = comp_size;
+    blocks[nblocks].usize = usize;
+    nblocks++;
+
+    offset += comp_size;
+    uoffset += usize;
+  }
+
+  fl->blocks = blocks;
+  fl->nblocks = nblocks;
+  fl->length = uoffset;
+  return 0;
+}
+
+// Decompress blocks first..first+n-1 into the window, where n is
+// at most fl->nthreads.
+static
+qioerr gzip_fill_window(gzip_file_t* fl, int64_t first)
+{
+  gzip_job_t jobs[QIO_GZIP_MAX_THREADS];
+  int64_t n = fl->nblocks - first;
+  qioerr err;
+  int i;
+
+  if( n > fl->nthreads ) n = fl->nthreads;
+
+  for( i = 0; i < n; i++ ) {
+    jobs[i].fl = fl;
+    jobs[i].src = fl->scratch[i];
+    jobs[i].src_len = 0;
+    jobs[i].dst = fl->win[i];
+    jobs[i].dst_len = 0;
+    jobs[i].block = first + i;
+    jobs[i].err = 0;
+  }
+
+  fl->win_count = 0;
+  err = gzip_run_jobs(jobs, n, gzip_decompress_job);
+  if( err ) return err;
+
+  fl->win_first = first;
+  fl->win_count = n;
+  return 0;
+}
+
+// Find the block containing uncompressed offset pos < fl->length.
+static
+int64_t gzip_find_block(gzip_file_t* fl, int64_t pos)
+{
+  int64_t lo = 0;
+  int64_t hi = fl->nblocks - 1;
+  int64_t mid;
+
+  while( lo < hi ) {
+    mid = lo + (hi - lo + 1) / 2;
+    if( fl->blocks[mid].uoffset <= pos ) lo = mid;
+    else hi = mid - 1;
+  }
+  return lo;
+}
+
+// Compress and write out the batch.
+static
+qioerr gzip_flush_batch(gzip_file_t* fl)
+{
+  gzip_job_t jobs[QIO_GZIP_MAX_THREADS];
+  size_t off = 0;
+  size_t len;
+  size_t done;
+  ssize_t amt;
+  err_t rc;
+  qioerr err;
+  int n = 0;
+  int i;
+
+  // Always write at least one member so that the file is valid gzip.
+  if( fl->batch_len == 0 && fl->nwritten > 0 ) return 0;
+
+  do {
+    len = fl->batch_len - off;
+    if( len > QIO_GZIP_BLOCK_SIZE ) len = QIO_GZIP_BLOCK_SIZE;
+    jobs[n].fl = fl;
+    jobs[n].src = fl->batch + off;
+    jobs[n].src_len = len;
+    jobs[n].dst = fl->out[n];
+    jobs[n].dst_len = 0;
+    jobs[n].block = fl->nwritten + n;
+    jobs[n].err = 0;
+    n++;
+    off += len;
+  } while( off < fl->batch_len );
+
+  err = gzip_run_jobs(jobs, n, gzip_compress_job);
+  if( err ) return err;
+
+  for( i = 0; i < n; i++ ) {
+    done = 0;
+    while( done < jobs[i].dst_len ) {
+      rc = sys_write(fl->fd, jobs[i].dst + done, jobs[i].dst_len - done, &amt);
+      if( rc ) return qio_int_to_err(rc);
+      done += amt;
+    }
+  }
+
+  fl->nwritten += n;
+  fl->batch_len = 0;
+  return 0;
+}
+
+static
+void gzip_free(gzip_file_t* fl)
+{
+  int i;
+
+  for( i = 0; i < QIO_GZIP_MAX_THREADS; i++ ) {
+    qio_free(fl->win[i]);
+    qio_free(fl->scratch[i]);
+    qio_free(fl->out[i]);
+  }
+  qio_free(fl->batch);
+  qio_free(fl->blocks);
+  qio_free(fl->path);
+  pthread_mutex_destroy(&fl->lock);
+  qio_free(fl);
+}
+
+static
+size_t gzip_iov_len(const struct iovec* vector, int count)
+{
+  size_t len = 0;
+  int i;
+
+  for( i = 0; i < count; i++ ) len += vector[i].iov_len;
+  return len;
+}
+
+static
+qioerr gzip_preadv_locked(gzip_file_t* fl, const struct iovec* vector, int count, off_t offset, ssize_t* num_read_out)
+{
+  int64_t pos = offset;
+  int64_t b;
+  size_t done;
+  size_t within;
+  size_t amt;
+  qioerr err = 0;
+  int i;
+
+  for( i = 0; i < count && pos < fl->length; i++ ) {
+    done = 0;
+    while( done < vector[i].iov_len && pos < fl->length ) {
+      b = gzip_find_block(fl, pos);
+      if( b < fl->win_first || b >= fl->win_first + fl->win_count ) {
+        err = gzip_fill_window(fl, b);
+        if( err ) goto out;
+      }
+      within = pos - fl->blocks[b].uoffset;
+      amt = fl->blocks[b].usize - within;
+      if( amt > vector[i].iov_len - done ) amt = vector[i].iov_len - done;
+      memcpy((char*) vector[i].iov_base + done,
+             fl->win[b - fl->win_first] + within, amt);
+      done += amt;
+      pos += amt;
+    }
+  }
+
+out:
+  // Like sys_preadv, report EEOF when nothing could be read.
+  if( pos == offset && ! err && gzip_iov_len(vector, count) > 0 ) {
+    err = qio_int_to_err(EEOF);
+  }
+  *num_read_out = pos - offset;
+  return err;
+}
+
+static
+qioerr gzip_preadv(void* file, const struct iovec* vector, int count, off_t offset, ssize_t* num_read_out, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+  qioerr err;
+
+  if( fl->gz ) {
+    *num_read_out = 0;
+    QIO_RETURN_CONSTANT_ERROR(ESPIPE, "gzip file has no block index");
+  }
+
+  pthread_mutex_lock(&fl->lock);
+  err = gzip_preadv_locked(fl, vector, count, offset, num_read_out);
+  pthread_mutex_unlock(&fl->lock);
+  return err;
+}
+
+static
+qioerr gzip_readv(void* file, const struct iovec* vector, int count, ssize_t* num_read_out, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+  ssize_t total = 0;
+  qioerr err = 0;
+  int got;
+  int errnum;
+  int i;
+
+  pthread_mutex_lock(&fl->lock);
+  if( ! fl->gz ) {
+    err = gzip_preadv_locked(fl, vector, count, fl->pos, &total);
+  } else {
+    for( i = 0; i < count; i++ ) {
+      got = gzread(fl->gz, vector[i].iov_base, vector[i].iov_len);
+      if( got < 0 ) {
+        gzerror(fl->gz, &errnum);
+        if( errnum == Z_ERRNO ) err = qio_int_to_err(errno);
+        else QIO_GET_CONSTANT_ERROR(err, EINVAL, "corrupt gzip file");
+        break;
+      }
+      total += got;
+      if( (size_t) got < vector[i].iov_len ) break;
+    }
+  }
+  if( total == 0 && ! err && gzip_iov_len(vector, count) > 0 ) {
+    err = qio_int_to_err(EEOF);
+  }
+  fl->pos += total;
+  pthread_mutex_unlock(&fl->lock);
+
+  *num_read_out = total;
+  return err;
+}
+
+static
+qioerr gzip_writev(void* file, const struct iovec* iov, int iovcnt, ssize_t* num_written_out, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+  size_t batch_cap = (size_t) fl->nthreads * QIO_GZIP_BLOCK_SIZE;
+  ssize_t total = 0;
+  size_t done;
+  size_t amt;
+  qioerr err = 0;
+  int i;
+
+  pthread_mutex_lock(&fl->lock);
+  for( i = 0; i < iovcnt && ! err; i++ ) {
+    done = 0;
+    while( done < iov[i].iov_len ) {
+      amt = batch_cap - fl->batch_len;
+      if( amt > iov[i].iov_len - done ) amt = iov[i].iov_len - done;
+      memcpy(fl->batch + fl->batch_len, (char*) iov[i].iov_base + done, amt);
+      fl->batch_len += amt;
+      done += amt;
+      total += amt;
+      if( fl->batch_len == batch_cap ) {
+        err = gzip_flush_batch(fl);
+        if( err ) break;
+      }
+    }
+  }
+  fl->pos += total;
+  pthread_mutex_unlock(&fl->lock);
+
+  *num_written_out = total;
+  return err;
+}
+
+static
+qioerr gzip_open(void** fd, const char* path, int* flags, mode_t mode, qio_hint_t iohints, void* fs)
+{
+  gzip_file_t* fl;
+  size_t bufsize;
+  qioerr err = 0;
+  err_t rc;
+  int i;
+
+  if( (*flags & O_ACCMODE) == O_RDWR ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "gzip files can't be opened for both reading and writing");
+  }
+
+  fl = (gzip_file_t*) qio_calloc(sizeof(gzip_file_t), 1);
+  if( ! fl ) return QIO_ENOMEM;
+  fl->fd = -1;
+  pthread_mutex_init(&fl->lock, NULL);
+
+  fl->path = qio_strdup(path);
+  if( ! fl->path ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  rc = sys_open(path, *flags, mode, &fl->fd);
+  if( rc ) {
+    fl->fd = -1;
+    err = qio_int_to_err(rc);
+    goto error;
+  }
+
+  fl->writing = (*flags & O_ACCMODE) == O_WRONLY;
+  fl->nthreads = gzip_num_threads();
+
+  if( fl->writing ) {
+    fl->out_cap = GZIP_HEADER_SIZE + compressBound(QIO_GZIP_BLOCK_SIZE) + GZIP_TRAILER_SIZE;
+    fl->batch = (unsigned char*) qio_malloc((size_t) fl->nthreads * QIO_GZIP_BLOCK_SIZE);
+    if( ! fl->batch ) {
+      err = QIO_ENOMEM;
+      goto error;
+    }
+    for( i = 0; i < fl->nthreads; i++ ) {
+      fl->out[i] = (unsigned char*) qio_malloc(fl->out_cap);
+      if( ! fl->out[i] ) {
+        err = QIO_ENOMEM;
+        goto error;
+      }
+    }
+    *flags = QIO_FDFLAG_WRITEABLE;
+  } else {
+    err = gzip_build_index(fl);
+    if( err ) goto error;
+
+    if( fl->blocks ) {
+      bufsize = 0;
+      for( i = 0; i < fl->nblocks; i++ ) {
+        if( fl->blocks[i].comp_size > bufsize ) bufsize = fl->blocks[i].comp_size;
+      }
+      if( fl->nthreads > fl->nblocks ) fl->nthreads = fl->nblocks;
+      for( i = 0; i < fl->nthreads; i++ ) {
+        fl->win[i] = (unsigned char*) qio_malloc(QIO_GZIP_BLOCK_SIZE);
+        fl->scratch[i] = (unsigned char*) qio_malloc(bufsize);
+        if( ! fl->win[i] || ! fl->scratch[i] ) {
+          err = QIO_ENOMEM;
+          goto error;
+        }
+      }
+      *flags = QIO_FDFLAG_READABLE | QIO_FDFLAG_SEEKABLE;
+    } else {
+      // zlib owns the descriptor from now on.
+      fl->gz = gzdopen(fl->fd, "rb");
+      if( ! fl->gz ) {
+        err = QIO_ENOMEM;
+        goto error;
+      }
+      fl->fd = -1;
+      *flags = QIO_FDFLAG_READABLE;
+    }
+  }
+
+  *fd = fl;
+  return 0;
+
+error:
+  if( fl->fd != -1 ) sys_close(fl->fd);
+  gzip_free(fl);
+  return err;
+}
+
+static
+qioerr gzip_close(void* file, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+  qioerr err = 0;
+  err_t rc;
+
+  if( fl->writing ) err = gzip_flush_batch(fl);
+
+  if( fl->gz ) {
+    if( gzclose(fl->gz) != Z_OK && ! err ) {
+      QIO_GET_CONSTANT_ERROR(err, EINVAL, "could not close gzip file");
+    }
+  } else {
+    rc = sys_close(fl->fd);
+    if( rc && ! err ) err = qio_int_to_err(rc);
+  }
+
+  gzip_free(fl);
+  return err;
+}
+
+static
+qioerr gzip_fsync(void* file, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+  qioerr err = 0;
+  err_t rc;
+
+  if( ! fl->writing ) return 0;
+
+  pthread_mutex_lock(&fl->lock);
+  if( fl->batch_len > 0 ) err = gzip_flush_batch(fl);
+  pthread_mutex_unlock(&fl->lock);
+  if( err ) return err;
+
+  rc = sys_fsync(fl->fd);
+  return qio_int_to_err(rc);
+}
+
+// Only indexed files being read are seekable; for the others we return
+// ESPIPE so that QIO uses readv/writev.
+static
+qioerr gzip_seek(void* file, off_t offset, int whence, off_t* offset_out, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+  int64_t pos;
+
+  if( fl->writing || fl->gz ) {
+    QIO_RETURN_CONSTANT_ERROR(ESPIPE, "gzip file is not seekable");
+  }
+
+  switch( whence ) {
+    case SEEK_SET:
+      pos = offset;
+      break;
+    case SEEK_CUR:
+      pos = fl->pos + offset;
+      break;
+    case SEEK_END:
+      pos = fl->length + offset;
+      break;
+    default:
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid whence");
+  }
+  if( pos < 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "seek to negative offset");
+
+  fl->pos = pos;
+  *offset_out = pos;
+  return 0;
+}
+
+static
+qioerr gzip_getlength(void* file, int64_t* len_out, void* fs)
+{
+  gzip_file_t* fl = to_gzip_file(file);
+
+  if( fl->writing || fl->gz ) {
+    // This will set initial length to 0 in QIO
+    *len_out = 0;
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "Unable to get length of gzip file");
+  }
+
+  *len_out = fl->length;
+  return 0;
+}
+
+static
+qioerr gzip_getpath(void* file, const char** string_out, void* fs)
+{
+  *string_out = qio_strdup(to_gzip_file(file)->path);
+  if( ! *string_out ) return QIO_ENOMEM;
+  return 0;
+}
+
+static
+int gzip_get_fs_type(void* file, void* fs)
+{
+  return FTYPE_GZIP;
+}
+
+qio_file_functions_t gzip_function_struct = {
+    &gzip_writev,      //writev
+    &gzip_readv,       //readv
+    NULL,              //pwritev
+    &gzip_preadv,      //preadv
+    &gzip_close,       //close
+    &gzip_open,        //open
+    &gzip_seek,        //seek
+    &gzip_getlength,   //filelength
+    &gzip_getpath,     //getpath
+    &gzip_fsync,       //fsync
+    NULL,              //getcwd
+    &gzip_get_fs_type, //get_fs_type
+    NULL,              //get_chunk
+    NULL,              //get_locales_for_region
+};
+
+const qio_file_functions_ptr_t gzip_function_struct_ptr = &gzip_function_struct;
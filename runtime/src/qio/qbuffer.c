@@ -29,7 +29,10 @@
 
 #include "sys.h"
 
+#include "chpl-thread-local-storage.h"
+
 #include <limits.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <assert.h>
@@ -90,9 +93,262 @@ void qbytes_free_sys_free(qbytes_t* b) {
   _qbytes_free_qbytes(b);
 }
 
+/* Recycling pool for iobufs.
+ *
+ * Channels allocate and release iobufs constantly, and getting a fresh
+ * page-aligned region from the system each time is expensive. So,
+ * released iobufs go into a per-locale free list (bounded by
+ * CHPL_RT_IOBUF_POOL_SIZE, in buffers) and are handed out again by
+ * _qbytes_init_iobuf. In front of that, each thread keeps a few
+ * buffers of its own so that most allocations don't touch the shared
+ * lock at all.
+ *
+ * A free buffer stores the list link and its size in its first bytes.
+ * Only buffers whose size is still qbytes_iobuf_size are reused; the
+ * rest are returned to the system as they are found.
+ *
+ * A thread's cached buffers go back to the shared list when the thread
+ * exits, and qbytes_iobuf_pool_exit frees everything at shutdown.
+ *
+ * Recycled buffers are zeroed before they are handed out again, since
+ * a fresh valloc'd iobuf usually comes from zero-filled pages.
+ */
+typedef struct qbytes_iobuf_free_s {
+  struct qbytes_iobuf_free_s* next;
+  size_t size;
+} qbytes_iobuf_free_t;
+
+#define QBYTES_IOBUF_POOL_DEFAULT 64
+#define QBYTES_IOBUF_THREAD_CACHE 4
+
+static pthread_mutex_t qbytes_iobuf_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+// set (under the lock) once the counters are initialized and
+// qbytes_iobuf_pool_max has been read from the environment.
+static volatile int qbytes_iobuf_pool_ready = 0;
+static qbytes_iobuf_free_t* qbytes_iobuf_pool_head = NULL;
+static int64_t qbytes_iobuf_pool_count = 0;
+static int64_t qbytes_iobuf_pool_max = QBYTES_IOBUF_POOL_DEFAULT;
+
+static atomic_uint_least64_t qbytes_iobuf_n_allocated;
+static atomic_uint_least64_t qbytes_iobuf_n_reused;
+static atomic_uint_least64_t qbytes_iobuf_n_recycled;
+static atomic_uint_least64_t qbytes_iobuf_n_freed;
+
+#ifdef CHPL_TLS
+static CHPL_TLS qbytes_iobuf_free_t* qbytes_iobuf_thread_head;
+static CHPL_TLS int qbytes_iobuf_thread_count;
+// Never read; set while a thread has cached buffers so that
+// _qbytes_iobuf_thread_exit runs when the thread exits.
+static pthread_key_t qbytes_iobuf_thread_key;
+
+static void _qbytes_iobuf_thread_exit(void* unused);
+#endif
+
+static
+void _qbytes_iobuf_pool_setup(void)
+{
+  char* p;
+  char* end;
+  long v;
+
+  pthread_mutex_lock(&qbytes_iobuf_pool_lock);
+  if( ! qbytes_iobuf_pool_ready ) {
+    atomic_init_uint_least64_t(&qbytes_iobuf_n_allocated, 0);
+    atomic_init_uint_least64_t(&qbytes_iobuf_n_reused, 0);
+    atomic_init_uint_least64_t(&qbytes_iobuf_n_recycled, 0);
+    atomic_init_uint_least64_t(&qbytes_iobuf_n_freed, 0);
+
+    if( (p = getenv("CHPL_RT_IOBUF_POOL_SIZE")) != NULL ) {
+      v = strtol(p, &end, 10);
+      if( end == p || *end != '\0' || v < 0 ) {
+        chpl_warning("CHPL_RT_IOBUF_POOL_SIZE must be a number of buffers >= 0",
+                     0, NULL);
+      } else {
+        qbytes_iobuf_pool_max = v;
+      }
+    }
+
+#ifdef CHPL_TLS
+    pthread_key_create(&qbytes_iobuf_thread_key, &_qbytes_iobuf_thread_exit);
+#endif
+
+    qbytes_iobuf_pool_ready = 1;
+  }
+  pthread_mutex_unlock(&qbytes_iobuf_pool_lock);
+}
+
+static inline
+void _qbytes_iobuf_system_free(void* data)
+{
+  sys_free(data);
+  atomic_fetch_add_uint_least64_t(&qbytes_iobuf_n_freed, 1);
+}
+
+// Returns a recycled buffer of qbytes_iobuf_size bytes, or NULL.
+static
+void* _qbytes_iobuf_pool_get(void)
+{
+  qbytes_iobuf_free_t* got = NULL;
+  qbytes_iobuf_free_t* stale = NULL;
+  qbytes_iobuf_free_t* next;
+
+  if( ! qbytes_iobuf_pool_ready ) _qbytes_iobuf_pool_setup();
+
+#ifdef CHPL_TLS
+  while( qbytes_iobuf_thread_head ) {
+    got = qbytes_iobuf_thread_head;
+    qbytes_iobuf_thread_head = got->next;
+    qbytes_iobuf_thread_count--;
+    if( got->size == qbytes_iobuf_size ) break;
+    _qbytes_iobuf_system_free(got);
+    got = NULL;
+  }
+#endif
+
+  if( ! got && qbytes_iobuf_pool_head ) {
+    pthread_mutex_lock(&qbytes_iobuf_pool_lock);
+    while( qbytes_iobuf_pool_head ) {
+      got = qbytes_iobuf_pool_head;
+      qbytes_iobuf_pool_head = got->next;
+      qbytes_iobuf_pool_count--;
+      if( got->size == qbytes_iobuf_size ) break;
+      // free these after dropping the lock
+      got->next = stale;
+      stale = got;
+      got = NULL;
+    }
+    pthread_mutex_unlock(&qbytes_iobuf_pool_lock);
+
+    for( ; stale; stale = next ) {
+      next = stale->next;
+      _qbytes_iobuf_system_free(stale);
+    }
+  }
+
+  if( got ) atomic_fetch_add_uint_least64_t(&qbytes_iobuf_n_reused, 1);
+
+  return got;
+}
+
+// Keep data (an iobuf of len bytes) for reuse, or free it.
+static
+void _qbytes_iobuf_pool_put(void* data, int64_t len)
+{
+  qbytes_iobuf_free_t* f = (qbytes_iobuf_free_t*) data;
+
+  if( ! qbytes_iobuf_pool_ready ) _qbytes_iobuf_pool_setup();
+
+  if( qbytes_iobuf_pool_max == 0 ||
+      len != qbytes_iobuf_size ||
+      len < (int64_t) sizeof(qbytes_iobuf_free_t) ) {
+    _qbytes_iobuf_system_free(data);
+    return;
+  }
+
+  f->size = len;
+
+#ifdef CHPL_TLS
+  if( qbytes_iobuf_thread_count < QBYTES_IOBUF_THREAD_CACHE ) {
+    if( qbytes_iobuf_thread_count == 0 )
+      pthread_setspecific(qbytes_iobuf_thread_key, &qbytes_iobuf_thread_key);
+    f->next = qbytes_iobuf_thread_head;
+    qbytes_iobuf_thread_head = f;
+    qbytes_iobuf_thread_count++;
+    atomic_fetch_add_uint_least64_t(&qbytes_iobuf_n_recycled, 1);
+    return;
+  }
+#endif
+
+  pthread_mutex_lock(&qbytes_iobuf_pool_lock);
+  if( qbytes_iobuf_pool_count < qbytes_iobuf_pool_max ) {
+    f->next = qbytes_iobuf_pool_head;
+    qbytes_iobuf_pool_head = f;
+    qbytes_iobuf_pool_count++;
+    f = NULL;
+  }
+  pthread_mutex_unlock(&qbytes_iobuf_pool_lock);
+
+  if( f ) _qbytes_iobuf_system_free(f);
+  else atomic_fetch_add_uint_least64_t(&qbytes_iobuf_n_recycled, 1);
+}
+
+#ifdef CHPL_TLS
+// Move this thread's cached buffers to the shared list, or free them
+// if it is full.
+static
+void _qbytes_iobuf_thread_drain(void)
+{
+  qbytes_iobuf_free_t* f;
+  qbytes_iobuf_free_t* stale = NULL;
+
+  if( ! qbytes_iobuf_thread_head ) return;
+
+  pthread_mutex_lock(&qbytes_iobuf_pool_lock);
+  while( qbytes_iobuf_thread_head ) {
+    f = qbytes_iobuf_thread_head;
+    qbytes_iobuf_thread_head = f->next;
+    if( qbytes_iobuf_pool_count < qbytes_iobuf_pool_max ) {
+      f->next = qbytes_iobuf_pool_head;
+      qbytes_iobuf_pool_head = f;
+      qbytes_iobuf_pool_count++;
+    } else {
+      f->next = stale;
+      stale = f;
+    }
+  }
+  qbytes_iobuf_thread_count = 0;
+  pthread_mutex_unlock(&qbytes_iobuf_pool_lock);
+
+  for( ; stale; stale = f ) {
+    f = stale->next;
+    _qbytes_iobuf_system_free(stale);
+  }
+}
+
+static
+void _qbytes_iobuf_thread_exit(void* unused)
+{
+  _qbytes_iobuf_thread_drain();
+}
+#endif
+
+void qbytes_iobuf_pool_exit(void)
+{
+  qbytes_iobuf_free_t* f;
+  qbytes_iobuf_free_t* next;
+
+  if( ! qbytes_iobuf_pool_ready ) return;
+
+#ifdef CHPL_TLS
+  _qbytes_iobuf_thread_drain();
+#endif
+
+  pthread_mutex_lock(&qbytes_iobuf_pool_lock);
+  f = qbytes_iobuf_pool_head;
+  qbytes_iobuf_pool_head = NULL;
+  qbytes_iobuf_pool_count = 0;
+  pthread_mutex_unlock(&qbytes_iobuf_pool_lock);
+
+  for( ; f; f = next ) {
+    next = f->next;
+    _qbytes_iobuf_system_free(f);
+  }
+}
+
+void qbytes_iobuf_pool_stats(qbytes_iobuf_pool_stats_t* stats)
+{
+  if( ! qbytes_iobuf_pool_ready ) _qbytes_iobuf_pool_setup();
+
+  stats->allocated = atomic_load_uint_least64_t(&qbytes_iobuf_n_allocated);
+  stats->reused = atomic_load_uint_least64_t(&qbytes_iobuf_n_reused);
+  stats->recycled = atomic_load_uint_least64_t(&qbytes_iobuf_n_recycled);
+  stats->freed = atomic_load_uint_least64_t(&qbytes_iobuf_n_freed);
+}
+
 void qbytes_free_iobuf(qbytes_t* b) {
-  // iobuf is just something to be freed with free()
-  qbytes_free_sys_free(b);
+  // give the data back to the iobuf pool
+  _qbytes_iobuf_pool_put(b->data, b->len);
+  _qbytes_free_qbytes(b);
 }
 
 void debug_print_bytes(qbytes_t* b)
@@ -135,16 +391,21 @@ qioerr qbytes_create_generic(qbytes_t** out, void* give_data, int64_t len, qbyte
 qioerr _qbytes_init_iobuf(qbytes_t* ret)
 {
   void* data = NULL;
-  
-  // allocate 4K-aligned (or page size aligned)
-  // multiple of 4K
-  data = valloc(qbytes_iobuf_size);
-  if( !data ) return QIO_ENOMEM;
-  // We used to use posix_memalign, but that didn't work on an old Mac;
-  // also, this should be page-aligned (vs iobuf_size aligned).
-  //err_t err = posix_memalign(&data, qbytes_iobuf_size, qbytes_iobuf_size);
-  //if( err ) return err;
-  memset(data, 0, qbytes_iobuf_size);
+
+  data = _qbytes_iobuf_pool_get();
+  if( data ) {
+    memset(data, 0, qbytes_iobuf_size);
+  } else {
+    // allocate 4K-aligned (or page size aligned)
+    // multiple of 4K
+    data = valloc(qbytes_iobuf_size);
+    if( !data ) return QIO_ENOMEM;
+    // We used to use posix_memalign, but that didn't work on an old Mac;
+    // also, this should be page-aligned (vs iobuf_size aligned).
+    //err_t err = posix_memalign(&data, qbytes_iobuf_size, qbytes_iobuf_size);
+    //if( err ) return err;
+    atomic_fetch_add_uint_least64_t(&qbytes_iobuf_n_allocated, 1);
+  }
 
   // The ref count in ret is initially 1.
   _qbytes_init_generic(ret, data, qbytes_iobuf_size, qbytes_free_iobuf);
@@ -37,6 +37,7 @@
 
 #include "qio.h"
 #include "qbuffer.h"
+#include "qio_uring.h"
 
 #include "error.h"
 
@@ -66,19 +67,12 @@ ssize_t qio_initial_mmap_max = 8*1024*1024;
 bool qio_allow_default_mmap = true;
 
 #ifdef _chplrt_H_
-qioerr qio_lock(qio_lock_t* x) {
-  // recursive mutex based on glibc pthreads implementation
-  int64_t id = chpl_task_getId();
+qioerr qio_lock_slow(qio_lock_t* x, int64_t id) {
+  // recursive mutex based on glibc pthreads implementation;
+  // qio_lock has already checked whether we hold the mutex.
 
   assert( id != NULL_OWNER );
 
-  // check whether we already hold the mutex.
-  if( x->owner == id ) {
-    // just bump the counter.
-    ++x->count;
-    return 0;
-  }
-
   // we have to get the mutex.
   chpl_sync_lock(&x->sv);
 
@@ -88,7 +82,7 @@ qioerr qio_lock(qio_lock_t* x) {
 
   return 0;
 }
-void qio_unlock(qio_lock_t* x) {
+void qio_unlock_slow(qio_lock_t* x) {
   int64_t id = chpl_task_getId();
 
   // recursive mutex based on glibc pthreads implementation
@@ -104,6 +98,23 @@ void qio_unlock(qio_lock_t* x) {
   x->owner = NULL_OWNER;
   chpl_sync_unlock(&x->sv);
 }
+
+qioerr qio_lock_shared_slow(qio_rwlock_t* x) {
+  // Somebody else holds the lock exclusively. Stop counting
+  // ourselves so that they can proceed, wait for them to release
+  // the lock, and try again.
+  while( 1 ) {
+    atomic_fetch_sub_int_least64_t(&x->shared, 1);
+
+    chpl_sync_lock(&x->lock.sv);
+    chpl_sync_unlock(&x->lock.sv);
+
+    atomic_fetch_add_int_least64_t(&x->shared, 1);
+    // As in qio_lock_shared, be counted before looking at the owner.
+    atomic_thread_fence(memory_order_seq_cst);
+    if( x->lock.owner == NULL_OWNER ) return 0;
+  }
+}
 #endif
 
 qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_read)
@@ -196,6 +207,109 @@ error:
   return err;
 }
 
+// Copy the iovecs describing bytes [skip, skip+len) of iov into out,
+// which must have room for iovcnt entries. Returns the number of
+// entries used.
+static
+size_t _qio_iov_slice(const struct iovec* iov, size_t iovcnt, size_t skip, size_t len, struct iovec* out)
+{
+  size_t i;
+  size_t n = 0;
+
+  for( i = 0; i < iovcnt && len > 0; i++ ) {
+    size_t part = iov[i].iov_len;
+    if( skip >= part ) {
+      skip -= part;
+      continue;
+    }
+    part -= skip;
+    if( part > len ) part = len;
+    out[n].iov_base = (char*) iov[i].iov_base + skip;
+    out[n].iov_len = part;
+    n++;
+    len -= part;
+    skip = 0;
+  }
+
+  return n;
+}
+
+// Read or write iov at offset for a file with a direct_fd. The request
+// is split at direct_align boundaries into an unaligned head, an aligned
+// middle and an unaligned tail. The middle goes to direct_fd when its
+// buffers are also aligned; everything else goes to the normal fd.
+// Stops at the first short transfer, just like preadv/pwritev.
+static
+qioerr _qio_direct_iov(qio_file_t* file, int writing, const struct iovec* iov, size_t iovcnt, int64_t offset, ssize_t* num_out)
+{
+  int64_t align = file->direct_align;
+  int64_t total = 0;
+  int64_t head, mid, end, mid_end;
+  int64_t piece_start[3], piece_len[3];
+  ssize_t done = 0;
+  ssize_t got;
+  size_t i, n;
+  int p;
+  struct iovec* sub = NULL;
+  MAYBE_STACK_SPACE(struct iovec, sub_onstack);
+  qioerr err = 0;
+
+  for( i = 0; i < iovcnt; i++ ) total += iov[i].iov_len;
+
+  head = (align - (offset % align)) % align;
+  if( head > total ) head = total;
+  end = offset + total;
+  mid_end = end - (end % align);
+  mid = mid_end - (offset + head);
+  if( mid < 0 ) mid = 0;
+
+  piece_start[0] = 0;
+  piece_len[0] = head;
+  piece_start[1] = head;
+  piece_len[1] = mid;
+  piece_start[2] = head + mid;
+  piece_len[2] = total - head - mid;
+
+  MAYBE_STACK_ALLOC(struct iovec, iovcnt, sub, sub_onstack);
+  if( ! sub ) {
+    *num_out = 0;
+    return QIO_ENOMEM;
+  }
+
+  for( p = 0; p < 3; p++ ) {
+    fd_t fd = file->fd;
+
+    if( piece_len[p] == 0 ) continue;
+
+    n = _qio_iov_slice(iov, iovcnt, piece_start[p], piece_len[p], sub);
+
+    if( p == 1 ) {
+      fd = file->direct_fd;
+      for( i = 0; i < n; i++ ) {
+        if( ((intptr_t) sub[i].iov_base) % align != 0 ||
+            sub[i].iov_len % align != 0 ) {
+          fd = file->fd;
+          break;
+        }
+      }
+    }
+
+    got = 0;
+    if( writing ) {
+      err = qio_int_to_err(sys_pwritev(fd, sub, n, offset + done, &got));
+    } else {
+      err = qio_int_to_err(sys_preadv(fd, sub, n, offset + done, &got));
+    }
+    done += got;
+    if( err || got < piece_len[p] ) break;
+  }
+
+  MAYBE_STACK_FREE(sub, sub_onstack);
+
+  *num_out = done;
+  return err;
+}
+
 qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
 {
   ssize_t nread = 0;
@@ -222,6 +336,9 @@ qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffe
   if( err ) goto error;
 
   // read into our buffer.
+  if (file->direct_fd != -1)
+    err = _qio_direct_iov(file, 0, iov, iovcnt, seek_to_offset, &nread);
+  else
   if (file->fd != -1) // Do we have an fd?
     err = qio_int_to_err(sys_preadv(file->fd, iov, iovcnt, seek_to_offset, &nread));
   else 
@@ -364,6 +481,9 @@ qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuff
   if( err ) goto error;
 
   // write from our buffer
+  if (file->direct_fd != -1)
+    err = _qio_direct_iov(file, 1, iov, iovcnt, seek_to_offset, &nwritten);
+  else
   if (file->fd != -1) // So see if we have an fd we can use
     err = qio_int_to_err(sys_pwritev(file->fd, iov, iovcnt, seek_to_offset, &nwritten));
   else // Don't have an fd
@@ -560,9 +680,22 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
           method = QIO_METHOD_READWRITE;
         }
       }
+    } else if( method == QIO_METHOD_URING ) {
+      // io_uring requests always carry an offset, so
+      // we can only use it for seekable descriptors.
+      if( isfilestar ) method = QIO_METHOD_FREADFWRITE;
+      else if( !(fdflags & QIO_FDFLAG_SEEKABLE) ) method = QIO_METHOD_READWRITE;
     } else {
       // method already chosen in hints.
     }
+
+    // Direct I/O is done by qio_preadv/qio_pwritev, which know how
+    // to split requests between the O_DIRECT and normal descriptors;
+    // mmap and io_uring would bypass that.
+    if( (ret & QIO_HINT_DIRECT) && !isfilestar &&
+        (method == QIO_METHOD_MMAP || method == QIO_METHOD_URING) ) {
+      method = QIO_METHOD_PREADPWRITE;
+    }
   }
 
   // Always use fread/fwrite with FILE*
@@ -583,6 +716,67 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
   return ret | method | type;
 }
 
+#ifndef TMPFS_MAGIC
+#define TMPFS_MAGIC 0x01021994
+#endif
+#ifndef RAMFS_MAGIC
+#define RAMFS_MAGIC 0x858458f6
+#endif
+
+// Set up file->direct_fd for QIO_HINT_DIRECT. If the file system
+// can't do direct I/O (or there is no point, because it is memory
+// backed), clear the hint and leave file->direct_fd as -1.
+static
+qioerr qio_open_direct(qio_file_t* file)
+{
+  sys_statfs_t st;
+  int64_t align;
+  int64_t page = sys_page_size();
+  err_t errcode;
+
+  file->direct_fd = -1;
+
+  if( file->fd == -1 || file->fp ||
+      ! (file->fdflags & QIO_FDFLAG_SEEKABLE) ) goto fallback;
+
+  errcode = sys_fstatfs(file->fd, &st);
+  if( errcode ) goto fallback;
+  if( st.f_type == TMPFS_MAGIC || st.f_type == RAMFS_MAGIC ) goto fallback;
+
+  // Use the file system block size when it is a power of 2 that
+  // the page-aligned iobufs can satisfy.
+  align = st.f_bsize;
+  if( align < 512 || align > page || (align & (align - 1)) != 0 ) {
+    align = page;
+  }
+
+#if defined(O_DIRECT) && defined(__linux__)
+  {
+    char path[64];
+    int flags;
+    fd_t fd;
+
+    errcode = sys_fcntl(file->fd, F_GETFL, &flags);
+    if( errcode ) goto fallback;
+
+    // Open the same file again, so that the normal descriptor can
+    // still be used for unaligned requests.
+    snprintf(path, sizeof(path), "/proc/self/fd/%i", (int) file->fd);
+    flags = (flags & O_ACCMODE) | O_DIRECT;
+    errcode = sys_open(path, flags, 0, &fd);
+    if( errcode ) goto fallback;
+
+    file->direct_fd = fd;
+    file->direct_align = align;
+    return 0;
+  }
+#endif
+
+fallback:
+  file->hints &= ~QIO_HINT_DIRECT;
+  return 0;
+}
+
 static
 qioerr qio_fadvise_for_hints(qio_file_t* file)
 {
@@ -591,17 +785,7 @@ qioerr qio_fadvise_for_hints(qio_file_t* file)
   qioerr err;
 
   if( file->hints & QIO_HINT_DIRECT ) {
-    int rc;
-    long arg;
-    // Set O_DIRECT on our fd.
-    err = qio_int_to_err(sys_fcntl(file->fd, F_GETFL, &rc));
-    if( err ) return err;
-
-    arg = rc;
-#ifdef O_DIRECT
-    arg |= O_DIRECT;
-#endif
-    err = qio_int_to_err(sys_fcntl_long(file->fd, F_SETFL, arg, &rc));
+    err = qio_open_direct(file);
     if( err ) return err;
   } else {
     err = 0;
@@ -808,6 +992,7 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
   DO_INIT_REFCNT(file);
   file->fp = fp;
   file->fd = fd;
+  file->direct_fd = -1;
   file->use_fp = usefilestar;
   file->buf = NULL;
   file->fdflags = fdflags;
@@ -823,7 +1008,7 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
                                  file->fp != 0 && file->use_fp );
 
   file->mmap = NULL;
-  err = qio_lock_init(&file->lock);
+  err = qio_rwlock_init(&file->lock);
   if( err ) goto error;
   file->max_initial_position = -1;
 
@@ -903,6 +1088,7 @@ qioerr qio_file_init_usr(qio_file_t** file_out, void* file_info, qio_hint_t iohi
   DO_INIT_REFCNT(file);
   file->fp = NULL;
   file->fd = -1;
+  file->direct_fd = -1;
   file->use_fp = 0;
   file->buf = NULL;
   file->fdflags = (qio_fdflag_t) flags;
@@ -918,7 +1104,7 @@ qioerr qio_file_init_usr(qio_file_t** file_out, void* file_info, qio_hint_t iohi
                                  file->fp != 0 && file->use_fp );
 
   file->mmap = NULL;
-  err = qio_lock_init(&file->lock);
+  err = qio_rwlock_init(&file->lock);
   if( err ) goto error;
   file->max_initial_position = -1;
 
@@ -949,7 +1135,7 @@ qioerr _qio_file_do_close(qio_file_t* f)
   //printf("closing %p fd %i fp %p\n", f, f->fd, f->fp);
 
 
-  err = qio_lock(& f->lock);
+  err = qio_lock_exclusive(& f->lock);
   if( err ) return err;
 
   if( f->mmap ) {
@@ -963,6 +1149,12 @@ qioerr _qio_file_do_close(qio_file_t* f)
     f->buf = NULL;
   }
 
+  if( f->direct_fd >= 0 ) {
+    // We always opened this one ourselves.
+    err = qio_int_to_err(sys_close(f->direct_fd));
+    f->direct_fd = -1;
+  }
+
   if( f->fp ) {
     if (f->hints & QIO_HINT_OWNED) {
       rc = fclose(f->fp);
@@ -996,7 +1188,7 @@ qioerr _qio_file_do_close(qio_file_t* f)
     f->fd = -1;
   }
 
-  qio_unlock(& f->lock);
+  qio_unlock_exclusive(& f->lock);
 
   return err;
 }
@@ -1050,7 +1242,7 @@ void _qio_file_destroy(qio_file_t* f)
     abort();
   }
 
-  qio_lock_destroy(&f->lock);
+  qio_rwlock_destroy(&f->lock);
 
   qbytes_release(f->mmap); // Does nothing if null.
 
@@ -1192,6 +1384,7 @@ qioerr qio_file_open_mem_ext(qio_file_t** file_out, qbuffer_t* buf, qio_fdflag_t
   DO_INIT_REFCNT(file); // initialized to 1.
   file->fp = NULL;
   file->fd = -1;
+  file->direct_fd = -1;
   file->fdflags = fdflags;
   file->hints = choose_io_method(file, iohints, 0, qbuffer_len(file->buf),
                                  (fdflags & QIO_FDFLAG_READABLE) > 0,
@@ -1210,7 +1403,7 @@ qioerr qio_file_open_mem_ext(qio_file_t** file_out, qbuffer_t* buf, qio_fdflag_t
   if( style ) qio_style_copy(&file->style, style);
   else qio_style_init_default(&file->style);
 
-  err = qio_lock_init(&file->lock);
+  err = qio_rwlock_init(&file->lock);
   if( err ) goto error;
 
   file->max_initial_position = -1;
@@ -1366,7 +1559,7 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out)
 
   // Lock necessary for MEMORY buffers
   // but not necessary for file descriptors
-  err = qio_lock(& f->lock);
+  err = qio_lock_shared(& f->lock);
   if( err ) return err;
 
   if( f->buf ) {
@@ -1379,14 +1572,120 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out)
   } else if(f->fsfns) {
     if (f->fsfns->filelength){
       err = f->fsfns->filelength(f->file_info, len_out, f->fs_info);
-    } else QIO_RETURN_CONSTANT_ERROR(ENOSYS, "missing filelength");
-  } else QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no fd or plugin");
+    } else QIO_GET_CONSTANT_ERROR(err, ENOSYS, "missing filelength");
+  } else QIO_GET_CONSTANT_ERROR(err, ENOSYS, "no fd or plugin");
+
+  qio_unlock_shared(& f->lock);
+
+  return err;
+}
+
+qioerr qio_file_find_record_start(qio_file_t* f, int64_t start, int64_t end, int32_t delim, int64_t* pos_out)
+{
+  qio_channel_t* ch;
+  int64_t pos = start;
+  int32_t got = 0;
+  qioerr err;
+
+  if( start >= end ) {
+    *pos_out = end;
+    return 0;
+  }
+
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, start, end, NULL);
+  if( err ) return err;
+
+  while( 1 ) {
+    got = qio_channel_read_byte(false, ch);
+    if( got < 0 ) break;
+    pos++;
+    if( got == delim ) break;
+  }
+
+  // Running out of data just means there is no delimiter.
+  if( got < 0 && -got != EEOF ) err = qio_int_to_err(-got);
 
-  qio_unlock(& f->lock);
+  qio_channel_release(ch);
 
+  *pos_out = pos;
   return err;
 }
 
+qioerr qio_file_prefetch(qio_file_t* f, int64_t start, int64_t len)
+{
+  qioerr err = 0;
+
+  if( len <= 0 || f->fd == -1 ) return 0;
+
+#if (_XOPEN_SOURCE >= 600 || _POSIX_C_SOURCE >= 200112L)
+#ifdef POSIX_FADV_WILLNEED
+  err = qio_int_to_err(sys_posix_fadvise(f->fd, start, len, POSIX_FADV_WILLNEED));
+#endif
+#endif
+
+  return err;
+}
+
+qioerr qio_file_map_region(qio_file_t* f, int64_t start, int64_t len, qio_hint_t hints, void** data_out)
+{
+  int64_t file_len = 0;
+  int64_t skip;
+  void* data = NULL;
+  int prot = PROT_READ;
+  int populate = 0;
+  qioerr err;
+
+  *data_out = NULL;
+
+  if( start < 0 || len < 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid region");
+  if( f->fd == -1 ) QIO_RETURN_CONSTANT_ERROR(ENOSYS, "can only map a file with a file descriptor");
+
+  err = qio_file_length(f, &file_len);
+  if( err ) return err;
+  if( start > file_len || len > file_len - start ) {
+    // Touching a mapped page past the end of the file raises SIGBUS.
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "region extends past the end of the file");
+  }
+
+  if( len == 0 ) return 0;
+
+  if( hints == 0 ) hints = f->hints;
+
+  // mmap offsets have to be page-aligned.
+  skip = start % (int64_t) sys_page_size();
+
+  // This check is (only) important for 32-bit systems.
+  if( len + skip > SSIZE_MAX ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "overflow in mmap");
+
+#ifdef MAP_POPULATE
+  if( hints & QIO_HINT_CACHED ) populate = MAP_POPULATE;
+#endif
+
+  if( f->fdflags & QIO_FDFLAG_WRITEABLE ) prot |= PROT_WRITE;
+
+  err = qio_int_to_err(sys_mmap(NULL, len + skip, prot, MAP_SHARED|populate, f->fd, start - skip, &data));
+  if( err ) return err;
+
+  err = qio_madvise_for_hints(data, len + skip, hints);
+  if( err ) {
+    sys_munmap(data, len + skip);
+    return err;
+  }
+
+  *data_out = (char*) data + skip;
+  return 0;
+}
+
+qioerr qio_unmap_region(void* data, int64_t len)
+{
+  intptr_t skip;
+
+  if( data == NULL || len == 0 ) return 0;
+
+  skip = ((intptr_t) data) % (intptr_t) sys_page_size();
+  return qio_int_to_err(sys_munmap((char*) data - skip, len + skip));
+}
+
 /* CHANNELS ----------------------------- */
 static
 qioerr _qio_channel_init(qio_channel_t* ch, qio_chtype_t type)
@@ -1451,7 +1750,7 @@ qioerr _qio_channel_init_file_internal(qio_channel_t* ch, qio_file_t* file, qio_
   ch->end_pos = end;
   // update the file with start_pos.
   err = 0;
-  newerr = qio_lock(&ch->file->lock);
+  newerr = qio_lock_exclusive(&ch->file->lock);
   if( !err ) err = newerr;
   if( ch->start_pos > ch->file->max_initial_position ) {
     ch->file->max_initial_position = ch->start_pos;
@@ -1462,7 +1761,7 @@ qioerr _qio_channel_init_file_internal(qio_channel_t* ch, qio_file_t* file, qio_
 
   qio_style_copy(&ch->style, use_style);
 
-  qio_unlock(&ch->file->lock);
+  qio_unlock_exclusive(&ch->file->lock);
 
   return err;
 }
@@ -1770,7 +2069,7 @@ qioerr _qio_channel_final_flush_unlocked(qio_channel_t* ch)
     // next to the declaration of qio_file->max_initial_position.
     if( (method == QIO_METHOD_MMAP || method == QIO_METHOD_MEMORY) &&
         (ch->flags & QIO_FDFLAG_WRITEABLE) ) {
-      err = qio_lock(&ch->file->lock);
+      err = qio_lock_exclusive(&ch->file->lock);
       if( !err ) {
         int64_t max_space_made = ch->av_end;
         int64_t max_written = ch->mark_stack[0];
@@ -1801,7 +2100,7 @@ qioerr _qio_channel_final_flush_unlocked(qio_channel_t* ch)
           }
         }
 
-        qio_unlock(&ch->file->lock);
+        qio_unlock_exclusive(&ch->file->lock);
       }
     }
   }
@@ -1835,6 +2134,9 @@ void _qio_channel_destroy(qio_channel_t* ch)
     abort();
   }
 
+  qio_uring_destroy(ch->uring);
+  ch->uring = NULL;
+
   qio_lock_destroy(&ch->lock);
 
   qio_file_release(ch->file);
@@ -1909,6 +2211,7 @@ qioerr _buffered_allocate_bufferspace(qio_channel_t* ch, int64_t amt, int64_t ma
   int64_t left = amt;
   int64_t max_left = max_amt;
   int64_t uselen;
+  int64_t skip;
   qbytes_t* tmp;
   qioerr err;
 
@@ -1916,9 +2219,17 @@ qioerr _buffered_allocate_bufferspace(qio_channel_t* ch, int64_t amt, int64_t ma
   while( left > 0 ) {
     err = qbytes_create_iobuf(&tmp);
     if( err ) goto error;
-    uselen = tmp->len;
+    // For direct I/O, skip enough of the (page-aligned) iobuf that
+    // memory addresses line up with file offsets, so that the aligned
+    // parts of a request can use the O_DIRECT descriptor.
+    skip = 0;
+    if( ch->file && ch->file->direct_fd != -1 ) {
+      skip = qbuffer_end_offset(&ch->buf) % ch->file->direct_align;
+      if( skip >= tmp->len ) skip = 0;
+    }
+    uselen = tmp->len - skip;
     if( uselen > max_left ) uselen = max_left;
-    err = qbuffer_append(&ch->buf, tmp, 0, uselen);
+    err = qbuffer_append(&ch->buf, tmp, skip, uselen);
     // qbuffer_append retains tmp, so we can release our local reference.
     // If there was an error, then it is not retained anywhere, so it is
     // reclaimed here.
@@ -2001,6 +2312,8 @@ qioerr _buffered_get_memory_file_lock_held(qio_channel_t* ch, int64_t amt, int w
       qbytes_t* iobuf = NULL;
       err = qbytes_create_iobuf(&iobuf);
       if( err ) goto error;
+      // new iobufs aren't zeroed, but the file grows by the whole buffer.
+      memset(qbytes_data(iobuf), 0, qbytes_len(iobuf));
       err = qbuffer_append(ch->file->buf, iobuf, 0, qbytes_len(iobuf));
       // qbuffer_append retains iobuf, so we can release our local reference.
       // If there was an error, then this releases the buffer entirely.
@@ -2062,13 +2375,16 @@ qioerr _buffered_get_memory(qio_channel_t* ch, int64_t amt, int writing)
   if( err ) return err;
   
   // lock the file's buffer, which protects
-  // access to file->buf.
-  err = qio_lock(&ch->file->lock);
+  // access to file->buf. Readers don't change it,
+  // so they can share the lock.
+  if( writing ) err = qio_lock_exclusive(&ch->file->lock);
+  else err = qio_lock_shared(&ch->file->lock);
   if( err ) return err;
 
   err = _buffered_get_memory_file_lock_held(ch, amt, writing);
 
-  qio_unlock(&ch->file->lock);
+  if( writing ) qio_unlock_exclusive(&ch->file->lock);
+  else qio_unlock_shared(&ch->file->lock);
   return err;
 }
 
@@ -2196,6 +2512,21 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
   else return 0;
 }
 
+// Returns the channel's io_uring instance, creating it if necessary,
+// or NULL if io_uring can't be used (so use pread/pwrite instead).
+static
+qio_uring_t* _qio_channel_uring(qio_channel_t* ch)
+{
+  if( ch->uring || ch->uring_failed ) return ch->uring;
+
+  if( ch->file->fd == -1 || qio_uring_create(&ch->uring) ) {
+    ch->uring = NULL;
+    ch->uring_failed = 1;
+  }
+
+  return ch->uring;
+}
+
 // Runs read or pread, whichever is appropriate,
 // to read into the buffer.
 static
@@ -2205,6 +2536,7 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
   qbuffer_iter_t read_end;
   ssize_t num_read;
   int64_t left = amt;
+  int64_t readahead = 0;
   int64_t max_amt;
   int return_eof = 0;
   qioerr err;
@@ -2225,14 +2557,23 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
     return_eof = 1;
   }
 
+  // With io_uring, read ahead far enough to keep
+  // several requests in flight at once.
+  if( method == QIO_METHOD_URING &&
+      amt < QIO_URING_DEPTH * qbytes_iobuf_size ) {
+    readahead = QIO_URING_DEPTH * qbytes_iobuf_size;
+    if( readahead > max_amt ) readahead = max_amt;
+    readahead -= amt;
+  }
+
   //printf("Allocating bufferspace %lli\n", (long long int) amt);
-  err = _buffered_allocate_bufferspace(ch, amt, max_amt);
+  err = _buffered_allocate_bufferspace(ch, amt + readahead, max_amt);
   if( err ) return err;
 
   read_start = _av_end_iter(ch);
 
-  left = amt;
-  while(left > 0) {
+  left = amt + readahead;
+  while(left > readahead) {
     read_end = read_start;
     qbuffer_iter_advance(&ch->buf, &read_end, left);
 
@@ -2248,6 +2589,13 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
       case QIO_METHOD_PREADPWRITE:
         err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
         break;
+      case QIO_METHOD_URING:
+        if( _qio_channel_uring(ch) ) {
+          err = qio_uring_preadv(ch->uring, ch->file->fd, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        } else {
+          err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        }
+        break;
       case QIO_METHOD_FREADFWRITE:
         err = qio_freadv(ch->file->fp, &ch->buf, read_start, read_end, &num_read);
         break;
@@ -2458,11 +2806,6 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
   //fprintf(stderr, "starting write\n");
   //debug_print_qbuffer(&ch->buf);
 
-  if(ch->hints & QIO_HINT_DIRECT) {
-    // Round out the data to write to the end of the current chunk.
-    qbuffer_iter_ceil_part(&ch->buf, &write_end);
-  }
-
   if(ch->flags & QIO_FDFLAG_WRITEABLE) {
     while( qbuffer_iter_num_bytes(write_start, write_end) > 0 ) {
       QIO_GET_CONSTANT_ERROR(err, EINVAL, "write method not implemented");
@@ -2474,6 +2817,13 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
         case QIO_METHOD_PREADPWRITE:
           err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
           break;
+        case QIO_METHOD_URING:
+          if( _qio_channel_uring(ch) ) {
+            err = qio_uring_pwritev(ch->uring, ch->file->fd, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          } else {
+            err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           err = qio_fwritev(ch->file->fp, &ch->buf, write_start, write_end, &num_written);
           break;
@@ -2697,6 +3047,13 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
           break;
+        case QIO_METHOD_URING:
+          if( _qio_channel_uring(ch) ) {
+            err = qio_uring_pwrite(ch->uring, ch->file->fd, ptr, len, _right_mark_start(ch), &num_written);
+          } else {
+            err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_written_u = fwrite(ptr, 1, len, ch->file->fp);
@@ -2787,6 +3144,13 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
           break;
+        case QIO_METHOD_URING:
+          if( _qio_channel_uring(ch) ) {
+            err = qio_uring_pread(ch->uring, ch->file->fd, ptr, len, _right_mark_start(ch), &num_read);
+          } else {
+            err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_read_u = fread(ptr, 1, len, ch->file->fp);
@@ -2960,6 +3324,318 @@ qioerr _qio_slow_read(qio_channel_t* ch, void* ptr, ssize_t len, ssize_t* amt_re
   return ret;
 }
 
+/* Support for bulk transfers (see qio_channel_read_bulk).
+ */
+
+// Swaps go through a temporary buffer of this size when writing.
+#define QIO_SWAP_CHUNK (64*1024)
+
+// Reverse the bytes of each swap_size-byte element in ptr[0..len).
+static
+void _qio_swap_elements(void* ptr, ssize_t len, ssize_t swap_size)
+{
+  uint8_t* p = (uint8_t*) ptr;
+  ssize_t i, j;
+  int little = (htobe16(1) != 1);
+
+  // Since the host is in one byte order, converting to the
+  // other one reverses the bytes.
+  switch( swap_size ) {
+    case 2:
+      for( i = 0; i + 2 <= len; i += 2 ) {
+        uint16_t x;
+        memcpy(&x, p + i, 2);
+        x = little ? htobe16(x) : htole16(x);
+        memcpy(p + i, &x, 2);
+      }
+      break;
+    case 4:
+      for( i = 0; i + 4 <= len; i += 4 ) {
+        uint32_t x;
+        memcpy(&x, p + i, 4);
+        x = little ? htobe32(x) : htole32(x);
+        memcpy(p + i, &x, 4);
+      }
+      break;
+    case 8:
+      for( i = 0; i + 8 <= len; i += 8 ) {
+        uint64_t x;
+        memcpy(&x, p + i, 8);
+        x = little ? htobe64(x) : htole64(x);
+        memcpy(p + i, &x, 8);
+      }
+      break;
+    default:
+      if( swap_size <= 1 ) break;
+      for( i = 0; i + swap_size <= len; i += swap_size ) {
+        for( j = 0; j < swap_size / 2; j++ ) {
+          uint8_t tmp = p[i + j];
+          p[i + j] = p[i + swap_size - 1 - j];
+          p[i + swap_size - 1 - j] = tmp;
+        }
+      }
+      break;
+  }
+}
+
+static
+qioerr _qio_file_pread_amt(qio_file_t* f, void* ptr, int64_t len, int64_t offset, ssize_t swap_size, int64_t* amt_read)
+{
+  qioerr err = 0;
+  ssize_t num_read;
+  int64_t done = 0;
+
+  while( done < len ) {
+    num_read = 0;
+    err = qio_int_to_err(sys_pread(f->fd, VOID_PTR_ADD(ptr, done), len - done, offset + done, &num_read));
+    if( err ) break;
+    if( num_read == 0 ) {
+      err = QIO_EEOF;
+      break;
+    }
+    done += num_read;
+  }
+
+  if( swap_size > 1 ) _qio_swap_elements(ptr, done, swap_size);
+
+  *amt_read = done;
+  return err;
+}
+
+static
+qioerr _qio_file_pwrite_amt(qio_file_t* f, const void* ptr, int64_t len, int64_t offset, ssize_t swap_size, int64_t* amt_written)
+{
+  qioerr err = 0;
+  ssize_t num_written;
+  int64_t done = 0;
+  uint8_t* tmp = NULL;
+
+  if( swap_size > 1 ) {
+    tmp = (uint8_t*) qio_malloc(QIO_SWAP_CHUNK);
+    if( ! tmp ) {
+      *amt_written = 0;
+      return QIO_ENOMEM;
+    }
+  }
+
+  while( done < len ) {
+    const void* src = VOID_PTR_ADD(ptr, done);
+    int64_t amt = len - done;
+
+    if( tmp ) {
+      // keep whole elements in each chunk.
+      if( amt > QIO_SWAP_CHUNK ) amt = QIO_SWAP_CHUNK - QIO_SWAP_CHUNK % swap_size;
+      qio_memcpy(tmp, src, amt);
+      _qio_swap_elements(tmp, amt, swap_size);
+      src = tmp;
+    }
+
+    num_written = 0;
+    err = qio_int_to_err(sys_pwrite(f->fd, src, amt, offset + done, &num_written));
+    if( err ) break;
+    done += num_written;
+  }
+
+  qio_free(tmp);
+
+  *amt_written = done;
+  return err;
+}
+
+qioerr qio_file_pread_amt(qio_file_t* f, void* ptr, int64_t len, int64_t offset, ssize_t swap_size)
+{
+  int64_t amt_read;
+  return _qio_file_pread_amt(f, ptr, len, offset, swap_size, &amt_read);
+}
+
+qioerr qio_file_pwrite_amt(qio_file_t* f, const void* ptr, int64_t len, int64_t offset, ssize_t swap_size)
+{
+  int64_t amt_written;
+  return _qio_file_pwrite_amt(f, ptr, len, offset, swap_size, &amt_written);
+}
+
+static
+qioerr _qio_channel_direct_start_unlocked(qio_channel_t* ch, int64_t len, int64_t* offset_out)
+{
+  qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
+  int64_t pos;
+  qioerr err;
+
+  if( ch->mark_cur != 0 ||
+      ch->bit_buffer_bits != 0 ||
+      ch->file == NULL ||
+      ch->file->fd == -1 ||
+      (ch->hints & QIO_HINT_DIRECT) ||
+      ! (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_URING) ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "channel does not support direct transfers");
+  }
+
+  pos = qio_channel_offset_unlocked(ch);
+  if( pos < ch->start_pos || pos + len > ch->end_pos ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "direct transfer outside of channel region");
+  }
+
+  if( qbuffer_is_initialized(&ch->buf) ) {
+    // Write out anything before the current position...
+    _qio_buffered_advance_cached(ch);
+    err = _qio_buffered_behind(ch, true);
+    if( err ) return err;
+    _qio_buffered_advance_cached(ch);
+
+    // ... and throw away anything after it (read-ahead or space
+    // for writing), since the transfer will replace it.
+    qbuffer_trim_back(&ch->buf, qbuffer_end_offset(&ch->buf) - pos);
+    if( ch->av_end > pos ) ch->av_end = pos;
+    ch->cached_cur = NULL;
+    ch->cached_end = NULL;
+    ch->cached_start = NULL;
+  }
+
+  *offset_out = pos;
+  return 0;
+}
+
+static
+void _qio_channel_direct_end_unlocked(qio_channel_t* ch, int64_t len)
+{
+  int64_t pos;
+
+  _add_right_mark_start(ch, len);
+  pos = _right_mark_start(ch);
+
+  if( qbuffer_is_initialized(&ch->buf) ) {
+    // The buffer is empty, so it can just move along.
+    qbuffer_reposition(&ch->buf, pos);
+    ch->av_end = pos;
+    _qio_buffered_setup_cached(ch);
+  }
+}
+
+qioerr qio_channel_direct_start(const int threadsafe, qio_channel_t* ch, int64_t len, int64_t* offset_out)
+{
+  qioerr err;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  err = _qio_channel_direct_start_unlocked(ch, len, offset_out);
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+void qio_channel_direct_end(const int threadsafe, qio_channel_t* ch, int64_t len)
+{
+  if( threadsafe ) {
+    qioerr err = qio_lock(&ch->lock);
+    if( err ) return;
+  }
+
+  _qio_channel_direct_end_unlocked(ch, len);
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+}
+
+qioerr qio_channel_read_bulk(const int threadsafe, qio_channel_t* ch, void* ptr, ssize_t len, ssize_t swap_size)
+{
+  qioerr err;
+  int64_t offset;
+  int64_t amt_read;
+
+  if( len < QIO_DIRECT_TRANSFER_MIN ) {
+    // Small enough to go through the buffer.
+    err = qio_channel_read_amt(threadsafe, ch, ptr, len);
+    if( ! err && swap_size > 1 ) _qio_swap_elements(ptr, len, swap_size);
+    return err;
+  }
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  if( ! (ch->flags & QIO_FDFLAG_READABLE ) ) {
+    QIO_GET_CONSTANT_ERROR(err, EBADF, "not readable");
+  } else if( _qio_channel_direct_start_unlocked(ch, len, &offset) == 0 ) {
+    err = _qio_file_pread_amt(ch->file, ptr, len, offset, swap_size, &amt_read);
+    _qio_channel_direct_end_unlocked(ch, amt_read);
+    if( qio_err_to_int(err) == EEOF ) {
+      // make the EOF sticky, as _qio_slow_read does.
+      ch->end_pos = offset + amt_read;
+    }
+  } else {
+    err = qio_channel_read_amt(false, ch, ptr, len);
+    if( ! err && swap_size > 1 ) _qio_swap_elements(ptr, len, swap_size);
+  }
+
+  _qio_channel_set_error_unlocked(ch, err);
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+qioerr qio_channel_write_bulk(const int threadsafe, qio_channel_t* ch, const void* ptr, ssize_t len, ssize_t swap_size)
+{
+  qioerr err;
+  int64_t offset;
+  int64_t amt_written;
+
+  if( len < QIO_DIRECT_TRANSFER_MIN && swap_size <= 1 ) {
+    return qio_channel_write_amt(threadsafe, ch, ptr, len);
+  }
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  if( ! (ch->flags & QIO_FDFLAG_WRITEABLE ) ) {
+    QIO_GET_CONSTANT_ERROR(err, EBADF, "not writeable");
+  } else if( len >= QIO_DIRECT_TRANSFER_MIN &&
+             _qio_channel_direct_start_unlocked(ch, len, &offset) == 0 ) {
+    err = _qio_file_pwrite_amt(ch->file, ptr, len, offset, swap_size, &amt_written);
+    _qio_channel_direct_end_unlocked(ch, amt_written);
+  } else if( swap_size <= 1 ) {
+    err = qio_channel_write_amt(false, ch, ptr, len);
+  } else {
+    // Swap the data a chunk at a time on its way into the buffer.
+    uint8_t* tmp = (uint8_t*) qio_malloc(QIO_SWAP_CHUNK);
+    ssize_t done = 0;
+
+    err = 0;
+    if( ! tmp ) err = QIO_ENOMEM;
+
+    while( ! err && done < len ) {
+      ssize_t amt = len - done;
+      if( amt > QIO_SWAP_CHUNK ) amt = QIO_SWAP_CHUNK - QIO_SWAP_CHUNK % swap_size;
+      qio_memcpy(tmp, VOID_PTR_ADD(ptr, done), amt);
+      _qio_swap_elements(tmp, amt, swap_size);
+      err = qio_channel_write_amt(false, ch, tmp, amt);
+      done += amt;
+    }
+
+    qio_free(tmp);
+  }
+
+  _qio_channel_set_error_unlocked(ch, err);
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
 // Only returns locking errors (ie when threadsafe=true).
 qioerr qio_channel_offset(const int threadsafe, qio_channel_t* ch, int64_t* offset_out)
 {
@@ -3048,7 +3724,7 @@ qioerr _qio_channel_put_bytes_unlocked(qio_channel_t* ch, qbytes_t* bytes, int64
 
   // If we're using MEMORY, lock the file
   if( method == QIO_METHOD_MEMORY ) {
-    err = qio_lock(&ch->file->lock);
+    err = qio_lock_exclusive(&ch->file->lock);
     if( err ) return err;
   }
 
@@ -3116,7 +3792,7 @@ qioerr _qio_channel_put_bytes_unlocked(qio_channel_t* ch, qbytes_t* bytes, int64
 
 error:
   if( method == QIO_METHOD_MEMORY ) {
-    qio_unlock(&ch->file->lock);
+    qio_unlock_exclusive(&ch->file->lock);
   }
 
   if( err ) return err;
@@ -3187,7 +3863,7 @@ qioerr _qio_channel_put_buffer_unlocked(qio_channel_t* ch, qbuffer_t* src, qbuff
 
   // If we're using MEMORY, lock the file
   if( method == QIO_METHOD_MEMORY ) {
-    err = qio_lock(&ch->file->lock);
+    err = qio_lock_exclusive(&ch->file->lock);
     if( err ) return err;
   }
 
@@ -3260,7 +3936,7 @@ qioerr _qio_channel_put_buffer_unlocked(qio_channel_t* ch, qbuffer_t* src, qbuff
 
 error:
   if( method == QIO_METHOD_MEMORY ) {
-    qio_unlock(&ch->file->lock);
+    qio_unlock_exclusive(&ch->file->lock);
   }
 
   if( err ) return err;
@@ -18,11 +18,23 @@
  */
 
 
+// The intrinsics headers declare _mm_malloc, which uses malloc, so they
+// have to come before the runtime header (and its malloc warning macros),
+// but after sys_basic.h sets up the feature-test macros.
+#include "sys_basic.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifndef CHPL_RT_UNIT_TEST
 #include "chplrt.h"
 #endif
 
 #include "qio_formatted.h"
+#include "qio_number.h"
 
 #include <limits.h>
 #include <ctype.h>
@@ -155,6 +167,84 @@ qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict c
 
 
 
+/* Scanning kernels.
+ *
+ * These look through the bytes in a channel's cached buffer
+ * (cached_cur..cached_end) in bulk, instead of one call to
+ * qio_channel_read_uint8/qio_channel_read_char per byte. Whenever a
+ * kernel stops, or the cached buffer runs out, the callers go back to
+ * the normal per-character path. That path handles refilling the
+ * buffer, multibyte characters and error reporting.
+ *
+ * _qio_scan_stop returns the offset of the first byte in p[0..len)
+ * that is any of:
+ *  - >= 0x80, i.e. part of a multibyte UTF-8 character,
+ *  - equal to a or b (pass 0x80 to not match anything more),
+ *  - <= 0x20, i.e. a space or control character, if ctl is set;
+ * or len if there is no such byte. Since it always stops at bytes
+ * >= 0x80, any run it skips over is plain ASCII in both the UTF-8
+ * and ASCII locales.
+ */
+static inline
+size_t _qio_scan_stop(const uint8_t* restrict p, size_t len, uint8_t a, uint8_t b, int ctl)
+{
+  size_t i = 0;
+  int mask;
+
+#if defined(__AVX2__)
+  {
+    const __m256i va = _mm256_set1_epi8((char) a);
+    const __m256i vb = _mm256_set1_epi8((char) b);
+    const __m256i vsp = _mm256_set1_epi8(0x21);
+    for( ; i + 32 <= len; i += 32 ) {
+      __m256i x = _mm256_loadu_si256((const __m256i*) (p + i));
+      __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(x, va),
+                                  _mm256_cmpeq_epi8(x, vb));
+      // bytes >= 0x80 have the high bit set already.
+      m = _mm256_or_si256(m, x);
+      // bytes >= 0x80 are negative here, which is fine.
+      if( ctl ) m = _mm256_or_si256(m, _mm256_cmpgt_epi8(vsp, x));
+      mask = _mm256_movemask_epi8(m);
+      if( mask ) return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i va = _mm_set1_epi8((char) a);
+    const __m128i vb = _mm_set1_epi8((char) b);
+    const __m128i vsp = _mm_set1_epi8(0x21);
+    for( ; i + 16 <= len; i += 16 ) {
+      __m128i x = _mm_loadu_si128((const __m128i*) (p + i));
+      __m128i m = _mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb));
+      m = _mm_or_si128(m, x);
+      if( ctl ) m = _mm_or_si128(m, _mm_cmplt_epi8(x, vsp));
+      mask = _mm_movemask_epi8(m);
+      if( mask ) return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for( ; i < len; i++ ) {
+    uint8_t c = p[i];
+    if( c >= 0x80 || c == a || c == b || (ctl && c <= 0x20) ) return i;
+  }
+
+  (void) mask;
+  return len;
+}
+
+// Can we scan the cached buffer as bytes when reading characters?
+static inline
+int _qio_can_scan_bytes(void)
+{
+  if( qio_glocale_utf8 == 0 ) {
+    qio_set_glocale();
+  }
+  return qio_glocale_utf8 == QIO_GLOCALE_UTF8 ||
+         qio_glocale_utf8 == QIO_GLOCALE_ASCII;
+}
+
 static
 qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t* restrict amt_read_out, int* restrict found_term_out)
 {
@@ -163,7 +253,9 @@ qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t*
   int64_t end_offset = 0;
   uint64_t num = 0;
   uint8_t byte = 0;
-  int found_term;
+  int found_term = 0;
+  ssize_t avail;
+  void* found;
 
   mark_offset = qio_channel_offset_unlocked(ch);
 
@@ -171,14 +263,27 @@ qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t*
   if( err ) return err;
 
   while( 1 ) {
+    // Search whatever is already buffered.
+    avail = VOID_PTR_DIFF(ch->cached_end, ch->cached_cur);
+    if( avail > 0 ) {
+      found = memchr(ch->cached_cur, term_byte, avail);
+      if( found ) {
+        ch->cached_cur = VOID_PTR_ADD(found, 1);
+        found_term = 1;
+        break;
+      }
+      ch->cached_cur = ch->cached_end;
+    }
+
+    // Read a byte the slow way to get more buffered.
     err = qio_channel_read_uint8(false, ch, &byte);
     if( err ) break;
-    if( byte == term_byte ) break;
+    if( byte == term_byte ) {
+      found_term = 1;
+      break;
+    }
   }
 
-  if( byte == term_byte ) found_term = 1;
-  else found_term = 0;
-
   end_offset = qio_channel_offset_unlocked(ch);
 
   qio_channel_revert_unlocked(ch);
@@ -321,6 +426,44 @@ qioerr _append_char(char* restrict * restrict buf, size_t* restrict buf_len, siz
   return 0;
 }
 
+// like _append_char, but appends len bytes that are already encoded.
+static
+qioerr _append_bytes(char* restrict * restrict buf, size_t* restrict buf_len, size_t* restrict buf_max, const void* restrict ptr, size_t len)
+{
+  char* buf_in = *buf;
+  size_t len_in = *buf_len;
+  size_t max_in = *buf_max;
+  char* newbuf;
+  size_t newsz;
+  size_t need;
+
+  need = len_in + len + 1;
+  if( need < len_in || need > (SSIZE_MAX-1) ) {
+    // Too big.
+    QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "");
+  }
+  // First, make sure that there is room.
+  if( need >= max_in ) {
+    // Reallocate buffer.
+    newsz = 2 * max_in;
+    if( newsz < 16  ) newsz = 16;
+    if( newsz < need  ) newsz = need;
+    newbuf = qio_realloc(buf_in, newsz);
+    if( ! newbuf ) return QIO_ENOMEM;
+    buf_in = newbuf;
+    max_in = newsz;
+  }
+
+  qio_memcpy(&buf_in[len_in], ptr, len);
+  len_in += len;
+
+  *buf = buf_in;
+  *buf_len = len_in;
+  *buf_max = max_in;
+
+  return 0;
+}
+
 // string binary style:
 // QIO_BINARY_STRING_STYLE_LEN1B_DATA -1 -- 1 byte of length before
 // QIO_BINARY_STRING_STYLE_LEN2B_DATA -2 -- 2 bytes of length before
@@ -483,10 +626,11 @@ qioerr qio_channel_scan_string(const int threadsafe, qio_channel_t* restrict ch,
   ssize_t nread = 0;
   int64_t mark_offset;
   int64_t end_offset;
+  int scan_bytes;
+  uint8_t stop_a, stop_b;
+  ssize_t avail, span;
 
-  if( qio_glocale_utf8 == 0 ) {
-    qio_set_glocale();
-  }
+  scan_bytes = _qio_can_scan_bytes();
 
   if( maxlen <= 0 ) maxlen = SSIZE_MAX - 1;
 
@@ -551,8 +695,32 @@ qioerr qio_channel_scan_string(const int threadsafe, qio_channel_t* restrict ch,
     stop_space = 0;
   }
 
+  // The bytes that end a plain run of characters, for _qio_scan_stop
+  // (0x80 is stopped at anyway, so it means 'nothing else').
+  stop_a = 0x80;
+  stop_b = 0x80;
+  if( !stop_space && 0 <= term_chr && term_chr < 0x80 ) stop_a = term_chr;
+  if( handle_back ) stop_b = '\\';
+
   err = 0;
   for( nread = 0; nread < maxlen && !err; nread++ ) {
+    if( scan_bytes && nread > 0 ) {
+      // Copy a run of plain ASCII characters straight from the buffer.
+      avail = VOID_PTR_DIFF(ch->cached_end, ch->cached_cur);
+      if( avail > maxlen - nread ) avail = maxlen - nread;
+      if( avail > 0 ) {
+        span = _qio_scan_stop((const uint8_t*) ch->cached_cur, avail,
+                              stop_a, stop_b, stop_space);
+        if( span > 0 ) {
+          err = _append_bytes(&ret, &ret_len, &ret_max, ch->cached_cur, span);
+          if( err ) break;
+          ch->cached_cur = VOID_PTR_ADD(ch->cached_cur, span);
+          nread += span;
+          if( nread >= maxlen ) break;
+        }
+      }
+    }
+
     err = qio_channel_read_char(false, ch, &chr);
     if( err ) break;
 
@@ -1743,6 +1911,161 @@ error:
 }
 
 
+/* Fast paths for reading numbers.
+ *
+ * When a channel uses the default style for decimal numbers and the
+ * whole number is already in the channel's cached buffer, these
+ * convert it in place with the kernels in qio_number.c. That skips
+ * _peek_number_unlocked, the temporary buffer and strtoull/strtod.
+ * They return 0 without consuming anything for anything unusual, and
+ * the general code handles it. Unusual cases include other bases, 0x
+ * prefixes, inf/nan, very long numbers, and numbers that might
+ * continue past the end of the buffer.
+ */
+static inline
+int _qio_isspace_byte(uint8_t c)
+{
+  return c == ' ' || ('\t' <= c && c <= '\r');
+}
+static inline
+int _qio_isdigit_byte(uint8_t c)
+{
+  return '0' <= c && c <= '9';
+}
+static inline
+int _qio_isalnum_byte(uint8_t c)
+{
+  return _qio_isdigit_byte(c) || ('a' <= (c | 0x20) && (c | 0x20) <= 'z');
+}
+
+static
+int _qio_scan_int_fast(qio_channel_t* restrict ch, int issigned, uint64_t* restrict num_out, int* restrict negative_out)
+{
+  qio_style_t* style = &ch->style;
+  const uint8_t* p = ch->cached_cur;
+  const uint8_t* end = ch->cached_end;
+  uint64_t num = 0;
+  size_t ndigits;
+  int negative = 0;
+
+  if( !(style->base == 0 || style->base == 10) ||
+      style->positive_char != '+' || style->negative_char != '-' ||
+      ! _qio_can_scan_bytes() ) {
+    return 0;
+  }
+
+  while( p < end && _qio_isspace_byte(*p) ) p++;
+  if( p == end ) return 0;
+
+  if( issigned && *p == '-' ) {
+    negative = 1;
+    p++;
+  } else if( style->showplus == 1 && *p == '+' ) {
+    p++;
+  }
+
+  ndigits = qio_scan_dec_digits(p, end - p, QIO_MAX_EXACT_DECIMAL_DIGITS, &num);
+  if( ndigits == 0 ) return 0;
+  p += ndigits;
+
+  // The number has to end inside the buffer, and not with something
+  // (another digit, 0x...) that the general code would handle.
+  if( p == end || _qio_isalnum_byte(*p) ) return 0;
+
+  ch->cached_cur = (void*) p;
+  *num_out = num;
+  *negative_out = negative;
+  return 1;
+}
+
+static
+int _qio_scan_float_fast(qio_channel_t* restrict ch, double* restrict out)
+{
+  qio_style_t* style = &ch->style;
+  const uint8_t* p = ch->cached_cur;
+  const uint8_t* end = ch->cached_end;
+  uint64_t mantissa = 0;
+  uint64_t exp_num = 0;
+  int64_t exp10 = 0;
+  size_t n;
+  size_t nsig = 0;
+  int any_digits = 0;
+  int negative = 0;
+  int exp_negative = 0;
+
+  if( !(style->base == 0 || style->base == 10) ||
+      style->positive_char != '+' || style->negative_char != '-' ||
+      style->point_char != '.' || tolower(style->exponent_char) != 'e' ||
+      ! _qio_can_scan_bytes() ) {
+    return 0;
+  }
+
+  while( p < end && _qio_isspace_byte(*p) ) p++;
+  if( p == end ) return 0;
+
+  if( *p == '-' ) {
+    negative = 1;
+    p++;
+  } else if( *p == '+' ) {
+    p++;
+  }
+
+  // Digits before the point; leading zeros don't count towards the
+  // 19 we can hold.
+  while( p < end && *p == '0' ) {
+    any_digits = 1;
+    p++;
+  }
+  n = qio_scan_dec_digits(p, end - p, QIO_MAX_EXACT_DECIMAL_DIGITS, &mantissa);
+  p += n;
+  nsig += n;
+  if( n ) any_digits = 1;
+  if( p < end && _qio_isdigit_byte(*p) ) return 0;
+
+  // Digits after the point.
+  if( p < end && *p == '.' ) {
+    p++;
+    if( nsig == 0 ) {
+      while( p < end && *p == '0' ) {
+        any_digits = 1;
+        exp10--;
+        p++;
+      }
+    }
+    n = qio_scan_dec_digits(p, end - p, QIO_MAX_EXACT_DECIMAL_DIGITS - nsig, &mantissa);
+    p += n;
+    nsig += n;
+    exp10 -= n;
+    if( n ) any_digits = 1;
+    if( p < end && _qio_isdigit_byte(*p) ) return 0;
+  }
+
+  if( ! any_digits ) return 0;
+
+  // The exponent.
+  if( p < end && (*p | 0x20) == 'e' ) {
+    p++;
+    if( p < end && *p == '-' ) {
+      exp_negative = 1;
+      p++;
+    } else if( p < end && *p == '+' ) {
+      p++;
+    }
+    n = qio_scan_dec_digits(p, end - p, 6, &exp_num);
+    if( n == 0 ) return 0;
+    p += n;
+    if( p < end && _qio_isdigit_byte(*p) ) return 0;
+    exp10 += exp_negative ? - (int64_t) exp_num : (int64_t) exp_num;
+  }
+
+  if( p == end || _qio_isalnum_byte(*p) || *p == '.' ) return 0;
+
+  if( ! qio_dec_to_double(mantissa, exp10, negative, out) ) return 0;
+
+  ch->cached_cur = (void*) p;
+  return 1;
+}
+
 qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, int issigned)
 {
   unsigned long long int num = 0;
@@ -1757,6 +2080,8 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
   MAYBE_STACK_SPACE(char, buf_onstack);
   qioerr err;
   qio_style_t* style;
+  uint64_t fast_num;
+  int fast_negative;
 
 
   if( threadsafe ) {
@@ -1768,6 +2093,13 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
 
   style = &ch->style;
 
+  if( _qio_scan_int_fast(ch, issigned, &fast_num, &fast_negative) ) {
+    num = fast_num;
+    sign = fast_negative ? -1 : 1;
+    err = 0;
+    goto error;
+  }
+
   memset(&st, 0, sizeof(number_reading_state_t));
 
   st.base = style->base;
@@ -1915,6 +2247,11 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
 
   needs_i = imag && style->complex_style == QIO_COMPLEX_FORMAT_ABI;
 
+  if( ! needs_i && _qio_scan_float_fast(ch, &num) ) {
+    err = 0;
+    goto error;
+  }
+
   memset(&st, 0, sizeof(number_reading_state_t));
 
   st.base = style->base;
@@ -2118,8 +2455,13 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 2, 0);
   else if( base == 8 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 8, 0);
-  else if( base == 10 )
-    tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 10, 0);
+  else if( base == 10 ) {
+    char dec[20];
+    int dec_len = qio_format_uint_dec(dec, num);
+    tmp[sizeof(tmp)-1] = '\0';
+    tmp_skip = sizeof(tmp) - 1 - dec_len;
+    qio_memcpy(tmp + tmp_skip, dec, dec_len);
+  }
   else if( base == 16 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 16, style->uppercase);
   else
@@ -2198,6 +2540,90 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   return i;
 }
 
+// Print num (which must not be negative) like snprintf does with %g
+// (realfmt 0) or %e (realfmt 2) and the given precision, but using
+// qio_double_to_dec. Returns the number printed (not including the
+// '\0'), or -1 if snprintf should be used instead.
+static
+int _ftoa_fast(char* restrict buf, int buf_sz, double num, int realfmt, int precision, int uppercase)
+{
+  char digits[20];
+  uint64_t dec = 0;
+  int exp10 = 0;
+  int ndigits;
+  int nd;
+  int i = 0;
+  int j;
+  int e;
+
+  if( realfmt == 0 ) {
+    ndigits = (precision < 0) ? 6 : (precision == 0) ? 1 : precision;
+  } else if( realfmt == 2 ) {
+    ndigits = ((precision < 0) ? 6 : precision) + 1;
+  } else {
+    return -1;
+  }
+
+  // Enough room for 17 digits, '.', "0.000" or "e-308", and '\0'.
+  if( ndigits > 17 || buf_sz < 32 ) return -1;
+
+  if( num == 0.0 ) {
+    memset(digits, '0', ndigits);
+  } else {
+    // (this rejects inf and NaN)
+    if( ! qio_double_to_dec(num, ndigits, &dec, &exp10) ) return -1;
+    nd = qio_format_uint_dec(digits, dec);
+    assert( nd == ndigits );
+  }
+
+  nd = ndigits;
+  if( realfmt == 0 ) {
+    // %g removes trailing zeros after the point.
+    while( nd > 1 && digits[nd-1] == '0' ) nd--;
+
+    if( -4 <= exp10 && exp10 < ndigits ) {
+      // Use %f style.
+      if( exp10 >= 0 ) {
+        qio_memcpy(buf, digits, exp10 + 1);
+        i = exp10 + 1;
+        if( nd > i ) {
+          buf[i++] = '.';
+          qio_memcpy(buf + i, digits + exp10 + 1, nd - (exp10 + 1));
+          i += nd - (exp10 + 1);
+        }
+      } else {
+        buf[i++] = '0';
+        buf[i++] = '.';
+        for( j = 0; j < -exp10 - 1; j++ ) buf[i++] = '0';
+        qio_memcpy(buf + i, digits, nd);
+        i += nd;
+      }
+      buf[i] = '\0';
+      return i;
+    }
+  }
+
+  // Use %e style.
+  buf[i++] = digits[0];
+  if( nd > 1 ) {
+    buf[i++] = '.';
+    qio_memcpy(buf + i, digits + 1, nd - 1);
+    i += nd - 1;
+  }
+  buf[i++] = uppercase ? 'E' : 'e';
+  e = exp10;
+  if( e < 0 ) {
+    buf[i++] = '-';
+    e = -e;
+  } else {
+    buf[i++] = '+';
+  }
+  if( e < 10 ) buf[i++] = '0';
+  i += qio_format_uint_dec(buf + i, e);
+  buf[i] = '\0';
+  return i;
+}
+
 // error codes:
 //  -1 for out of memory
 //  -2 for error in conversion
@@ -2249,8 +2675,15 @@ int _ftoa(char* restrict dst, size_t size, double num, int base, bool needs_i, c
     //printf("Printing with base %i type %i precision %i upper %i showp %i\n",
     //       style->base, style->realfmt, precision, style->uppercase, style->showpoint);
 
+    got = -1;
+    if( style->base != 16 && ! style->showpoint ) {
+      got = _ftoa_fast(buf, buf_sz, num, style->realfmt, precision, style->uppercase);
+    }
+
     // Figure out how big our output is...
-    if( style->base == 16 ) {
+    if( got >= 0 ) {
+      // _ftoa_fast printed it.
+    } else if( style->base == 16 ) {
       if( precision < 0 ) {
         if( style->uppercase ) {
           if( style->showpoint )
@@ -2558,6 +2991,18 @@ qioerr qio_channel_print_int(const int threadsafe, qio_channel_t* restrict ch, c
     }
   }
 
+  // With the default decimal style, just put the digits in the buffer.
+  if( base == 10 && ! style->showplus && ! style->showpoint &&
+      style->min_width_columns == 0 &&
+      VOID_PTR_DIFF(ch->cached_end,ch->cached_cur) > 21 ) {
+    char* dst = ch->cached_cur;
+    if( isneg ) *dst++ = style->negative_char;
+    dst += qio_format_uint_dec(dst, num);
+    ch->cached_cur = dst;
+    err = _qio_channel_post_cached_write(ch);
+    goto error;
+  }
+
   // Try printing it directly into the buffer.
   if( VOID_PTR_DIFF(ch->cached_end,ch->cached_cur) > max ) {
     // Print it all directly into the buffer.
@@ -2895,6 +3340,8 @@ qioerr qio_channel_skip_past_newline(const int threadsafe, qio_channel_t* restri
   qioerr err;
   int needs_backup = 0;
   int64_t lastpos;
+  int scan_bytes;
+  ssize_t avail, span;
 
   if( threadsafe ) {
     err = qio_lock(&ch->lock);
@@ -2906,7 +3353,18 @@ qioerr qio_channel_skip_past_newline(const int threadsafe, qio_channel_t* restri
     if( err ) goto unlock;
   }
 
+  scan_bytes = _qio_can_scan_bytes();
+
   while( 1 ) {
+    if( scan_bytes && ! skipOnlyWs ) {
+      // Skip over plain ASCII characters in the buffer.
+      avail = VOID_PTR_DIFF(ch->cached_end, ch->cached_cur);
+      if( avail > 0 ) {
+        span = _qio_scan_stop((const uint8_t*) ch->cached_cur, avail,
+                              '\n', 0x80, 0);
+        ch->cached_cur = VOID_PTR_ADD(ch->cached_cur, span);
+      }
+    }
     lastpos = qio_channel_offset_unlocked(ch);
     err = qio_channel_read_char(threadsafe, ch, &c);
     if( err  || c == '\n' ) break;
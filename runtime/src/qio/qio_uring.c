@@ -0,0 +1,438 @@
+/*
+ * Copyright 2004-2015 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-tasks.h"
+#endif
+
+#include "qio_uring.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define QIO_HAS_URING 1
+#endif
+#endif
+#endif
+
+#ifndef QIO_HAS_URING
+#define QIO_HAS_URING 0
+#endif
+
+#if QIO_HAS_URING
+
+#ifdef CHPL_RT_UNIT_TEST
+#include <sched.h>
+#define QIO_URING_YIELD() sched_yield()
+#else
+#define QIO_URING_YIELD() chpl_task_yield()
+#endif
+
+// How many times we yield while waiting for completions before we
+// block in the kernel instead. This keeps a lone task from spinning
+// when there is nothing else to run.
+#define QIO_URING_YIELDS 32
+
+struct qio_uring_s {
+  int fd;
+
+  // submission queue
+  void* sq_ptr;
+  size_t sq_len;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+  size_t sqes_len;
+
+  // completion queue
+  void* cq_ptr;
+  size_t cq_len;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+};
+
+typedef struct {
+  struct iovec* iov;
+  int iovcnt;
+  int64_t len;
+  int64_t offset;
+  int64_t res; // bytes transferred or -errno
+} qio_uring_req_t;
+
+static
+int sys_io_uring_setup(unsigned entries, struct io_uring_params* p)
+{
+  return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+qioerr qio_uring_create(qio_uring_t** ring_out)
+{
+  struct io_uring_params p;
+  qio_uring_t* ring;
+  int fd;
+  qioerr err;
+
+  *ring_out = NULL;
+
+  memset(&p, 0, sizeof(p));
+  fd = sys_io_uring_setup(QIO_URING_DEPTH, &p);
+  if( fd < 0 ) return qio_mkerror_errno();
+
+  ring = (qio_uring_t*) qio_calloc(1, sizeof(qio_uring_t));
+  if( ! ring ) {
+    close(fd);
+    return QIO_ENOMEM;
+  }
+
+  ring->fd = fd;
+  ring->sq_ptr = MAP_FAILED;
+  ring->cq_ptr = MAP_FAILED;
+  ring->sqes = MAP_FAILED;
+
+  ring->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+
+  ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ|PROT_WRITE,
+                      MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if( ring->sq_ptr == MAP_FAILED ) goto error;
+  ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ|PROT_WRITE,
+                      MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  if( ring->cq_ptr == MAP_FAILED ) goto error;
+  ring->sqes = (struct io_uring_sqe*) mmap(NULL, ring->sqes_len,
+                                          PROT_READ|PROT_WRITE,
+                                          MAP_SHARED|MAP_POPULATE,
+                                          fd, IORING_OFF_SQES);
+  if( ring->sqes == MAP_FAILED ) goto error;
+
+  ring->sq_head = (unsigned*) VOID_PTR_ADD(ring->sq_ptr, p.sq_off.head);
+  ring->sq_tail = (unsigned*) VOID_PTR_ADD(ring->sq_ptr, p.sq_off.tail);
+  ring->sq_mask = (unsigned*) VOID_PTR_ADD(ring->sq_ptr, p.sq_off.ring_mask);
+  ring->sq_array = (unsigned*) VOID_PTR_ADD(ring->sq_ptr, p.sq_off.array);
+  ring->cq_head = (unsigned*) VOID_PTR_ADD(ring->cq_ptr, p.cq_off.head);
+  ring->cq_tail = (unsigned*) VOID_PTR_ADD(ring->cq_ptr, p.cq_off.tail);
+  ring->cq_mask = (unsigned*) VOID_PTR_ADD(ring->cq_ptr, p.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*) VOID_PTR_ADD(ring->cq_ptr, p.cq_off.cqes);
+
+  *ring_out = ring;
+  return 0;
+
+error:
+  err = qio_mkerror_errno();
+  qio_uring_destroy(ring);
+  return err;
+}
+
+void qio_uring_destroy(qio_uring_t* ring)
+{
+  if( ! ring ) return;
+
+  if( ring->sqes != MAP_FAILED ) munmap(ring->sqes, ring->sqes_len);
+  if( ring->cq_ptr != MAP_FAILED ) munmap(ring->cq_ptr, ring->cq_len);
+  if( ring->sq_ptr != MAP_FAILED ) munmap(ring->sq_ptr, ring->sq_len);
+  close(ring->fd);
+  qio_free(ring);
+}
+
+// Collect any available completions; returns how many there were.
+static
+int qio_uring_reap(qio_uring_t* ring, qio_uring_req_t* reqs)
+{
+  unsigned head = *ring->cq_head;
+  unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+  int n = 0;
+
+  while( head != tail ) {
+    struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+    reqs[cqe->user_data].res = cqe->res;
+    head++;
+    n++;
+  }
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  return n;
+}
+
+// Submit nreq requests and wait for all of them to complete,
+// yielding while they are outstanding.
+static
+void qio_uring_run(qio_uring_t* ring, int opcode, fd_t fd, qio_uring_req_t* reqs, int nreq)
+{
+  unsigned tail = *ring->sq_tail;
+  int submitted = 0;
+  int completed = 0;
+  int yields = 0;
+  int i, got;
+
+  assert( nreq <= QIO_URING_DEPTH );
+
+  for( i = 0; i < nreq; i++ ) {
+    unsigned idx = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) reqs[i].iov;
+    sqe->len = reqs[i].iovcnt;
+    sqe->off = reqs[i].offset;
+    sqe->user_data = i;
+    ring->sq_array[idx] = idx;
+    tail++;
+  }
+  __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+  while( submitted < nreq ) {
+    got = sys_io_uring_enter(ring->fd, nreq - submitted, 0, 0);
+    if( got < 0 ) {
+      int e = errno;
+      if( e == EINTR ) continue;
+      if( (e == EAGAIN || e == EBUSY) && completed < submitted ) {
+        // Make room by collecting what has finished so far.
+        completed += qio_uring_reap(ring, reqs);
+        QIO_URING_YIELD();
+        continue;
+      }
+      // Give up on the rest: take them back off of the submission
+      // queue and just wait for the ones the kernel already has.
+      __atomic_store_n(ring->sq_tail,
+                       __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE),
+                       __ATOMIC_RELEASE);
+      for( i = submitted; i < nreq; i++ ) reqs[i].res = -e;
+      completed += nreq - submitted;
+      break;
+    }
+    submitted += got;
+  }
+
+  while( completed < nreq ) {
+    got = qio_uring_reap(ring, reqs);
+    completed += got;
+    if( completed == nreq ) break;
+    if( got == 0 ) {
+      if( yields < QIO_URING_YIELDS ) {
+        QIO_URING_YIELD();
+        yields++;
+      } else {
+        STARTING_SLOW_SYSCALL;
+        sys_io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+        DONE_SLOW_SYSCALL;
+      }
+    }
+  }
+}
+
+// Transfer the bytes described by iov starting at file offset
+// seek_to_offset, using up to QIO_URING_DEPTH requests at a time.
+static
+qioerr qio_uring_rw(qio_uring_t* ring, int opcode, fd_t fd, const struct iovec* iov_in, size_t iovcnt, int64_t seek_to_offset, ssize_t* num_out)
+{
+  qio_uring_req_t reqs[QIO_URING_DEPTH];
+  struct iovec* iov = NULL;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  int64_t total = 0;
+  int64_t per_req;
+  int64_t done = 0;
+  int64_t round_bytes;
+  size_t i = 0;     // next input iovec
+  size_t skip = 0;  // bytes of iov_in[i] already handled
+  size_t used;
+  int nreq, r;
+  int stop = 0;
+  qioerr err = 0;
+
+  for( i = 0; i < iovcnt; i++ ) total += iov_in[i].iov_len;
+
+  // Each request can split at most one input iovec, so
+  // iovcnt + QIO_URING_DEPTH entries is always enough.
+  MAYBE_STACK_ALLOC(struct iovec, iovcnt + QIO_URING_DEPTH, iov, iov_onstack);
+  if( ! iov ) {
+    *num_out = 0;
+    return QIO_ENOMEM;
+  }
+
+  per_req = (total + QIO_URING_DEPTH - 1) / QIO_URING_DEPTH;
+  if( per_req < QIO_URING_MIN_REQUEST ) per_req = QIO_URING_MIN_REQUEST;
+
+  i = 0;
+  while( i < iovcnt && ! stop ) {
+    // Build up the next round of requests.
+    nreq = 0;
+    used = 0;
+    round_bytes = 0;
+    while( nreq < QIO_URING_DEPTH && i < iovcnt ) {
+      qio_uring_req_t* req = &reqs[nreq];
+      req->iov = &iov[used];
+      req->iovcnt = 0;
+      req->len = 0;
+      req->offset = seek_to_offset + done + round_bytes;
+      req->res = 0;
+      while( i < iovcnt && req->len < per_req && req->iovcnt < IOV_MAX ) {
+        size_t take = iov_in[i].iov_len - skip;
+        if( req->len + (int64_t) take > per_req ) take = per_req - req->len;
+        iov[used].iov_base = VOID_PTR_ADD(iov_in[i].iov_base, skip);
+        iov[used].iov_len = take;
+        used++;
+        req->iovcnt++;
+        req->len += take;
+        skip += take;
+        if( skip == iov_in[i].iov_len ) {
+          i++;
+          skip = 0;
+        }
+      }
+      round_bytes += req->len;
+      nreq++;
+    }
+
+    qio_uring_run(ring, opcode, fd, reqs, nreq);
+
+    // Only count the contiguous prefix that made it.
+    for( r = 0; r < nreq; r++ ) {
+      if( reqs[r].res < 0 ) {
+        err = qio_int_to_err(-reqs[r].res);
+        stop = 1;
+        break;
+      }
+      done += reqs[r].res;
+      if( reqs[r].res < reqs[r].len ) {
+        stop = 1;
+        break;
+      }
+    }
+  }
+
+  MAYBE_STACK_FREE(iov, iov_onstack);
+
+  if( ! err && opcode == IORING_OP_READV && done == 0 && total != 0 ) {
+    err = QIO_EEOF;
+  }
+
+  *num_out = done;
+  return err;
+}
+
+#else
+
+struct qio_uring_s {
+  int unused;
+};
+
+qioerr qio_uring_create(qio_uring_t** ring_out)
+{
+  *ring_out = NULL;
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "io_uring not supported");
+}
+
+void qio_uring_destroy(qio_uring_t* ring)
+{
+  if( ring ) qio_free(ring);
+}
+
+#define IORING_OP_READV 1
+#define IORING_OP_WRITEV 2
+
+static
+qioerr qio_uring_rw(qio_uring_t* ring, int opcode, fd_t fd, const struct iovec* iov_in, size_t iovcnt, int64_t seek_to_offset, ssize_t* num_out)
+{
+  *num_out = 0;
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "io_uring not supported");
+}
+
+#endif
+
+static
+qioerr qio_uring_rw_qbuffer(qio_uring_t* ring, int opcode, fd_t fd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_out)
+{
+  int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  struct iovec* iov = NULL;
+  size_t iovcnt;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  qioerr err;
+
+  *num_out = 0;
+
+  if( num_bytes < 0 || num_parts < 0 || num_parts > INT_MAX ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
+  }
+
+  MAYBE_STACK_ALLOC(struct iovec, num_parts, iov, iov_onstack);
+  if( ! iov ) return QIO_ENOMEM;
+
+  err = qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt);
+  if( ! err ) {
+    err = qio_uring_rw(ring, opcode, fd, iov, iovcnt, seek_to_offset, num_out);
+  }
+
+  MAYBE_STACK_FREE(iov, iov_onstack);
+
+  return err;
+}
+
+qioerr qio_uring_preadv(qio_uring_t* ring, fd_t fd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return qio_uring_rw_qbuffer(ring, IORING_OP_READV, fd, buf, start, end, seek_to_offset, num_read);
+}
+
+qioerr qio_uring_pwritev(qio_uring_t* ring, fd_t fd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return qio_uring_rw_qbuffer(ring, IORING_OP_WRITEV, fd, buf, start, end, seek_to_offset, num_written);
+}
+
+qioerr qio_uring_pread(qio_uring_t* ring, fd_t fd, void* ptr, ssize_t len, int64_t seek_to_offset, ssize_t* num_read)
+{
+  struct iovec iov;
+  iov.iov_base = ptr;
+  iov.iov_len = len;
+  return qio_uring_rw(ring, IORING_OP_READV, fd, &iov, 1, seek_to_offset, num_read);
+}
+
+qioerr qio_uring_pwrite(qio_uring_t* ring, fd_t fd, const void* ptr, ssize_t len, int64_t seek_to_offset, ssize_t* num_written)
+{
+  struct iovec iov;
+  iov.iov_base = (void*) ptr;
+  iov.iov_len = len;
+  return qio_uring_rw(ring, IORING_OP_WRITEV, fd, &iov, 1, seek_to_offset, num_written);
+}
@@ -23,6 +23,7 @@
 
 #include "chplrt.h"
 #include "chpl_rt_utils_static.h"
+#include "chpl-atomics.h"
 #include "chplcgfns.h"
 #include "chpl-comm.h"
 #include "chplexit.h"
@@ -37,6 +38,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -56,6 +58,9 @@ typedef struct task_pool_struct {
   void*            arg;          // argument to the function
   chpl_bool        begun;        // whether execution of this task has begun
   chpl_task_list_p ltask;        // points to the task list entry, if there is one
+  atomic_int_least32_t ws_claimed; // set by the thread that runs the task
+  atomic_int_least32_t ws_refs;  // deque and task list references to the
+                                 //   task (work-stealing scheduling only)
   c_string         filename;
   int              lineno;
   chpl_task_prvDataImpl_t chpl_data;
@@ -100,20 +105,63 @@ typedef struct lockReport {
 } lockReport_t;
 
 
+//
+// Work-stealing task deques.
+//
+// Under the work-stealing scheduling policy each thread that creates
+// tasks owns a Chase-Lev deque of them, rather than adding them to the
+// shared task pool.  The owning thread pushes and pops at the bottom
+// (LIFO), other threads steal from the top (FIFO), and none of these
+// operations take a lock.  When a deque fills up its owner replaces
+// the slot array with one twice as big.  Thieves may still be looking
+// at the old array, so we keep it around until the program exits.
+//
+typedef struct ws_deque_array* ws_deque_array_p;
+
+struct ws_deque_array {
+  int64_t           size;         // number of slots, a power of 2
+  ws_deque_array_p  retired;      // smaller array this one replaced
+  volatile task_pool_p slot[];
+};
+
+typedef struct ws_deque* ws_deque_p;
+
+struct ws_deque {
+  atomic_int_least64_t top;       // index of the next task to steal
+  atomic_int_least64_t bottom;    // index of the next free slot
+  atomic_uintptr_t     array;     // current ws_deque_array_p
+  ws_deque_p           next;      // next deque in ws_deque_list
+};
+
+#define WS_DEQUE_INITIAL_SIZE 256
+
+
 // This is the data that is private to each thread.
 typedef struct {
   task_pool_p   ptask;
   lockReport_t* lockRprt;
+  ws_deque_p    deque;            // work-stealing scheduling only
 } thread_private_data_t;
 
 
+//
+// Task scheduling policies.  The default is the original one, a single
+// task pool shared by all threads.  The work-stealing policy can be
+// selected at execution time by setting CHPL_RT_TASK_SCHEDULER.
+//
+typedef enum {
+  sched_fifo,
+  sched_workstealing
+} sched_policy_t;
+
+static sched_policy_t   sched_policy = sched_fifo;
+
+
 static chpl_bool        initialized = false;
 
 static volatile chpl_bool canCountRunningTasks = false;
 
 static chpl_thread_mutex_t threading_lock;     // critical section lock
-static chpl_thread_mutex_t extra_task_lock;    // critical section lock
-static chpl_thread_mutex_t task_id_lock;       // critical section lock
 static chpl_thread_mutex_t task_list_lock;     // critical section lock
 static volatile task_pool_p
                            task_pool_head;     // head of task pool
@@ -122,7 +170,7 @@ static volatile task_pool_p
 
 static int                 queued_task_cnt;    // number of tasks in task pool
 static int                 running_task_cnt;   // number of running tasks
-static int64_t             extra_task_cnt;     // number of tasks being run by
+static atomic_int_least64_t extra_task_cnt;    // number of tasks being run by
                                                //   threads occupied already
 static int                 waking_thread_cnt;  // number of threads created but
                                                //   not yet running
@@ -137,16 +185,36 @@ static chpl_thread_mutex_t block_report_lock;   // critical section lock
 static lockReport_t* lockReportHead = NULL;
 static lockReport_t* lockReportTail = NULL;
 
+static atomic_uint_least64_t next_task_id;     // next task ID to hand out
+
 static chpl_bool do_taskReport = false;
-static chpl_thread_mutex_t taskTable_lock;     // critical section lock
+static int32_t             taskTable_num_shards; // task table shard count
+static chpl_thread_mutex_t* taskTable_locks;   // one lock per shard
 
 static c_string idleTaskName = "|idle|";
 
+//
+// Work-stealing scheduler state.  The list of deques only grows, and
+// then only by pushing onto its head, so thieves can walk it without
+// any locking.  Thread creation is the only thing that takes a lock,
+// and that only happens when no idle thread is available.
+//
+static atomic_uintptr_t     ws_deque_list;      // all task deques
+static atomic_int_least64_t ws_queued_cnt;      // number of unclaimed tasks
+                                                //   in deques
+static atomic_int_least32_t ws_idle_cnt;        // number of threads looking
+                                                //   for work
+static chpl_thread_mutex_t  ws_thread_create_lock;
+
 static chpl_fn_p comm_task_fn;
 
 static void                    comm_task_wrapper(void*);
 static void                    movedTaskWrapper(void* a);
 static chpl_taskID_t           get_next_task_id(void);
+static void                    taskTable_add(task_pool_p);
+static void                    taskTable_remove(chpl_taskID_t);
+static void                    taskTable_set_active(chpl_taskID_t);
+static void                    taskTable_set_suspended(chpl_taskID_t);
 static thread_private_data_t*  get_thread_private_data(void);
 static task_pool_p             get_current_ptask(void);
 static void                    set_current_ptask(task_pool_p);
@@ -164,10 +232,29 @@ static void                    begin_task(chpl_fn_p, void*,
                                           chpl_task_list_p);
 static void                    launch_next_task_in_new_thread(void);
 static void                    schedule_next_task(int);
+static task_pool_p             create_ptask(chpl_fn_p,
+                                            void*,
+                                            chpl_task_prvDataImpl_t,
+                                            chpl_task_list_p);
 static task_pool_p             add_to_task_pool(chpl_fn_p,
                                                 void*,
                                                 chpl_task_prvDataImpl_t,
                                                 chpl_task_list_p);
+static void                    run_nested_task(task_pool_p);
+static void                    get_sched_policy(void);
+static ws_deque_p              ws_deque_new(void);
+static void                    ws_deque_push(ws_deque_p, task_pool_p);
+static task_pool_p             ws_deque_pop(ws_deque_p);
+static task_pool_p             ws_deque_steal(ws_deque_p);
+static void                    ws_push_task(task_pool_p);
+static void                    ws_free_deques(void);
+static task_pool_p             ws_remove_task(ws_deque_p);
+static task_pool_p             ws_find_task(ws_deque_p);
+static chpl_bool               ws_claim_task(task_pool_p);
+static void                    ws_release_task(task_pool_p);
+static void                    ws_schedule_tasks(int);
+static void                    ws_execute_tasks_in_list(chpl_task_list_p);
+static void                    ws_thread_loop(thread_private_data_t*);
 
 //
 // Condition variable methods
@@ -319,17 +406,24 @@ void chpl_sync_destroyAux(chpl_sync_aux_t *s) { }
 
 void chpl_task_init(void) {
   chpl_thread_mutexInit(&threading_lock);
-  chpl_thread_mutexInit(&extra_task_lock);
-  chpl_thread_mutexInit(&task_id_lock);
   chpl_thread_mutexInit(&task_list_lock);
+  atomic_init_uint_least64_t(&next_task_id, chpl_nullTaskID + 1);
   queued_task_cnt = 0;
   running_task_cnt = 1;                     // only main task running
   waking_thread_cnt = 0;
   blocked_thread_cnt = 0;
   idle_thread_cnt = 0;
-  extra_task_cnt = 0;
+  atomic_init_int_least64_t(&extra_task_cnt, 0);
   task_pool_head = task_pool_tail = NULL;
 
+  get_sched_policy();
+  if (sched_policy == sched_workstealing) {
+    atomic_init_uintptr_t(&ws_deque_list, (uintptr_t) NULL);
+    atomic_init_int_least64_t(&ws_queued_cnt, 0);
+    atomic_init_int_least32_t(&ws_idle_cnt, 0);
+    chpl_thread_mutexInit(&ws_thread_create_lock);
+  }
+
   chpl_thread_init(thread_begin, thread_end);
 
   //
@@ -361,6 +455,9 @@ void chpl_task_init(void) {
     tp->ptask->lineno       = 0;
     tp->ptask->next         = NULL;
     tp->lockRprt            = NULL;
+    tp->deque               = (sched_policy == sched_workstealing)
+                              ? ws_deque_new()
+                              : NULL;
 
     // Set up task-private data for locale (architectural) support.
     tp->ptask->chpl_data.prvdata.serial_state = true;     // Set to false in chpl_task_callMain().
@@ -387,6 +484,9 @@ void chpl_task_exit(void) {
     return;
 
   chpl_thread_exit();
+
+  if (sched_policy == sched_workstealing)
+    ws_free_deques();
 }
 
 
@@ -413,17 +513,23 @@ void chpl_task_stdModulesInitialized(void) {
   //
 
   //
-  // Register this main task in the task table.
+  // Set up the task table shard locks and register this main task in
+  // the task table.
   //
   if (taskreport) {
     thread_private_data_t* tp = chpl_thread_getPrivateData();
-
-    chpldev_taskTable_add(tp->ptask->id,
-                          tp->ptask->lineno, tp->ptask->filename,
-                          (uint64_t) (intptr_t) tp->ptask);
-    chpldev_taskTable_set_active(tp->ptask->id);
-
-    chpl_thread_mutexInit(&taskTable_lock);
+    int32_t i;
+
+    taskTable_num_shards = chpldev_taskTable_num_shards();
+    taskTable_locks =
+      (chpl_thread_mutex_t*) chpl_mem_allocMany(taskTable_num_shards,
+                                                sizeof(chpl_thread_mutex_t),
+                                                CHPL_RT_MD_MUTEX, 0, 0);
+    for (i = 0; i < taskTable_num_shards; i++)
+      chpl_thread_mutexInit(&taskTable_locks[i]);
+
+    taskTable_add(tp->ptask);
+    taskTable_set_active(tp->ptask->id);
   }
 
   //
@@ -464,6 +570,7 @@ static void comm_task_wrapper(void* arg) {
   tp->ptask->chpl_data.prvdata.serial_state = true;
 
   tp->lockRprt = NULL;
+  tp->deque = NULL;
 
   chpl_thread_setPrivateData(tp);
 
@@ -553,7 +660,21 @@ void chpl_task_processTaskList(chpl_task_list_p task_list) {
     chpl_task_list_p first_task = next_task;
     next_task = next_task->next;
 
-    if (first_task != task_list) {
+    if (first_task != task_list
+        && sched_policy == sched_workstealing) {
+      // there are at least two tasks in task_list
+      do {
+        ltask = next_task;
+        ltask->ptask = create_ptask(ltask->fun, ltask->arg,
+                                    ltask->chpl_data, ltask);
+        next_task = ltask->next;
+        ws_push_task(ltask->ptask);
+        task_cnt++;
+      } while (ltask != task_list);
+
+      ws_schedule_tasks(task_cnt);
+    }
+    else if (first_task != task_list) {
       // there are at least two tasks in task_list
 
       // begin critical section
@@ -589,41 +710,23 @@ void chpl_task_processTaskList(chpl_task_list_p task_list) {
     set_current_ptask(&nested_task);
 
     if (do_taskReport) {
-      chpl_thread_mutexLock(&taskTable_lock);
-      chpldev_taskTable_add(nested_task.id,
-                            nested_task.lineno, nested_task.filename,
-                            (uint64_t) (intptr_t) &nested_task);
-      chpldev_taskTable_set_suspended(curr_ptask->id);
-      chpldev_taskTable_set_active(nested_task.id);
-      chpl_thread_mutexUnlock(&taskTable_lock);
+      taskTable_add(&nested_task);
+      taskTable_set_suspended(curr_ptask->id);
+      taskTable_set_active(nested_task.id);
     }
 
-    // begin critical section
-    chpl_thread_mutexLock(&extra_task_lock);
-
-    extra_task_cnt++;
-
-    // end critical section
-    chpl_thread_mutexUnlock(&extra_task_lock);
+    (void) atomic_fetch_add_int_least64_t(&extra_task_cnt, 1);
 
     if (blockreport)
       initializeLockReportForThread();
 
     (*first_task->fun)(first_task->arg);
 
-    // begin critical section
-    chpl_thread_mutexLock(&extra_task_lock);
-
-    extra_task_cnt--;
-
-    // end critical section
-    chpl_thread_mutexUnlock(&extra_task_lock);
+    (void) atomic_fetch_sub_int_least64_t(&extra_task_cnt, 1);
 
     if (do_taskReport) {
-      chpl_thread_mutexLock(&taskTable_lock);
-      chpldev_taskTable_set_active(curr_ptask->id);
-      chpldev_taskTable_remove(nested_task.id);
-      chpl_thread_mutexUnlock(&taskTable_lock);
+      taskTable_set_active(curr_ptask->id);
+      taskTable_remove(nested_task.id);
     }
 
     set_current_ptask(curr_ptask);
@@ -645,25 +748,28 @@ void chpl_task_executeTasksInList(chpl_task_list_p task_list) {
 
   // If the serial state is true, the tasks in task_list have already been
   // executed.
-  if (!chpl_task_getSerial()) do {
+  if (chpl_task_getSerial())
+    return;
+
+  if (sched_policy == sched_workstealing) {
+    ws_execute_tasks_in_list(task_list);
+    return;
+  }
+
+  do {
     ltask = next_task;
     next_task = ltask->next;
 
     // don't lock unless it looks like we will find a task to execute
     // if we do so
     if (ltask->ptask) {
-      task_pool_p  curr_ptask;
       task_pool_p  nested_ptask = NULL;
-      chpl_fn_p    task_to_run_fun = NULL;
-      void*        task_to_run_arg = NULL;
 
       // begin critical section
       chpl_thread_mutexLock(&threading_lock);
 
       if (ltask->ptask) {
         assert(!ltask->ptask->begun);
-        task_to_run_fun = ltask->ptask->fun;
-        task_to_run_arg = ltask->ptask->arg;
         ltask->ptask->begun = true;
         ltask->ptask->ltask = NULL;
         // there is no longer any need to access the corresponding task
@@ -693,51 +799,47 @@ void chpl_task_executeTasksInList(chpl_task_list_p task_list) {
       // end critical section
       chpl_thread_mutexUnlock(&threading_lock);
 
-      if (task_to_run_fun) {
-        curr_ptask = get_current_ptask();
-        set_current_ptask(nested_ptask);
-
-        // begin critical section
-        chpl_thread_mutexLock(&extra_task_lock);
+      if (nested_ptask) {
+        run_nested_task(nested_ptask);
+        chpl_mem_free(nested_ptask, 0, 0);
+      }
+    }
 
-        extra_task_cnt++;
+  } while (ltask != task_list);
+}
 
-        // end critical section
-        chpl_thread_mutexUnlock(&extra_task_lock);
 
-        if (do_taskReport) {
-          chpl_thread_mutexLock(&taskTable_lock);
-          chpldev_taskTable_set_suspended(curr_ptask->id);
-          chpldev_taskTable_set_active(nested_ptask->id);
-          chpl_thread_mutexUnlock(&taskTable_lock);
-        }
+//
+// Run a task that has been removed from the task pool (or claimed
+// from a deque) on the current thread, nested inside the task already
+// running here.  The caller frees its descriptor.
+//
+static void run_nested_task(task_pool_p nested_ptask) {
+  task_pool_p curr_ptask;
 
-        if (blockreport)
-          initializeLockReportForThread();
+  curr_ptask = get_current_ptask();
+  set_current_ptask(nested_ptask);
 
-        (*task_to_run_fun)(task_to_run_arg);
+  (void) atomic_fetch_add_int_least64_t(&extra_task_cnt, 1);
 
-        if (do_taskReport) {
-          chpl_thread_mutexLock(&taskTable_lock);
-          chpldev_taskTable_set_active(curr_ptask->id);
-          chpldev_taskTable_remove(nested_ptask->id);
-          chpl_thread_mutexUnlock(&taskTable_lock);
-        }
+  if (do_taskReport) {
+    taskTable_set_suspended(curr_ptask->id);
+    taskTable_set_active(nested_ptask->id);
+  }
 
-        // begin critical section
-        chpl_thread_mutexLock(&extra_task_lock);
+  if (blockreport)
+    initializeLockReportForThread();
 
-        extra_task_cnt--;
+  (*nested_ptask->fun)(nested_ptask->arg);
 
-        // end critical section
-        chpl_thread_mutexUnlock(&extra_task_lock);
+  if (do_taskReport) {
+    taskTable_set_active(curr_ptask->id);
+    taskTable_remove(nested_ptask->id);
+  }
 
-        set_current_ptask(curr_ptask);
-        chpl_mem_free(nested_ptask, 0, 0);
-      }
-    }
+  (void) atomic_fetch_sub_int_least64_t(&extra_task_cnt, 1);
 
-  } while (ltask != task_list);
+  set_current_ptask(curr_ptask);
 }
 
 
@@ -756,6 +858,8 @@ void chpl_task_freeTaskList(chpl_task_list_p task_list) {
   do {
     ltask = next_task;
     next_task = ltask->next;
+    if (sched_policy == sched_workstealing && ltask->ptask != NULL)
+      ws_release_task(ltask->ptask);
     chpl_mem_free(ltask, 0, 0);
   } while (ltask != task_list);
 }
@@ -781,6 +885,13 @@ void chpl_task_startMovedTask(chpl_fn_p fp,
            { fp, a, canCountRunningTasks,
              private };
 
+  if (sched_policy == sched_workstealing) {
+    ws_push_task(create_ptask(movedTaskWrapper, pmtwd, pmtwd->chpl_data,
+                              NULL));
+    ws_schedule_tasks(1);
+    return;
+  }
+
   // begin critical section
   chpl_thread_mutexLock(&threading_lock);
 
@@ -870,7 +981,11 @@ size_t chpl_task_getCallStackSize(void) {
   return chpl_thread_getCallStackSize();
 }
 
-uint32_t chpl_task_getNumQueuedTasks(void) { return queued_task_cnt; }
+uint32_t chpl_task_getNumQueuedTasks(void) {
+  if (sched_policy == sched_workstealing)
+    return (uint32_t) atomic_load_int_least64_t(&ws_queued_cnt);
+  return queued_task_cnt;
+}
 
 uint32_t chpl_task_getNumRunningTasks(void) {
   chpl_internal_error("chpl_task_getNumRunningTasks() called");
@@ -881,6 +996,18 @@ int32_t  chpl_task_getNumBlockedTasks(void) {
   if (blockreport) {
     int numBlockedTasks;
 
+    if (sched_policy == sched_workstealing) {
+      //
+      // Threads looking for work count as idle before they block, so
+      // this can transiently come out negative.
+      //
+      chpl_thread_mutexLock(&block_report_lock);
+      numBlockedTasks = blocked_thread_cnt
+                        - atomic_load_int_least32_t(&ws_idle_cnt);
+      chpl_thread_mutexUnlock(&block_report_lock);
+      return (numBlockedTasks > 0) ? numBlockedTasks : 0;
+    }
+
     // begin critical section
     chpl_thread_mutexLock(&threading_lock);
     chpl_thread_mutexLock(&block_report_lock);
@@ -905,15 +1032,58 @@ int32_t  chpl_task_getNumBlockedTasks(void) {
 // Get a new task ID.
 //
 static chpl_taskID_t get_next_task_id(void) {
-  static chpl_taskID_t       id = chpl_nullTaskID + 1;
+  return (chpl_taskID_t) atomic_fetch_add_uint_least64_t(&next_task_id, 1);
+}
 
-  chpl_taskID_t              next_id;
 
-  chpl_thread_mutexLock(&task_id_lock);
-  next_id = id++;
-  chpl_thread_mutexUnlock(&task_id_lock);
+//
+// Task table updates.  The task table is split into shards by task ID,
+// and each shard has its own lock, so that tasks beginning and ending
+// on different threads rarely contend with each other.  The table
+// itself is implemented in the ChapelTaskTable module, which shards it
+// the same way.
+//
+static inline
+chpl_thread_mutex_t* taskTable_lock_for(chpl_taskID_t id) {
+  return &taskTable_locks[id % (chpl_taskID_t) taskTable_num_shards];
+}
+
+
+static void taskTable_add(task_pool_p ptask) {
+  chpl_thread_mutex_t* lock = taskTable_lock_for(ptask->id);
 
-  return next_id;
+  chpl_thread_mutexLock(lock);
+  chpldev_taskTable_add(ptask->id,
+                        ptask->lineno, ptask->filename,
+                        (uint64_t) (intptr_t) ptask);
+  chpl_thread_mutexUnlock(lock);
+}
+
+
+static void taskTable_remove(chpl_taskID_t id) {
+  chpl_thread_mutex_t* lock = taskTable_lock_for(id);
+
+  chpl_thread_mutexLock(lock);
+  chpldev_taskTable_remove(id);
+  chpl_thread_mutexUnlock(lock);
+}
+
+
+static void taskTable_set_active(chpl_taskID_t id) {
+  chpl_thread_mutex_t* lock = taskTable_lock_for(id);
+
+  chpl_thread_mutexLock(lock);
+  chpldev_taskTable_set_active(id);
+  chpl_thread_mutexUnlock(lock);
+}
+
+
+static void taskTable_set_suspended(chpl_taskID_t id) {
+  chpl_thread_mutex_t* lock = taskTable_lock_for(id);
+
+  chpl_thread_mutexLock(lock);
+  chpldev_taskTable_set_suspended(id);
+  chpl_thread_mutexUnlock(lock);
 }
 
 
@@ -979,12 +1149,31 @@ static void report_locked_threads(void) {
 //
 static void report_all_tasks(void) {
     task_pool_p pendingTask = task_pool_head;
+    thread_private_data_t* tp;
 
     printf("Task report\n");
     printf("--------------------------------\n");
 
     // print out pending tasks
     printf("Pending tasks:\n");
+    if (sched_policy == sched_workstealing) {
+        ws_deque_p d;
+        for (d = (ws_deque_p) atomic_load_uintptr_t(&ws_deque_list);
+             d != NULL;
+             d = d->next) {
+            ws_deque_array_p a =
+                (ws_deque_array_p) atomic_load_uintptr_t(&d->array);
+            int64_t b = atomic_load_int_least64_t(&d->bottom);
+            int64_t i;
+            for (i = atomic_load_int_least64_t(&d->top); i < b; i++) {
+                task_pool_p wsTask = a->slot[i & (a->size - 1)];
+                if (wsTask != NULL && ! wsTask->begun) {
+                    printf("- %s:%d\n", wsTask->filename,
+                           (int)wsTask->lineno);
+                }
+            }
+        }
+    }
     while(pendingTask != NULL) {
         if(! pendingTask->begun) {
             printf("- %s:%d\n", pendingTask->filename,
@@ -996,7 +1185,25 @@ static void report_all_tasks(void) {
 
     // print out running tasks
     printf("Known tasks:\n");
-    chpldev_taskTable_print();
+    fflush(stdout);
+
+    //
+    // The task table is printed by module code, which needs a current
+    // task.  An idle thread (the one that detects deadlock, say) has
+    // none, so give it a serial placeholder while printing.
+    //
+    tp = (thread_private_data_t*) chpl_thread_getPrivateData();
+    if (tp != NULL && tp->ptask == NULL) {
+        task_pool_t report_task;
+
+        report_task.id = chpl_nullTaskID;
+        report_task.chpl_data.prvdata.serial_state = true;
+        tp->ptask = &report_task;
+        chpldev_taskTable_print();
+        tp->ptask = NULL;
+    }
+    else
+        chpldev_taskTable_print();
 }
 
 
@@ -1151,25 +1358,26 @@ thread_begin(void* ptask_void) {
                                                0, 0);
   tp->ptask    = ptask;
   tp->lockRprt = NULL;
+  tp->deque    = NULL;
   chpl_thread_setPrivateData(tp);
 
   if (blockreport)
     initializeLockReportForThread();
 
+  if (sched_policy == sched_workstealing) {
+    tp->deque = ws_deque_new();
+    ws_thread_loop(tp);
+    return;
+  }
+
   while (true) {
-    if (do_taskReport) {
-      chpl_thread_mutexLock(&taskTable_lock);
-      chpldev_taskTable_set_active(ptask->id);
-      chpl_thread_mutexUnlock(&taskTable_lock);
-    }
+    if (do_taskReport)
+      taskTable_set_active(ptask->id);
 
     (*ptask->fun)(ptask->arg);
 
-    if (do_taskReport) {
-      chpl_thread_mutexLock(&taskTable_lock);
-      chpldev_taskTable_remove(ptask->id);
-      chpl_thread_mutexUnlock(&taskTable_lock);
-    }
+    if (do_taskReport)
+      taskTable_remove(ptask->id);
 
     // begin critical section
     chpl_thread_mutexLock(&threading_lock);
@@ -1310,6 +1518,19 @@ void begin_task(chpl_fn_p fp, void* a, chpl_task_prvDataImpl_t chpl_data,
                 chpl_task_list_p ltask) {
   if (chpl_data.prvdata.serial_state)
     (*fp)(a);
+  else if (sched_policy == sched_workstealing) {
+    task_pool_p ptask = create_ptask(fp, a, chpl_data, ltask);
+
+    //
+    // As below, the task list node must be updated before the task
+    // becomes visible to other threads, which is when it is pushed.
+    //
+    if (ltask)
+      ltask->ptask = ptask;
+
+    ws_push_task(ptask);
+    ws_schedule_tasks(1);
+  }
   else {
     task_pool_p ptask = NULL;
 
@@ -1416,12 +1637,11 @@ static void schedule_next_task(int howMany) {
 
 
 // create a task from the given function pointer and arguments
-// and append it to the end of the task pool
-// assumes threading_lock has already been acquired!
-static task_pool_p add_to_task_pool(chpl_fn_p fp,
-                                    void* a,
-                                    chpl_task_prvDataImpl_t chpl_data,
-                                    chpl_task_list_p ltask) {
+// and register it in the task table, but don't queue it anywhere
+static task_pool_p create_ptask(chpl_fn_p fp,
+                                void* a,
+                                chpl_task_prvDataImpl_t chpl_data,
+                                chpl_task_list_p ltask) {
   task_pool_p ptask =
     (task_pool_p) chpl_mem_alloc(sizeof(task_pool_t),
                                         CHPL_RT_MD_TASK_POOL_DESCRIPTOR,
@@ -1433,6 +1653,11 @@ static task_pool_p add_to_task_pool(chpl_fn_p fp,
   ptask->begun        = false;
   ptask->chpl_data    = chpl_data;
 
+  if (sched_policy == sched_workstealing) {
+    atomic_init_int_least32_t(&ptask->ws_claimed, 0);
+    atomic_init_int_least32_t(&ptask->ws_refs, (ltask == NULL) ? 1 : 2);
+  }
+
   if (ltask) {
     ptask->filename = ltask->filename;
     ptask->lineno = ltask->lineno;
@@ -1442,6 +1667,23 @@ static task_pool_p add_to_task_pool(chpl_fn_p fp,
   }
 
   ptask->next = NULL;
+  ptask->prev = NULL;
+
+  if (do_taskReport)
+    taskTable_add(ptask);
+
+  return ptask;
+}
+
+
+// create a task from the given function pointer and arguments
+// and append it to the end of the task pool
+// assumes threading_lock has already been acquired!
+static task_pool_p add_to_task_pool(chpl_fn_p fp,
+                                    void* a,
+                                    chpl_task_prvDataImpl_t chpl_data,
+                                    chpl_task_list_p ltask) {
+  task_pool_p ptask = create_ptask(fp, a, chpl_data, ltask);
 
   if (task_pool_tail)
     task_pool_tail->next = ptask;
@@ -1452,18 +1694,422 @@ static task_pool_p add_to_task_pool(chpl_fn_p fp,
 
   queued_task_cnt++;
 
-  if (do_taskReport) {
-    chpl_thread_mutexLock(&taskTable_lock);
-    chpldev_taskTable_add(ptask->id,
-                          ptask->lineno, ptask->filename,
-                          (uint64_t) (intptr_t) ptask);
-    chpl_thread_mutexUnlock(&taskTable_lock);
+  return ptask;
+}
+
+
+// Work-stealing scheduling
+
+//
+// Select the scheduling policy, from the CHPL_RT_TASK_SCHEDULER
+// environment variable.
+//
+static void get_sched_policy(void) {
+  char* p;
+
+  if ((p = getenv("CHPL_RT_TASK_SCHEDULER")) == NULL
+      || strcmp(p, "fifo") == 0)
+    sched_policy = sched_fifo;
+  else if (strcmp(p, "workstealing") == 0)
+    sched_policy = sched_workstealing;
+  else {
+    chpl_warning("unknown CHPL_RT_TASK_SCHEDULER setting, "
+                 "try 'fifo' or 'workstealing'; using 'fifo'", 0, NULL);
+    sched_policy = sched_fifo;
   }
+}
+
+
+static ws_deque_array_p ws_deque_array_new(int64_t size) {
+  ws_deque_array_p a;
+
+  a = (ws_deque_array_p) chpl_mem_alloc(sizeof(*a)
+                                        + size * sizeof(task_pool_p),
+                                        CHPL_RT_MD_TASK_DEQUE, 0, 0);
+  a->size = size;
+  a->retired = NULL;
+  return a;
+}
+
+
+//
+// Create a deque and add it to the list of deques thieves look at.
+//
+static ws_deque_p ws_deque_new(void) {
+  ws_deque_p d;
+
+  d = (ws_deque_p) chpl_mem_alloc(sizeof(*d), CHPL_RT_MD_TASK_DEQUE, 0, 0);
+  atomic_init_int_least64_t(&d->top, 0);
+  atomic_init_int_least64_t(&d->bottom, 0);
+  atomic_init_uintptr_t(&d->array,
+                        (uintptr_t) ws_deque_array_new(WS_DEQUE_INITIAL_SIZE));
+
+  do {
+    d->next = (ws_deque_p) atomic_load_uintptr_t(&ws_deque_list);
+  } while (!atomic_compare_exchange_weak_uintptr_t(&ws_deque_list,
+                                                   (uintptr_t) d->next,
+                                                   (uintptr_t) d));
+  return d;
+}
+
+
+//
+// Free the deques and their slot arrays, including the ones retired
+// when a deque grew, and drop the deques' references to any tasks
+// still in them (normally just tasks already run by the task waiting
+// on their task list).  Only called once all the other threads are
+// gone.
+//
+static void ws_free_deques(void) {
+  ws_deque_p d, next_d;
+
+  for (d = (ws_deque_p) atomic_load_uintptr_t(&ws_deque_list);
+       d != NULL;
+       d = next_d) {
+    ws_deque_array_p a, next_a;
+    int64_t          i;
+
+    a = (ws_deque_array_p) atomic_load_uintptr_t(&d->array);
+    for (i = atomic_load_int_least64_t(&d->top);
+         i < atomic_load_int_least64_t(&d->bottom);
+         i++)
+      ws_release_task(a->slot[i & (a->size - 1)]);
+
+    for (a = (ws_deque_array_p) atomic_load_uintptr_t(&d->array);
+         a != NULL;
+         a = next_a) {
+      next_a = a->retired;
+      chpl_mem_free(a, 0, 0);
+    }
+
+    next_d = d->next;
+    atomic_destroy_int_least64_t(&d->top);
+    atomic_destroy_int_least64_t(&d->bottom);
+    atomic_destroy_uintptr_t(&d->array);
+    chpl_mem_free(d, 0, 0);
+  }
+
+  atomic_store_uintptr_t(&ws_deque_list, (uintptr_t) NULL);
+}
+
+
+//
+// Push a task onto the bottom of a deque.  Only the owner may do this.
+//
+static void ws_deque_push(ws_deque_p d, task_pool_p ptask) {
+  int64_t          b = atomic_load_int_least64_t(&d->bottom);
+  int64_t          t = atomic_load_int_least64_t(&d->top);
+  ws_deque_array_p a = (ws_deque_array_p) atomic_load_uintptr_t(&d->array);
+
+  if (b - t >= a->size - 1) {
+    ws_deque_array_p new_a = ws_deque_array_new(2 * a->size);
+    int64_t          i;
+
+    for (i = t; i < b; i++)
+      new_a->slot[i & (new_a->size - 1)] = a->slot[i & (a->size - 1)];
+    new_a->retired = a;
+    atomic_store_uintptr_t(&d->array, (uintptr_t) new_a);
+    a = new_a;
+  }
+
+  a->slot[b & (a->size - 1)] = ptask;
+  atomic_thread_fence(memory_order_release);
+  atomic_store_int_least64_t(&d->bottom, b + 1);
+}
+
+
+//
+// Pop a task off the bottom of a deque.  Only the owner may do this.
+// Returns NULL if the deque is empty or a thief took the last task.
+//
+static task_pool_p ws_deque_pop(ws_deque_p d) {
+  int64_t          b = atomic_load_int_least64_t(&d->bottom) - 1;
+  ws_deque_array_p a = (ws_deque_array_p) atomic_load_uintptr_t(&d->array);
+  int64_t          t;
+  task_pool_p      ptask;
+
+  atomic_store_int_least64_t(&d->bottom, b);
+  t = atomic_load_int_least64_t(&d->top);
+
+  if (t > b) {
+    // empty
+    atomic_store_int_least64_t(&d->bottom, b + 1);
+    return NULL;
+  }
+
+  ptask = a->slot[b & (a->size - 1)];
+  if (t == b) {
+    // this is the last task, so we have to race the thieves for it
+    if (!atomic_compare_exchange_strong_int_least64_t(&d->top, t, t + 1))
+      ptask = NULL;
+    atomic_store_int_least64_t(&d->bottom, b + 1);
+  }
+
+  return ptask;
+}
+
+
+//
+// Steal a task from the top of a deque.  Any thread may do this.
+// Returns NULL if the deque is empty or we lost a race for the task.
+//
+static task_pool_p ws_deque_steal(ws_deque_p d) {
+  int64_t          t = atomic_load_int_least64_t(&d->top);
+  int64_t          b = atomic_load_int_least64_t(&d->bottom);
+  ws_deque_array_p a;
+  task_pool_p      ptask;
+
+  if (t >= b)
+    return NULL;
+
+  a = (ws_deque_array_p) atomic_load_uintptr_t(&d->array);
+  ptask = a->slot[t & (a->size - 1)];
+  if (!atomic_compare_exchange_strong_int_least64_t(&d->top, t, t + 1))
+    return NULL;
+
+  return ptask;
+}
+
+
+//
+// Queue a task on my thread's deque.  Threads that weren't created by
+// us (the comm thread, for example) get a deque the first time they
+// need one.
+//
+static void ws_push_task(task_pool_p ptask) {
+  thread_private_data_t* tp = get_thread_private_data();
+
+  if (tp->deque == NULL)
+    tp->deque = ws_deque_new();
+
+  ws_deque_push(tp->deque, ptask);
+  (void) atomic_fetch_add_int_least64_t(&ws_queued_cnt, 1);
+}
+
+
+//
+// Remove a task from some deque: first from my own, then by stealing
+// from the others.  Thieves start with the deque after their own, so
+// they tend to spread out over different victims.
+//
+static task_pool_p ws_remove_task(ws_deque_p self) {
+  task_pool_p ptask = NULL;
+  ws_deque_p  d;
+
+  if (self != NULL)
+    ptask = ws_deque_pop(self);
+
+  for (d = (self == NULL) ? NULL : self->next;
+       ptask == NULL && d != NULL;
+       d = d->next)
+    ptask = ws_deque_steal(d);
+
+  for (d = (ws_deque_p) atomic_load_uintptr_t(&ws_deque_list);
+       ptask == NULL && d != NULL && d != self;
+       d = d->next)
+    ptask = ws_deque_steal(d);
+
+  return ptask;
+}
+
+
+//
+// Find a task for a thread to run.  A task that belongs to a task list
+// may already have been run by the task waiting on that list (see
+// ws_execute_tasks_in_list), in which case we just drop our reference.
+//
+static task_pool_p ws_find_task(ws_deque_p self) {
+  task_pool_p ptask;
+
+  while ((ptask = ws_remove_task(self)) != NULL && !ws_claim_task(ptask))
+    ws_release_task(ptask);
 
   return ptask;
 }
 
 
+//
+// Take the right to run a task.  Whoever removes a task from a deque
+// and, for tasks on a task list, the task waiting on the list both try
+// to; only one succeeds.  A claimed task is no longer counted as
+// queued, even if it is still sitting in a deque.
+//
+static chpl_bool ws_claim_task(task_pool_p ptask) {
+  if (!atomic_compare_exchange_strong_int_least32_t(&ptask->ws_claimed,
+                                                    0, 1))
+    return false;
+
+  (void) atomic_fetch_sub_int_least64_t(&ws_queued_cnt, 1);
+  return true;
+}
+
+
+//
+// Drop a reference to a task.  A task is referenced by the deque it was
+// pushed on and, if it has one, by its task list entry.  The last
+// reference frees it, once whoever claimed it has finished running it.
+//
+static void ws_release_task(task_pool_p ptask) {
+  if (atomic_fetch_sub_int_least32_t(&ptask->ws_refs, 1) == 1) {
+    atomic_destroy_int_least32_t(&ptask->ws_claimed);
+    atomic_destroy_int_least32_t(&ptask->ws_refs);
+    chpl_mem_free(ptask, 0, 0);
+  }
+}
+
+
+//
+// Make sure some thread will pick up the given number of newly queued
+// tasks.  Idle threads are already looking for work, so we only need to
+// create new threads for tasks beyond what they will find.  A new
+// thread counts as idle from the moment it is created.
+//
+static void ws_schedule_tasks(int howMany) {
+  static chpl_bool warning_issued = false;
+  int64_t          uncovered;
+
+  uncovered = atomic_load_int_least64_t(&ws_queued_cnt)
+              - atomic_load_int_least32_t(&ws_idle_cnt);
+  if (uncovered < howMany)
+    howMany = (int) uncovered;
+  if (howMany <= 0 || warning_issued || !chpl_thread_canCreate())
+    return;
+
+  // begin critical section
+  chpl_thread_mutexLock(&ws_thread_create_lock);
+
+  for (; howMany > 0 && !warning_issued && chpl_thread_canCreate();
+       howMany--) {
+    (void) atomic_fetch_add_int_least32_t(&ws_idle_cnt, 1);
+    if (chpl_thread_create(NULL)) {
+      int32_t max_threads = chpl_thread_getMaxThreads();
+      uint32_t num_threads = chpl_thread_getNumThreads();
+      char msg[256];
+      (void) atomic_fetch_sub_int_least32_t(&ws_idle_cnt, 1);
+      if (max_threads)
+        sprintf(msg,
+                "max threads per locale is %" PRId32
+                ", but unable to create more than %d threads",
+                max_threads, num_threads);
+      else
+        sprintf(msg,
+                "max threads per locale is unbounded"
+                ", but unable to create more than %d threads",
+                num_threads);
+      chpl_warning(msg, 0, 0);
+      warning_issued = true;
+    }
+  }
+
+  // end critical section
+  chpl_thread_mutexUnlock(&ws_thread_create_lock);
+}
+
+
+//
+// Run every task from the given task list that nobody has claimed yet,
+// wherever it is queued, as chpl_task_executeTasksInList does under
+// FIFO scheduling.  We cannot leave them for thieves, because with a
+// capped number of threads there may be none.  Tasks we run here stay
+// in their deques until someone removes them; see ws_find_task.  The
+// list's own references to its tasks are dropped when the list is
+// freed, since we may return early or not be called at all.
+//
+static void ws_execute_tasks_in_list(chpl_task_list_p task_list) {
+  chpl_task_list_p ltask = task_list;
+
+  do {
+    task_pool_p ptask;
+
+    ltask = ltask->next;
+
+    // The first task of a cobegin or coforall, and tasks that were run
+    // serially, were never queued.
+    if ((ptask = ltask->ptask) == NULL)
+      continue;
+
+    if (ws_claim_task(ptask)) {
+      assert(!ptask->begun);
+      ptask->begun = true;
+      run_nested_task(ptask);
+    }
+  } while (ltask != task_list);
+}
+
+
+//
+// This is what a thread does under work-stealing scheduling: find a
+// task, run it, repeat.  While it has nothing to run, it is counted
+// as idle.
+//
+static void ws_thread_loop(thread_private_data_t* tp) {
+  task_pool_p ptask;
+
+  while (true) {
+    while ((ptask = ws_find_task(tp->deque)) == NULL) {
+      //
+      // Wait for a task to be queued somewhere.  As in the FIFO policy
+      // we yield rather than waiting on a condition variable, and we
+      // participate in deadlock detection while waiting.
+      //
+      if (atomic_load_int_least64_t(&ws_queued_cnt) > 0) {
+        chpl_thread_yield();
+        continue;
+      }
+
+      if (set_block_loc(0, idleTaskName)) {
+        // all other tasks appear to be blocked
+        struct timeval deadline, now;
+        gettimeofday(&deadline, NULL);
+        deadline.tv_sec += 1;
+        do {
+          chpl_thread_yield();
+          if (atomic_load_int_least64_t(&ws_queued_cnt) == 0)
+            gettimeofday(&now, NULL);
+        } while (atomic_load_int_least64_t(&ws_queued_cnt) == 0
+                 && (now.tv_sec < deadline.tv_sec
+                     || (now.tv_sec == deadline.tv_sec
+                         && now.tv_usec < deadline.tv_usec)));
+        if (atomic_load_int_least64_t(&ws_queued_cnt) == 0) {
+          check_for_deadlock();
+        }
+      }
+      else {
+        do {
+          chpl_thread_yield();
+        } while (atomic_load_int_least64_t(&ws_queued_cnt) == 0);
+      }
+
+      unset_block_loc();
+    }
+
+    (void) atomic_fetch_sub_int_least32_t(&ws_idle_cnt, 1);
+
+    if (blockreport)
+      progress_cnt++;
+
+    // The task list entry, if any, keeps pointing at the task; that
+    // reference is dropped when the list is freed.
+    assert(!ptask->begun);
+    ptask->begun = true;
+    tp->ptask = ptask;
+
+    if (do_taskReport)
+      taskTable_set_active(ptask->id);
+
+    (*ptask->fun)(ptask->arg);
+
+    if (do_taskReport)
+      taskTable_remove(ptask->id);
+
+    tp->ptask = NULL;
+    ws_release_task(ptask);
+
+    (void) atomic_fetch_add_int_least32_t(&ws_idle_cnt, 1);
+  }
+}
+
+
 // Threads
 
 uint32_t chpl_task_getNumThreads(void) {
@@ -1473,6 +2119,9 @@ uint32_t chpl_task_getNumThreads(void) {
 uint32_t chpl_task_getNumIdleThreads(void) {
   int numIdleThreads;
 
+  if (sched_policy == sched_workstealing)
+    return (uint32_t) atomic_load_int_least32_t(&ws_idle_cnt);
+
   // begin critical section
   chpl_thread_mutexLock(&threading_lock);
 
@@ -0,0 +1,26 @@
+// Globals, virtual methods and on-statements that cross module
+// boundaries have to link when each module is compiled separately.
+module shapes {
+  var numShapes = 0;
+  const unit = 1.0;
+
+  class Shape {
+    proc area(): real return 0.0;
+  }
+
+  class Square: Shape {
+    var side: real;
+    proc area(): real return side * side;
+  }
+
+  class Circle: Shape {
+    var r: real;
+    proc area(): real return 3.0 * r * r;
+  }
+
+  proc makeShape(i: int): Shape {
+    numShapes += 1;
+    if i % 2 == 0 then return new Square(i * unit);
+    else return new Circle(i * unit);
+  }
+}
@@ -0,0 +1,11 @@
+use shapes;
+
+var total: real;
+for i in 1..4 {
+  var s: Shape;
+  on Locales[numLocales-1] do s = makeShape(i);
+  total += s.area();
+  delete s;
+}
+writeln(numShapes, " ", total);
+writeln("hello from ", here.id);
@@ -0,0 +1,28 @@
+use BlockDist;
+
+// Make enough privatized distributions, domains and arrays to fill
+// several chunks of the privatization table, from more than one task,
+// and check that every locale sees the right copies.
+
+config const n = 100;
+config const numTasks = 4;
+
+const Space = {1..n};
+var errors: atomic int;
+
+coforall t in 1..numTasks do on Locales[t % numLocales] {
+  for i in 1..n/numTasks {
+    const D = Space dmapped Block(Space);
+    var A: [D] int;
+    forall j in D do A[j] = j + i;
+    var ok = true;
+    for loc in Locales do on loc do
+      if D.size != n || A.localSubdomain().size == 0 then ok = false;
+    if !ok || + reduce A != n * (n + 1) / 2 + n * i {
+      writeln("error in task ", t, " iteration ", i);
+      errors.add(1);
+    }
+  }
+}
+
+writeln(errors.read() == 0);
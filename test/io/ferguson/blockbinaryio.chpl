@@ -0,0 +1,73 @@
+use BlockDist;
+
+// Block arrays written and read in binary have each locale do its own
+// part of the I/O. Check that the file is the same as for a local
+// array, and that reading fills in the right elements.
+config const n = 1000;
+
+var f = open("blockbinaryio.bin", iomode.cwr);
+
+proc check(A, L, param kind:iokind) {
+  {
+    var w = f.writer(kind=kind);
+    w.write(1:int(8));
+    w.write(A);
+    w.write(2:int(8));
+    w.close();
+  }
+
+  var ok = true;
+  {
+    // Read it as a local array.
+    var r = f.reader(kind=kind);
+    var a, b: int(8);
+    var B: [L.domain] L.eltType;
+    r.read(a, B, b);
+    if a != 1 || b != 2 then ok = false;
+    for (x, y) in zip(L, B) do
+      if x != y then ok = false;
+  }
+  {
+    // Read it as a Block array.
+    var r = f.reader(kind=kind);
+    var a, b: int(8);
+    var B: [A.domain] A.eltType;
+    r.read(a, B, b);
+    if a != 1 || b != 2 then ok = false;
+    for (x, y) in zip(L, B) do
+      if x != y then ok = false;
+  }
+
+  writeln(kind, " ", A.domain, " ", ok);
+}
+
+const D1 = {1..n*n} dmapped Block({1..n*n});
+var A1: [D1] int;
+var L1: [1..n*n] int;
+forall i in D1 do A1[i] = i;
+L1 = A1;
+
+const D2 = {1..n, 1..n/2} dmapped Block({1..n, 1..n/2});
+var A2: [D2] real;
+var L2: [1..n, 1..n/2] real;
+forall (i,j) in D2 do A2[i,j] = i + j / 1000.0;
+L2 = A2;
+
+check(A1, L1, ionative);
+check(A1, L1, iobig);
+check(A2, L2, ionative);
+check(A2, L2, iolittle);
+
+// Channels on memory files do the I/O serially.
+{
+  var m = openmem();
+  var w = m.writer(kind=iobig);
+  w.write(A2);
+  w.close();
+  var r = m.reader(kind=iobig);
+  var B: [D2] real;
+  r.read(B);
+  writeln("memory ", && reduce (B == L2));
+}
+
+f.close();
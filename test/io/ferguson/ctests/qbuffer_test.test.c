@@ -1,5 +1,7 @@
 #include "qbuffer.h"
 #include <assert.h>
+#include <string.h>
+#include <pthread.h>
 
 void test_qbytes(void)
 {
@@ -31,6 +33,87 @@ void test_qbytes(void)
   qbytes_release(b);
 }
 
+static void* release_iobuf_thread(void* arg)
+{
+  qbytes_t* b;
+  qioerr err;
+
+  err = qbytes_create_iobuf(&b);
+  assert(!err);
+  *(void**) arg = b->data;
+  qbytes_release(b);
+  return NULL;
+}
+
+void test_iobuf_pool(void)
+{
+  qbytes_t* b;
+  qbytes_t* c;
+  void* data;
+  qbytes_iobuf_pool_stats_t before, after;
+  pthread_t thread;
+  int64_t i;
+  qioerr err;
+
+  qbytes_iobuf_pool_stats(&before);
+
+  // a released iobuf should be handed out again.
+  err = qbytes_create_iobuf(&b);
+  assert(!err);
+  assert( b->len == qbytes_iobuf_size );
+  data = b->data;
+  memset(data, 'x', b->len);
+  qbytes_release(b);
+
+  err = qbytes_create_iobuf(&b);
+  assert(!err);
+  assert( b->data == data );
+  assert( b->len == qbytes_iobuf_size );
+  // and it should come back zeroed.
+  for( i = 0; i < b->len; i++ ) assert( ((char*) b->data)[i] == 0 );
+
+  // two live buffers can't share data.
+  err = qbytes_create_iobuf(&c);
+  assert(!err);
+  assert( c->data != b->data );
+
+  qbytes_release(b);
+  qbytes_release(c);
+
+  qbytes_iobuf_pool_stats(&after);
+  assert( after.reused - before.reused >= 1 );
+  assert( after.recycled - before.recycled == 3 );
+  assert( after.allocated - before.allocated <= 2 );
+
+  // buffers of a different size are not reused.
+  err = qbytes_create_iobuf(&b);
+  assert(!err);
+  qbytes_iobuf_size *= 2;
+  qbytes_release(b);
+  err = qbytes_create_iobuf(&b);
+  assert(!err);
+  assert( b->len == qbytes_iobuf_size );
+  qbytes_release(b);
+  qbytes_iobuf_size /= 2;
+
+  // buffers cached by a thread are kept when it exits.
+  qbytes_iobuf_pool_exit();
+  data = NULL;
+  pthread_create(&thread, NULL, release_iobuf_thread, &data);
+  pthread_join(thread, NULL);
+  assert( data != NULL );
+  err = qbytes_create_iobuf(&b);
+  assert(!err);
+  assert( b->data == data );
+  qbytes_release(b);
+
+  // and everything is freed at shutdown.
+  qbytes_iobuf_pool_stats(&before);
+  qbytes_iobuf_pool_exit();
+  qbytes_iobuf_pool_stats(&after);
+  assert( after.freed - before.freed == 1 );
+}
+
 void test_qbuffer_iterators(qbuffer_t* buf, qbytes_t** qb, int num, int skip, int trunc)
 {
   qbuffer_iter_t cur;
@@ -553,6 +636,7 @@ void test_qbuffer_edges(void)
 int main(int argc, char** argv)
 {
   test_qbytes();
+  test_iobuf_pool();
 
   test_qbuffer();
 
@@ -288,7 +288,7 @@ void check_channels(void)
   int nunbounded = sizeof(unboundedness)/sizeof(char);
   int unbounded;
   char reopen;
-  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE, QIO_METHOD_FREADFWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST};
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE, QIO_METHOD_FREADFWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST, QIO_METHOD_URING, QIO_METHOD_PREADPWRITE | QIO_HINT_DIRECT};
   int nhints = sizeof(hints)/sizeof(qio_hint_t);
   int file_hint, ch_hint;
 
@@ -366,6 +366,93 @@ void check_paths(void)
 
 }
 
+// Check qio_channel_write_bulk and qio_channel_read_bulk, with and
+// without byte swapping, for sizes that go through the buffer and
+// sizes that go directly to the file.
+void check_bulk_one(qio_hint_t hints, int64_t n, ssize_t swap_size)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+  uint32_t* data = (uint32_t*) qio_malloc(n*sizeof(uint32_t));
+  uint32_t* got = (uint32_t*) qio_malloc(n*sizeof(uint32_t));
+  uint8_t b;
+  int64_t i;
+
+  for( i = 0; i < n; i++ ) data[i] = 0x01020304 + i;
+
+  err = qio_file_open_tmp(&f, hints, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&ch, f, hints, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  b = 'x';
+  err = qio_channel_write_amt(1, ch, &b, 1);
+  assert(!err);
+  err = qio_channel_write_bulk(1, ch, data, n*sizeof(uint32_t), swap_size);
+  assert(!err);
+  b = 'y';
+  err = qio_channel_write_amt(1, ch, &b, 1);
+  assert(!err);
+  qio_channel_release(ch);
+
+  // the data passed in should not have changed.
+  for( i = 0; i < n; i++ ) assert(data[i] == 0x01020304 + i);
+
+  // Read it back one element at a time.
+  err = qio_channel_create(&ch, f, hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(1, ch, &b, 1);
+  assert(!err && b == 'x');
+  for( i = 0; i < n; i++ ) {
+    uint32_t x;
+    err = qio_channel_read_amt(1, ch, &x, sizeof(uint32_t));
+    assert(!err);
+    if( swap_size == 4 ) x = (htobe32(1) == 1) ? le32toh(x) : be32toh(x);
+    assert(x == data[i]);
+  }
+  err = qio_channel_read_amt(1, ch, &b, 1);
+  assert(!err && b == 'y');
+  qio_channel_release(ch);
+
+  // Read it back in bulk.
+  err = qio_channel_create(&ch, f, hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(1, ch, &b, 1);
+  assert(!err && b == 'x');
+  err = qio_channel_read_bulk(1, ch, got, n*sizeof(uint32_t), swap_size);
+  assert(!err);
+  for( i = 0; i < n; i++ ) assert(got[i] == data[i]);
+  err = qio_channel_read_amt(1, ch, &b, 1);
+  assert(!err && b == 'y');
+  // and now we're at EOF.
+  err = qio_channel_read_bulk(1, ch, got, n*sizeof(uint32_t), swap_size);
+  assert(qio_err_to_int(err) == EEOF);
+  qio_channel_release(ch);
+
+  qio_file_release(f);
+  qio_free(data);
+  qio_free(got);
+}
+
+void check_bulk(void)
+{
+  // mmap channels never transfer directly, so they use the fallback path.
+  qio_hint_t hints[] = {QIO_METHOD_PREADPWRITE, QIO_METHOD_MMAP};
+  int64_t sizes[] = {1, 1000, QIO_DIRECT_TRANSFER_MIN/4 + 7};
+  ssize_t swaps[] = {0, 4};
+  int h, s, w;
+
+  for( h = 0; h < (int) (sizeof(hints)/sizeof(hints[0])); h++ ) {
+    for( s = 0; s < (int) (sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+      for( w = 0; w < (int) (sizeof(swaps)/sizeof(swaps[0])); w++ ) {
+        if( verbose ) printf("check_bulk(%i, %i, %i)\n", (int) hints[h], (int) sizes[s], (int) swaps[w]);
+        check_bulk_one(hints[h], sizes[s], swaps[w]);
+      }
+    }
+  }
+}
+
 int main(int argc, char** argv)
 {
 
@@ -379,6 +466,8 @@ int main(int argc, char** argv)
 
   check_paths();
 
+  check_bulk();
+
   check_channels();
 
 
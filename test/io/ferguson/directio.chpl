@@ -0,0 +1,63 @@
+use IO;
+
+config const n = 300001;
+config const fname = "directio.bin";
+
+// n is odd, so the file ends partway through a block and the
+// last part of each pass has to go through the page cache.
+var f = open(fname, iomode.cwr, hints=IOHINT_DIRECT);
+
+{
+  var w = f.writer(kind=ionative);
+  for i in 1..n do w.write((i % 251):uint(8));
+  w.close();
+}
+
+writeln(f.length() == n);
+
+{
+  var r = f.reader(kind=ionative);
+  var x:uint(8);
+  var ok = true;
+  for i in 1..n {
+    r.read(x);
+    if x != (i % 251):uint(8) then ok = false;
+  }
+  writeln(ok, " ", r.read(x));
+  r.close();
+}
+
+// Overwrite an unaligned region in the middle of the file.
+const lo = 4097, hi = 70001;
+{
+  var w = f.writer(kind=ionative, start=lo, end=hi);
+  for i in lo..hi-1 do w.write(7:uint(8));
+  w.close();
+}
+
+// Read it back starting from an unaligned position.
+{
+  var r = f.reader(kind=ionative, start=lo-10);
+  var x:uint(8);
+  var ok = true;
+  for i in lo-10..n-1 {
+    r.read(x);
+    const expect = if i >= lo && i < hi then 7:uint(8) else ((i+1) % 251):uint(8);
+    if x != expect then ok = false;
+  }
+  writeln(ok);
+  r.close();
+}
+
+f.close();
+
+// A file opened without the hint sees the same data.
+{
+  var g = open(fname, iomode.r);
+  var r = g.reader(kind=ionative, start=n-1);
+  var x:uint(8);
+  r.read(x);
+  writeln(x == (n % 251):uint(8), " ", g.length() == n);
+  r.close();
+  g.close();
+}
@@ -0,0 +1,60 @@
+use IO;
+
+config const n = 1000000;
+config const path = "gzipbinary.bin.gz";
+
+// Write enough to fill several batches of compressed blocks.
+{
+  var w = openwriter(url="gzip://" + path, kind=iobig);
+  for i in 0..#n do w.write(i);
+  w.close();
+}
+
+var f = open(url="gzip://" + path, mode=iomode.r);
+writeln(f.fstype() == FTYPE_GZIP);
+writeln(f.length() == 8*n);
+
+// Read it all back in order.
+{
+  var r = f.reader(kind=iobig);
+  var x:int;
+  var ok = true;
+  for i in 0..#n {
+    r.read(x);
+    if x != i then ok = false;
+  }
+  writeln(ok);
+  writeln(r.read(x));
+  r.close();
+}
+
+// Start reading at offsets from the end of the file backwards.
+{
+  var ok = true;
+  for i in 0..#n by -n/7 {
+    var r = f.reader(kind=iobig, start=8*i);
+    var x:int;
+    r.read(x);
+    if x != i then ok = false;
+    r.close();
+  }
+  writeln(ok);
+}
+
+f.close();
+
+// An empty file still gets one (empty) member.
+{
+  var w = openwriter(url="gzip://" + path);
+  w.close();
+  var g = open(url="gzip://" + path, mode=iomode.r);
+  writeln(g.length());
+  g.close();
+}
+
+// Compressed files can't be opened for reading and writing.
+{
+  var err:syserr;
+  var g = open(err, url="gzip://" + path, mode=iomode.rw);
+  writeln(err != ENOERR);
+}
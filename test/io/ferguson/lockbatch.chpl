@@ -0,0 +1,56 @@
+use IO;
+
+config const n = 10000;
+config const nreaders = 8;
+
+var f = openmem();
+
+// Each task holds the lock for its whole batch, so its
+// lines must come out together.
+{
+  var w = f.writer();
+  coforall t in 1..4 with (ref w) {
+    w.lock();
+    for i in 1..n do w.write(t, " ");
+    w.write("\n");
+    w.unlock();
+  }
+  w.close();
+}
+
+{
+  var r = f.reader();
+  var ok = true;
+  for line in 1..4 {
+    var first, x: int;
+    r.read(first);
+    for i in 2..n {
+      r.read(x);
+      if x != first then ok = false;
+    }
+  }
+  writeln(ok);
+  r.close();
+}
+
+// Many readers of one memory file, along with
+// tasks asking for its length.
+{
+  var g = openmem();
+  var w = g.writer(kind=iobig);
+  for i in 1..n do w.write(i);
+  w.close();
+
+  var sums: [1..nreaders] int;
+  var lens: [1..nreaders] int;
+  coforall t in 1..nreaders {
+    var r = g.reader(kind=iobig);
+    var x: int;
+    while r.read(x) do sums[t] += x;
+    r.close();
+    lens[t] = g.length();
+  }
+  writeln(&& reduce (sums == n*(n+1)/2));
+  writeln(&& reduce (lens == 8*n));
+  g.close();
+}
@@ -0,0 +1,43 @@
+// Arrays mapped from a file should see the file data, and writes to
+// them should go to the file.
+
+config const n = 10000;
+
+var f = opentmp();
+
+{
+  var w = f.writer(kind=iokind.native);
+  for i in 0..#n do w.write(i*3);
+  w.close();
+}
+
+{
+  var A => f.mapArray(int);
+  writeln(A.domain);
+  writeln(&& reduce [i in A.domain] A[i] == i*3);
+  writeln(+ reduce A);
+}
+
+// a region that doesn't start on a page boundary
+{
+  var B => f.mapArray(int, start=8*1001, count=5, hints=IOHINT_RANDOM);
+  writeln(B);
+  B[0] = -1;
+  var C => f.mapArray(int(32), start=8*1001, count=2);
+  writeln(C);
+}
+
+// past the end of the file
+{
+  var err:syserr;
+  var D => f.mapArray(int, err, start=8*(n-1), count=2);
+  writeln(err == EINVAL, " ", D.numElements);
+}
+
+var r = f.reader(kind=iokind.native, start=8*1000);
+var x:int;
+for i in 1..3 {
+  r.read(x);
+  write(x, " ");
+}
+writeln();
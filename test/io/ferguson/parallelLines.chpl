@@ -0,0 +1,55 @@
+use IO;
+
+config const n = 100000;
+
+proc lineFor(i:int) {
+  var s = i + " ";
+  for 1..i%17 do s += "x";
+  return s + "\n";
+}
+
+var f = opentmp();
+{
+  var w = f.writer();
+  // lines of varying length, so chunk edges land mid-line
+  for i in 1..n do w.write(lineFor(i));
+  w.close();
+}
+
+proc check(chunkSize:int) {
+  var count: atomic int;
+  var sum: atomic int;
+  forall line in f.parallelLines(chunkSize=chunkSize) {
+    var i = line.substring(1..(line.indexOf(" ")-1)):int;
+    assert(line == lineFor(i));
+    count.add(1);
+    sum.add(i);
+  }
+  writeln(count.read(), " ", sum.read());
+}
+
+check(0);
+check(1);          // rounded up to 64k
+check(300000);
+
+// the serial version yields the lines in order
+var expect = 1;
+for line in f.parallelLines(chunkSize=1) {
+  assert(line == lineFor(expect));
+  expect += 1;
+}
+writeln(expect-1);
+
+// other delimiters
+var g = opentmp();
+{
+  var w = g.writer();
+  for i in 1..n do w.write(i, ";");
+  w.close();
+}
+var count: atomic int;
+forall rec in g.parallelLines(delimiter=ascii(";"):uint(8), chunkSize=1) {
+  assert(rec.substring(rec.length) == ";");
+  count.add(1);
+}
+writeln(count.read());
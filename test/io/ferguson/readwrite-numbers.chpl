@@ -0,0 +1,43 @@
+// Numbers that the fast decimal paths handle, and ones near the edges
+// of what they handle, should read and print the same either way.
+
+var f = opentmp();
+
+{
+  var w = f.writer();
+  w.writeln("7 -42 0x1f 9223372036854775807 12345678901234567890");
+  w.writeln("0.5 -2.25 1e22 1e23 4.9e-324 2.5e-320 1.7976931348623157e308");
+  w.writeln("0x1p4 0.1 123456789012345678901234 .5 5. 007.50 1e-400");
+  w.close();
+}
+
+var r = f.reader();
+
+var a, b, c, d: int;
+var e: uint;
+r.read(a, b, c, d, e);
+writeln(a, " ", b, " ", c, " ", d, " ", e);
+
+for i in 1..7 {
+  var x: real;
+  r.read(x);
+  writeln(x);
+  writef("%.17r %er\n", x, x);
+}
+
+for i in 1..6 {
+  var x: real;
+  r.read(x);
+  writeln(x);
+}
+
+var x: real;
+var err: syserr;
+r.read(x, error=err);
+writeln(err == ERANGE);
+
+// Ties and rounding when printing.
+writeln(2.5, " ", 0.125, " ", 1e21, " ", 123456.5, " ", 1234567.0);
+writef("%.1r %.2r %.3r %.0r\n", 2.5, 0.125, 1.0005, 0.5);
+writef("%.3er %.1er\n", 2.5e-7, 9.96e100);
+writeln(-0.0, " ", 0.0, " ", 1e-5, " ", 0.0001, " ", 999999.5);
@@ -0,0 +1,43 @@
+use IO;
+
+config const n = 500000;
+config const nreaders = 4;
+
+var f = opentmp(hints=IOHINT_URING);
+
+{
+  var w = f.writer(kind=ionative);
+  for i in 1..n do w.write(i);
+  w.close();
+}
+
+// Read it all back with one channel.
+{
+  var r = f.reader(kind=ionative);
+  var x:int;
+  var sum = 0;
+  while r.read(x) do sum += x;
+  r.close();
+  writeln(sum == n*(n+1)/2);
+}
+
+// Read it back in pieces from several tasks at once.
+{
+  const per = n / nreaders;
+  var sums:[0..#nreaders] int;
+  coforall t in 0..#nreaders {
+    const lo = t*per;
+    const hi = if t == nreaders-1 then n else lo+per;
+    var r = f.reader(kind=ionative, start=8*lo, end=8*hi);
+    var x:int;
+    for i in lo+1..hi {
+      r.read(x);
+      assert(x == i);
+      sums[t] += x;
+    }
+    r.close();
+  }
+  writeln(+ reduce sums == n*(n+1)/2);
+}
+
+f.close();
@@ -0,0 +1,67 @@
+// Binary arrays are written and read in bulk; check that the result
+// matches writing and reading the elements one at a time, including
+// for strided arrays, the other byte order, and arrays large enough
+// to go directly to the file.
+config const n = 200000;
+
+var f = open("writebinaryarray-bulk.bin", iomode.cwr);
+
+proc check(A, param kind:iokind) {
+  {
+    var w = f.writer(kind=kind);
+    w.write(7:int(8));
+    w.write(A);
+    w.write(9:int(8));
+    w.close();
+  }
+
+  // Read the elements back one at a time.
+  var ok = true;
+  {
+    var r = f.reader(kind=kind);
+    var a, b: int(8);
+    r.read(a);
+    for x in A {
+      var y: x.type;
+      r.read(y);
+      if x != y then ok = false;
+    }
+    r.read(b);
+    if a != 7 || b != 9 then ok = false;
+  }
+
+  // Read the array back in bulk.
+  {
+    var r = f.reader(kind=kind);
+    var B: [A.domain] A.eltType;
+    var a, b: int(8);
+    r.read(a, B, b);
+    if a != 7 || b != 9 then ok = false;
+    for (x, y) in zip(A, B) do
+      if x != y then ok = false;
+  }
+
+  writeln(kind, " ", typeToString(A.eltType), " ", A.domain, " ", ok);
+}
+
+var A: [1..10, 1..10] int(32);
+for (i,j) in A.domain do A[i,j] = (i*100 + j):int(32);
+var Z: [1..5] complex;
+for i in 1..5 do Z[i] = i + (i*i):imag;
+var Big: [1..n] real;
+for i in 1..n do Big[i] = i / 4.0;
+
+proc checkAll(param kind:iokind) {
+  check(A, kind);
+  check(A[2..9 by 3, 3..5], kind);
+  check(A[1..10 by 2, 1..10 by 5], kind);
+  check(Z, kind);
+  check(Big, kind);
+  check(Big[1000..n-1000], kind);
+}
+
+checkAll(iobig);
+checkAll(iolittle);
+checkAll(ionative);
+
+f.close();
@@ -0,0 +1,27 @@
+// Many tasks allocating and freeing at once should leave the memory
+// tracking table and counters consistent.
+use Memory;
+
+config const numTasks = 16;
+config const numIters = 2000;
+
+// Start the threads first, so that most of the runtime's own
+// per-thread data isn't counted.  The tasking layer may still start
+// or retire a few threads, so only check that the loop's (megabytes
+// of) memory was all freed.
+coforall t in 1..numTasks do ;
+
+const before = memoryUsed();
+
+coforall t in 1..numTasks {
+  for i in 1..numIters {
+    var A: [1..(i % 64) + 1] int;
+    A[1] = t;
+  }
+}
+
+writeln(abs(memoryUsed():int - before:int) < 64*1024);
+
+var B: [1..numTasks] [1..100] real;
+forall b in B do b = 1.0;
+writeln(memoryUsed() > before);
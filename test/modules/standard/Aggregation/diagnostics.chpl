@@ -0,0 +1,28 @@
+use Aggregation, CommDiagnostics;
+
+config const n = 1000;
+config const m = 100000;
+
+var counts: [0..#n] atomic int;
+
+resetCommDiagnostics();
+startCommDiagnostics();
+
+on Locales[1] {
+  // With no timeout, buffers are only sent when full or flushed.
+  var agg = new Aggregator();
+  for i in 0..#m do
+    agg.add(counts[(i * 7919) % n], 1);
+  agg.add(counts[0], 1);
+  delete agg;
+}
+
+stopCommDiagnostics();
+
+writeln(+ reduce [c in counts] c.read());
+
+var d = getAggregationDiagnostics();
+writeln(d(1).op, " ", d(1).timeout_send, " ", d(1).flush);
+assert(d(1).full_send > 0);
+assert(d(1).msg == d(1).full_send + 1);
+assert(d(1).msg < (m / 100):uint);
@@ -0,0 +1,34 @@
+use Aggregation;
+
+config const n = 1000;
+config const m = 100000;
+
+var counts: [0..#n] atomic int;
+var bits: [0..#n] atomic uint(32);
+
+coforall loc in Locales do on loc {
+  var agg = new Aggregator();
+  for i in 0..#m {
+    const j = (i * 7919) % n;
+    agg.add(counts[j], 2);
+    agg.sub(counts[j], 1);
+    agg.or(bits[j], 1:uint(32) << loc.id:uint(32));
+  }
+  delete agg;
+}
+
+on Locales[numLocales-1] {
+  var agg = new Aggregator();
+  agg.write(counts[0], 42);
+  agg.flush();
+  writeln(counts[0].read());
+  delete agg;
+}
+
+var ok = true;
+for j in 1..n-1 do
+  if counts[j].read() != numLocales * (m / n) then ok = false;
+writeln(ok);
+
+const allBits = ((1 << numLocales) - 1):uint(32);
+writeln(&& reduce [b in bits] b.read() == allBits);
@@ -0,0 +1,68 @@
+use BlockDist;
+
+// Copy each face of a 3D Block array's remote block to and from a local
+// array, as in a halo exchange.  Then copy pieces of a local array to
+// and from another locale, with contiguous runs ranging from single
+// elements to whole planes.
+
+config const n = 40;
+config const m = 100;
+
+const D = {1..n, 1..n, 1..n};
+const BD = D dmapped Block(D, targetLocales=reshape(Locales, {0..0, 0..0, 0..numLocales-1}));
+
+var A: [BD] int;
+forall (i,j,k) in BD do A[i,j,k] = i*1000000 + j*1000 + k;
+
+const lo = n - n/numLocales + 1;   // first k index of the last locale
+const faces = ({1..n, 1..n, lo..lo},
+               {1..n, n..n, lo..n},
+               {n..n, 1..n, lo..n},
+               {2..n-1, 2..n-1, lo+1..n-1});
+
+var ok = true;
+for f in faces {
+  var L: [D] int;
+
+  L[f] = A[f];
+  for idx in f do
+    if L[idx] != A[idx] then ok = false;
+
+  for idx in f do L[idx] = -L[idx];
+  A[f] = L[f];
+  for idx in f do
+    if A[idx] != L[idx] then ok = false;
+  for idx in f do L[idx] = -L[idx];
+  A[f] = L[f];
+}
+
+for (i,j,k) in D do
+  if A[i,j,k] != i*1000000 + j*1000 + k then ok = false;
+writeln(ok);
+
+const E = {1..m, 1..m, 1..m};
+var B: [E] int;
+forall (i,j,k) in E do B[i,j,k] = i*1000000 + j*1000 + k;
+
+const pieces = ({1..m, 1..m, 1..m by 2},
+                {1..m, 1..m, 1..m-1 by 1},
+                {1..m, 2..m-1, 1..m by 1},
+                {2..3, 1..m by 3, 5..m-5});
+
+for p in pieces {
+  on Locales[numLocales-1] {
+    var R: [E] int;
+    var good = true;
+
+    R[p] = B[p];
+    for idx in p do
+      if R[idx] != B[idx] then good = false;
+
+    for idx in p do R[idx] = -R[idx];
+    B[p] = R[p];
+    for idx in p do
+      if B[idx] != R[idx] then good = false;
+
+    writeln(p, " ", good);
+  }
+}
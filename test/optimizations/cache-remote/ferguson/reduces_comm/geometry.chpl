@@ -0,0 +1,29 @@
+use CommDiagnostics;
+
+// Bigger than the (minimum size) cache.
+config const n = 400000;
+
+var A:[0..#n] int;
+
+resetCommDiagnostics();
+startCommDiagnostics();
+
+on Locales[1] {
+  for i in 0..#n {
+    A[i] = i;
+  }
+  var sum = 0;
+  for i in 0..#n {
+    sum += A[i];
+  }
+  writeln(sum);
+}
+
+stopCommDiagnostics();
+
+var d = getCacheDiagnostics();
+assert(d(1).hit > 0);
+assert(d(1).dirty_flush > 0);
+assert(d(1).fence_wait > 0);
+assert(d(1).ain_evict > 0);
+assert(d(1).aout_evict > 0);
@@ -0,0 +1,21 @@
+config const n = 10000;
+config const m = 100000;
+config const k = 8;
+
+var A:[0..#n] int;
+
+on Locales[1] {
+  // Rewrite the first k elements over and over, with scattered writes
+  // in between so that the dirty lines holding them keep getting
+  // written back. Every write-back after the first overwrites the same
+  // remote bytes, and the newest value has to be the one that sticks.
+  for i in 0..#m {
+    A[i % k] = i;
+    A[k + (i * 7919) % (n - k)] = i;
+  }
+}
+
+var ok = true;
+for j in 0..#k do
+  if A[j] != m - k + j then ok = false;
+writeln(ok);
@@ -0,0 +1,29 @@
+use CommDiagnostics;
+
+config const n = 10000;
+config const m = 100000;
+
+var A:[0..#n] int;
+
+resetCommDiagnostics();
+startCommDiagnostics();
+
+on Locales[1] {
+  // Small scattered writes to locale 0 should be combined into a few
+  // messages instead of being PUT one at a time.
+  for i in 0..#m {
+    A[(i * 7919) % n] = i;
+  }
+}
+
+stopCommDiagnostics();
+
+var total = 0;
+for i in 0..#m do
+  if A[(i * 7919) % n] == i then total += 1;
+writeln(total == n);
+
+var d = getCacheDiagnostics();
+var c = getCommDiagnostics();
+assert(d(1).combined_put > 0);
+assert(c(1).put < (n / 10):uint);
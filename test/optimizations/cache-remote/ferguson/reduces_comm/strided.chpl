@@ -0,0 +1,29 @@
+use CommDiagnostics;
+
+config const n = 100000;
+config const stride = 250;
+
+var A:[0..#n] int;
+
+for i in 0..#n {
+  A[i] = i;
+}
+
+resetCommDiagnostics();
+startCommDiagnostics();
+
+var sum = 0;
+on Locales[1] {
+  // A constant stride larger than a cache page should still be
+  // prefetched by the stride prefetcher.
+  for i in 0..#n by stride {
+    sum += A[i];
+  }
+}
+
+stopCommDiagnostics();
+
+writeln(sum);
+
+var d = getCacheDiagnostics();
+assert(d(1).readahead_hit > 0);
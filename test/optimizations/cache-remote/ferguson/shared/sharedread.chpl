@@ -0,0 +1,34 @@
+config const n = 10000;
+config const rounds = 10;
+
+// Every task reads the same remote array, which is updated between
+// rounds. Checks that the shared cache never returns values from
+// before a task's last acquire.
+proc doit(memory:locale, running:locale) {
+  on memory {
+    var A:[1..n] int;
+    for i in 1..n do A[i] = i;
+
+    on running {
+      for r in 1..rounds {
+        forall i in 1..n {
+          assert(A[i] == r*n + i - n);
+        }
+        // update the array from the running locale so that the writes
+        // go through the cache too.
+        forall i in 1..n {
+          A[i] += n;
+        }
+      }
+      coforall t in 1..here.maxTaskPar {
+        var sum = 0;
+        for i in 1..n do sum += A[i];
+        assert(sum == rounds*n*n + n*(n+1)/2);
+      }
+    }
+  }
+}
+
+doit(Locales[1], Locales[0]);
+doit(Locales[0], Locales[1]);
+writeln("OK");
@@ -0,0 +1,9 @@
+//
+// When a deadlock is detected with -b -t, the task report should list
+// the tasks in the (sharded) task table, even though the report is
+// printed by an idle thread.
+//
+var s: sync int;
+
+begin s;
+s; // should deadlock here
@@ -0,0 +1,40 @@
+//
+// Exercise the work-stealing task scheduler with nested cobegins,
+// coforalls, begins in sync statements, and foralls.
+//
+config const n = 16;
+config const depth = 10;
+
+proc fib(i: int): int {
+  if i < 2 then return i;
+  var a, b: int;
+  cobegin with (ref a, ref b) {
+    a = fib(i-1);
+    b = fib(i-2);
+  }
+  return a + b;
+}
+
+writeln("fib(", depth, ") = ", fib(depth));
+
+var counts: [1..n] int;
+coforall i in 1..n {
+  coforall j in 1..n do
+    counts[i] += 0;
+  counts[i] = i;
+}
+writeln("coforall sum = ", + reduce counts);
+
+var total: atomic int;
+sync {
+  for i in 1..n do
+    begin {
+      for j in 1..n do
+        begin total.add(j);
+    }
+}
+writeln("begin total = ", total.read());
+
+var a: [1..1000] int;
+forall i in 1..1000 do a[i] = i;
+writeln("forall sum = ", + reduce a);
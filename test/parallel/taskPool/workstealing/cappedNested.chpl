@@ -0,0 +1,24 @@
+// Nested coforalls, begins and cobegins with only two threads.  Under
+// work-stealing scheduling the task waiting on a task list has to run
+// its own unstarted tasks, since there may be no thread free to steal
+// them.
+
+config const n = 6, depth = 3;
+
+var total: atomic int;
+
+proc rec(d: int) {
+  if d == 0 {
+    total.add(1);
+    return;
+  }
+  coforall i in 1..n do rec(d-1);
+  sync { for i in 1..n do begin total.add(1); }
+  cobegin {
+    rec(d-1);
+    rec(d-1);
+  }
+}
+
+rec(depth);
+writeln(total.read());
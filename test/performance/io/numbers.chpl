@@ -0,0 +1,50 @@
+//
+// Measures writing and reading numbers as text: one int and one
+// real per line.
+//
+
+use IO, Time;
+
+config const n = 10000;
+config const printPerf = false;
+config const fileName = "numbers.txt";
+
+var f = open(fileName, iomode.cwr);
+var t: Timer;
+
+proc report(what: string, check) {
+  if printPerf then writeln(what, ": ", t.elapsed());
+  else writeln(what, " ", check);
+  t.clear();
+}
+
+// write
+{
+  var w = f.writer(locking=false);
+  t.start();
+  for i in 1..n do
+    w.writeln(i * 7919, " ", i / 8.0);
+  t.stop();
+  w.close();
+  report("write", n);
+}
+
+// read
+{
+  var r = f.reader(locking=false);
+  var x: int;
+  var y: real;
+  var xsum = 0;
+  var ysum = 0.0;
+  t.start();
+  while r.read(x, y) {
+    xsum += x;
+    ysum += y;
+  }
+  t.stop();
+  r.close();
+  report("read", xsum + ysum:int);
+}
+
+f.close();
+unlink(fileName);
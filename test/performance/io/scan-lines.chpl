@@ -0,0 +1,73 @@
+//
+// Measures how fast text channels can scan through input:
+// reading whole lines, reading whitespace-separated words,
+// and skipping lines with readln.
+//
+
+use IO, Time;
+
+config const n = 10000;
+config const printPerf = false;
+config const fileName = "scan-lines.txt";
+
+// Write n lines of eight words each.
+{
+  var f = open(fileName, iomode.cw);
+  var w = f.writer(locking=false);
+  for i in 1..n do
+    w.writeln("line ", i, " has some words in it, alpha beta gamma");
+  w.close();
+  f.close();
+}
+
+var f = open(fileName, iomode.r);
+var t: Timer;
+
+proc report(what: string, count: int) {
+  if printPerf then writeln(what, ": ", t.elapsed());
+  else writeln(what, " ", count);
+  t.clear();
+}
+
+// readline
+{
+  var r = f.reader(locking=false);
+  var line: string;
+  var count = 0;
+  t.start();
+  while r.readline(line) do count += 1;
+  t.stop();
+  r.close();
+  report("readline", count);
+}
+
+// read(string) -- one word at a time
+{
+  var r = f.reader(locking=false);
+  var word: string;
+  var count = 0;
+  t.start();
+  while r.read(word) do count += 1;
+  t.stop();
+  r.close();
+  report("words", count);
+}
+
+// readln -- skip each line
+{
+  var r = f.reader(locking=false);
+  var count = 0;
+  var err: syserr;
+  t.start();
+  for i in 1..n {
+    r.readln(error=err);
+    if err then break;
+    count += 1;
+  }
+  t.stop();
+  r.close();
+  report("readln", count);
+}
+
+f.close();
+unlink(fileName);